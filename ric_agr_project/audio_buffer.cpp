@@ -0,0 +1,89 @@
+// Buffer planare e conversioni da/verso il formato interleaved
+
+#include "audio_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define AUDIO_BUFFER_SSE2 1
+#endif
+
+static constexpr size_t TILE = 64;
+
+void AudioBuffer::resize(int channels, size_t frames) {
+    // Ogni canale parte da un indirizzo allineato: lo stride è arrotondato a 64 byte
+    size_t stride = (frames * sizeof(float) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    size_t bytes = stride * static_cast<size_t>(channels);
+    float* data = nullptr;
+    if (bytes > 0) {
+        data = static_cast<float*>(std::aligned_alloc(ALIGNMENT, bytes));
+        if (!data) throw std::bad_alloc();
+        std::memset(data, 0, bytes);
+    }
+    data_.reset(data);
+    channels_ = channels;
+    frames_ = frames;
+    planes_.resize(channels);
+    for (int c = 0; c < channels; ++c) planes_[c] = data + c * (stride / sizeof(float));
+}
+
+void AudioBuffer::deinterleave(const float* src, size_t frames, size_t offset) {
+    if (frames == 0) return;
+    if (channels_ == 1) {
+        std::memcpy(planes_[0] + offset, src, frames * sizeof(float));
+        return;
+    }
+    size_t f = 0;
+#ifdef AUDIO_BUFFER_SSE2
+    if (channels_ == 2) {
+        // Quattro frame per volta: L0 R0 L1 R1 | L2 R2 L3 R3 -> L0..L3, R0..R3
+        float* left = planes_[0] + offset;
+        float* right = planes_[1] + offset;
+        for (; f + 4 <= frames; f += 4) {
+            __m128 a = _mm_loadu_ps(src + 2 * f);
+            __m128 b = _mm_loadu_ps(src + 2 * f + 4);
+            _mm_storeu_ps(left + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(right + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+    }
+#endif
+    // Gli altri formati a tessere di TILE frame: la tessera interleaved resta in
+    // L1 mentre la si percorre una volta per canale
+    for (; f < frames; f += TILE) {
+        size_t end = std::min(f + TILE, frames);
+        for (int c = 0; c < channels_; ++c) {
+            float* plane = planes_[c] + offset;
+            for (size_t i = f; i < end; ++i) plane[i] = src[i * channels_ + c];
+        }
+    }
+}
+
+void AudioBuffer::interleave(float* dst, size_t frames, size_t offset) const {
+    if (frames == 0) return;
+    if (channels_ == 1) {
+        std::memcpy(dst, planes_[0] + offset, frames * sizeof(float));
+        return;
+    }
+    size_t f = 0;
+#ifdef AUDIO_BUFFER_SSE2
+    if (channels_ == 2) {
+        const float* left = planes_[0] + offset;
+        const float* right = planes_[1] + offset;
+        for (; f + 4 <= frames; f += 4) {
+            __m128 l = _mm_loadu_ps(left + f);
+            __m128 r = _mm_loadu_ps(right + f);
+            _mm_storeu_ps(dst + 2 * f, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(dst + 2 * f + 4, _mm_unpackhi_ps(l, r));
+        }
+    }
+#endif
+    for (; f < frames; f += TILE) {
+        size_t end = std::min(f + TILE, frames);
+        for (int c = 0; c < channels_; ++c) {
+            const float* plane = planes_[c] + offset;
+            for (size_t i = f; i < end; ++i) dst[i * channels_ + c] = plane[i];
+        }
+    }
+}
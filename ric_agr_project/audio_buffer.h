@@ -0,0 +1,50 @@
+// Buffer audio planare (un array contiguo per canale, allineato a 64 byte):
+// gli effetti scorrono un canale senza salti di stride e i loop vettorizzano.
+// Il formato interleaved resta solo ai bordi (libsndfile, sintetizzatore),
+// dove interleave() e deinterleave() convertono i blocchi.
+
+#ifndef AUDIO_BUFFER_H
+#define AUDIO_BUFFER_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+class AudioBuffer {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    AudioBuffer() = default;
+    AudioBuffer(int channels, size_t frames) { resize(channels, frames); }
+
+    // Nuovo formato, campioni azzerati
+    void resize(int channels, size_t frames);
+
+    int channels() const { return channels_; }
+    size_t frames() const { return frames_; }
+
+    float* channel(int c) { return planes_[c]; }
+    const float* channel(int c) const { return planes_[c]; }
+
+    // Puntatori ai canali, uno per canale
+    float* const* planes() { return planes_.data(); }
+
+    // Copia frames frame interleaved da src a partire dal frame offset del buffer
+    void deinterleave(const float* src, size_t frames, size_t offset = 0);
+
+    // Copia frames frame dal frame offset del buffer in dst, interleaved
+    void interleave(float* dst, size_t frames, size_t offset = 0) const;
+
+private:
+    struct FreeDeleter {
+        void operator()(float* p) const { std::free(p); }
+    };
+
+    std::unique_ptr<float[], FreeDeleter> data_;
+    std::vector<float*> planes_;
+    int channels_ = 0;
+    size_t frames_ = 0;
+};
+
+#endif // AUDIO_BUFFER_H
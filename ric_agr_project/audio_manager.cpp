@@ -1,14 +1,17 @@
 // audio_manager.cpp
 #include "audio_manager.h"
+#include "thread_pool.h"
+#include "tts_worker.h"
 #include <sndfile.h>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <cstdlib>
 #include <cmath>
-#include <deque>
-#include <filesystem>
-
-namespace fs = std::filesystem;
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace AudioManager {
 
@@ -31,41 +34,82 @@ bool loadAudio(const std::string& filepath,
     return (readcount == frames);
 }
 
-// Funzione per URL-encoding minimale
-std::string url_encode(const std::string& str) {
-    std::ostringstream encoded;
-    for (char c : str) {
-        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-            encoded << c;
-        } else {
-            encoded << '%' << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (int)(unsigned char)c;
-        }
-    }
-    return encoded.str();
+bool loadAudio(const std::string& filepath,
+               AudioBuffer& buffer,
+               int& sampleRate) {
+    std::vector<float> interleaved;
+    int channels = 0;
+    if (!loadAudio(filepath, interleaved, sampleRate, channels)) return false;
+    size_t frames = interleaved.size() / channels;
+    buffer.resize(channels, frames);
+    buffer.deinterleave(interleaved.data(), frames);
+    return true;
+}
+
+// Pool di worker persistenti, condiviso da tutti i nodi del processo
+static std::once_flag synthesizer_once;
+static std::unique_ptr<TtsWorkerPool> synthesizer;
+
+void startSynthesizer(int workers) {
+    std::call_once(synthesizer_once, [workers] {
+        synthesizer = std::make_unique<TtsWorkerPool>(workers, "audio_synthesizer/synthesizer.py");
+    });
 }
 
 // Funzione chiave: genera l’audio da testo
 bool synthesizeTextToAudio(const std::string& text,
     std::vector<float>& buffer,
     int& sampleRate,
-    int& channels,
-    int node_id) {
-std::string output_file = "output_audio/output_" + std::to_string(node_id) + ".wav";
-std::string safe_text = url_encode(text);
-std::string cmd = "python3 audio_synthesizer/synthesizer.py " + std::to_string(node_id) + " \"" + safe_text + "\"";
+    int& channels) {
+    startSynthesizer(1);
+    return synthesizer->synthesize(text, buffer, sampleRate, channels);
+}
+
+// Modello caricato dai worker e sua frequenza di campionamento (parte della chiave della cache)
+static const char* SYNTHESIS_MODEL = "tts_models/en/ljspeech/tacotron2-DDC";
+constexpr int SYNTHESIS_SAMPLE_RATE = 22050;
+
+static std::once_flag cache_once;
+static std::unique_ptr<SynthesisCache> cache;
 
-int result = std::system(cmd.c_str());
-if (result != 0) {
-std::cerr << "synthesizer.py execution failed\n";
-return false;
+void startSynthesisCache(size_t memoryBytes, const std::string& directory) {
+    std::call_once(cache_once, [&] {
+        // L'audio in cache è già processato: la catena di effetti fa parte del modello
+        cache = std::make_unique<SynthesisCache>(std::string(SYNTHESIS_MODEL) + "|" + effectsSignature(),
+                                                 SYNTHESIS_SAMPLE_RATE, memoryBytes, directory);
+    });
 }
 
-if (!fs::exists(output_file)) {
-std::cerr << "Generated audio file not found: " << output_file << "\n";
-return false;
+bool synthesizeProcessedAudio(const std::string& text,
+                              std::vector<float>& buffer,
+                              int& sampleRate,
+                              int& channels) {
+    auto render = [&text](CachedAudio& audio) {
+        if (!synthesizeTextToAudio(text, audio.samples, audio.sample_rate, audio.channels)) return false;
+        processAudio(audio.samples, audio.sample_rate, audio.channels);
+        return true;
+    };
+
+    if (!cache) {
+        CachedAudio audio;
+        if (!render(audio)) return false;
+        buffer = std::move(audio.samples);
+        sampleRate = audio.sample_rate;
+        channels = audio.channels;
+        return true;
+    }
+
+    // La voce in cache è condivisa e immutabile: il chiamante ne riceve una copia
+    std::shared_ptr<const CachedAudio> audio = cache->get_or_render(text, render);
+    if (!audio) return false;
+    buffer = audio->samples;
+    sampleRate = audio->sample_rate;
+    channels = audio->channels;
+    return true;
 }
 
-return loadAudio(output_file, buffer, sampleRate, channels);
+SynthesisCacheStats synthesisCacheStats() {
+    return cache ? cache->stats() : SynthesisCacheStats{};
 }
 
 bool saveAudio(const std::string& filepath,
@@ -87,21 +131,154 @@ bool saveAudio(const std::string& filepath,
     return true;
 }
 
-void normalizeAudio(std::vector<float>& buffer) {
-    float maxVal = 0.0f;
-    for (float v : buffer) {
-        maxVal = std::max(maxVal, std::abs(v));
+bool saveAudio(const std::string& filepath,
+               const AudioBuffer& buffer,
+               int sampleRate) {
+    std::vector<float> interleaved(buffer.frames() * buffer.channels());
+    buffer.interleave(interleaved.data(), buffer.frames());
+    return saveAudio(filepath, interleaved, sampleRate, buffer.channels());
+}
+
+// Sorgente e destinazione su file WAV, lette e scritte a blocchi: libsndfile
+// lavora interleaved, la conversione da e verso i canali planari è qui
+class SndfileSource : public AudioSource {
+public:
+    explicit SndfileSource(const std::string& filepath) {
+        sndfile_ = sf_open(filepath.c_str(), SFM_READ, &sfinfo_);
+    }
+    ~SndfileSource() override { if (sndfile_) sf_close(sndfile_); }
+    bool ok() const { return sndfile_ != nullptr; }
+
+    StreamInfo info() const override {
+        StreamInfo info;
+        info.sample_rate = sfinfo_.samplerate;
+        info.channels = sfinfo_.channels;
+        info.total_frames = static_cast<size_t>(sfinfo_.frames);
+        return info;
+    }
+    size_t read(AudioBuffer& dst, size_t frames) override {
+        interleaved_.resize(frames * sfinfo_.channels);
+        size_t count = static_cast<size_t>(sf_readf_float(sndfile_, interleaved_.data(), static_cast<sf_count_t>(frames)));
+        dst.deinterleave(interleaved_.data(), count);
+        return count;
+    }
+    bool rewind() override { return sf_seek(sndfile_, 0, SEEK_SET) == 0; }
+
+private:
+    SF_INFO sfinfo_{};
+    SNDFILE* sndfile_ = nullptr;
+    std::vector<float> interleaved_;   // Blocco come lo legge libsndfile
+};
+
+class SndfileSink : public AudioSink {
+public:
+    SndfileSink(const std::string& filepath, int sampleRate, int channels) {
+        SF_INFO sfinfo{};
+        sfinfo.samplerate = sampleRate;
+        sfinfo.channels = channels;
+        sfinfo.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+        sndfile_ = sf_open(filepath.c_str(), SFM_WRITE, &sfinfo);
+    }
+    ~SndfileSink() override { if (sndfile_) sf_close(sndfile_); }
+    bool ok() const { return sndfile_ != nullptr; }
+
+    bool write(const AudioBuffer& block, size_t frames) override {
+        interleaved_.resize(frames * block.channels());
+        block.interleave(interleaved_.data(), frames);
+        return sf_writef_float(sndfile_, interleaved_.data(), static_cast<sf_count_t>(frames)) == static_cast<sf_count_t>(frames);
+    }
+
+private:
+    SNDFILE* sndfile_ = nullptr;
+    std::vector<float> interleaved_;
+};
+
+// Pool per i canali degli effetti, condiviso da tutti i nodi del processo
+static std::once_flag audio_threads_once;
+static std::unique_ptr<ThreadPool> audio_threads;
+
+void startAudioThreads(int threads) {
+    std::call_once(audio_threads_once, [threads] {
+        size_t total = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+        // Il thread che elabora lavora anche lui: servono total - 1 worker
+        audio_threads = std::make_unique<ThreadPool>(total - 1);
+    });
+}
+
+// Catena di effetti di processAudio (di default solo la normalizzazione)
+static std::mutex effects_mtx;
+static std::vector<EffectSpec> effects{EffectSpec{"normalize", {}}};
+
+void configureEffects(const std::vector<EffectSpec>& specs) {
+    // Verifica subito i tipi: un errore di configurazione emerge all'avvio
+    for (const EffectSpec& spec : specs) make_audio_processor(spec);
+    std::lock_guard<std::mutex> lock(effects_mtx);
+    effects = specs;
+}
+
+std::string effectsSignature() {
+    std::lock_guard<std::mutex> lock(effects_mtx);
+    std::string signature;
+    for (const EffectSpec& spec : effects) {
+        signature += spec.type;
+        for (const auto& [key, value] : spec.params) signature += " " + key + "=" + std::to_string(value);
+        signature += ";";
+    }
+    return signature;
+}
+
+ProcessingGraph buildProcessingGraph() {
+    std::lock_guard<std::mutex> lock(effects_mtx);
+    ProcessingGraph graph;
+    for (const EffectSpec& spec : effects) graph.add(make_audio_processor(spec));
+    graph.set_thread_pool(audio_threads.get());
+    return graph;
+}
+
+bool processFile(const std::string& inputPath,
+                 const std::string& outputPath,
+                 size_t blockFrames) {
+    SndfileSource source(inputPath);
+    if (!source.ok()) {
+        std::cerr << "Error opening audio file: " << sf_strerror(nullptr) << std::endl;
+        return false;
     }
-    if (maxVal > 0.0f) {
-        float invMax = 1.0f / maxVal;
-        for (float& v : buffer) v *= invMax;
+    StreamInfo info = source.info();
+    SndfileSink sink(outputPath, info.sample_rate, info.channels);
+    if (!sink.ok()) {
+        std::cerr << "Error opening audio file for writing: " << sf_strerror(nullptr) << std::endl;
+        return false;
     }
+    ProcessingGraph graph = buildProcessingGraph();
+    return graph.run(source, sink, blockFrames);
+}
+
+// Esegue un solo effetto sull'intero buffer
+static void runEffect(std::unique_ptr<AudioProcessor> effect,
+                      std::vector<float>& buffer,
+                      int sampleRate,
+                      int channels) {
+    ProcessingGraph graph;
+    graph.add(std::move(effect));
+    graph.set_thread_pool(audio_threads.get());
+    graph.process(buffer, sampleRate, channels);
+}
+
+void normalizeAudio(std::vector<float>& buffer) {
+    runEffect(std::make_unique<Normalizer>(), buffer, 0, 1);
 }
 
 void processAudio(std::vector<float>& buffer,
                   int sampleRate,
                   int channels) {
-    normalizeAudio(buffer);
+    ProcessingGraph graph = buildProcessingGraph();
+    graph.process(buffer, sampleRate, channels);
+}
+
+void processAudio(AudioBuffer& buffer,
+                  int sampleRate) {
+    ProcessingGraph graph = buildProcessingGraph();
+    graph.process(buffer, sampleRate);
 }
 
 void playAudio(const std::string& filepath) {
@@ -111,29 +288,19 @@ void playAudio(const std::string& filepath) {
     }
 }
 
-// FUNZIONI OPZIONALI PER APPLICARE EFFETTI SONORI (NON USATE)
+// Effetti singoli sull'intero buffer (stessi AudioProcessor della catena)
 void applyFadeIn(std::vector<float>& buffer,
                  int sampleRate,
                  int channels,
                  int durationMs) {
-    size_t totalSamples = buffer.size();
-    size_t fadeSamples = (size_t)(durationMs / 1000.0f * sampleRate) * channels;
-    for (size_t i = 0; i < fadeSamples && i < totalSamples; ++i) {
-        float gain = (float)i / fadeSamples;
-        buffer[i] *= gain;
-    }
+    runEffect(std::make_unique<FadeIn>(durationMs), buffer, sampleRate, channels);
 }
 
 void applyFadeOut(std::vector<float>& buffer,
                   int sampleRate,
                   int channels,
                   int durationMs) {
-    size_t totalSamples = buffer.size();
-    size_t fadeSamples = (size_t)(durationMs / 1000.0f * sampleRate) * channels;
-    for (size_t i = 0; i < fadeSamples && i < totalSamples; ++i) {
-        float gain = (float)(fadeSamples - i) / fadeSamples;
-        buffer[totalSamples - 1 - i] *= gain;
-    }
+    runEffect(std::make_unique<FadeOut>(durationMs), buffer, sampleRate, channels);
 }
 
 void applyEqualizer(std::vector<float>& buffer,
@@ -141,77 +308,130 @@ void applyEqualizer(std::vector<float>& buffer,
                     int channels,
                     float lowCut,
                     float highCut) {
-    // Due filtri RC a primo ordine: passa-alto e passa-basso
-    float dt = 1.0f / sampleRate;
-    float RC_low = 1.0f / (2 * M_PI * highCut);
-    float alpha_low = dt / (RC_low + dt);
-    float RC_high = 1.0f / (2 * M_PI * lowCut);
-    float alpha_high = RC_high / (RC_high + dt);
-
-    // process per canale
-    for (int c = 0; c < channels; ++c) {
-        float y_low = 0.0f;
-        float y_high = buffer[c];
-        for (size_t i = c; i < buffer.size(); i += channels) {
-            float x = buffer[i];
-            y_low += alpha_low * (x - y_low);
-            y_high = alpha_high * (y_high + x - buffer[i - channels < 0 ? c : i - channels]);
-            buffer[i] = y_low + y_high;
-        }
-    }
+    runEffect(std::make_unique<Equalizer>(lowCut, highCut), buffer, sampleRate, channels);
+}
+
+void applyParametricEq(std::vector<float>& buffer,
+                       int sampleRate,
+                       int channels,
+                       const std::vector<EqBand>& bands) {
+    runEffect(std::make_unique<Equalizer>(bands), buffer, sampleRate, channels);
 }
 
 void applyNoiseReduction(std::vector<float>& buffer,
                           float threshold) {
-    for (float& v : buffer) {
-        if (std::abs(v) < threshold) v = 0.0f;
-    }
+    runEffect(std::make_unique<NoiseGate>(threshold), buffer, 0, 1);
 }
 
 void applyCompression(std::vector<float>& buffer,
                       float threshold,
                       float ratio) {
-    for (float& v : buffer) {
-        float mag = std::abs(v);
-        if (mag > threshold) {
-            float excess = mag - threshold;
-            v = (v / mag) * (threshold + excess / ratio);
-        }
-    }
+    runEffect(std::make_unique<Compressor>(threshold, ratio), buffer, 0, 1);
 }
 
 void applyReverb(std::vector<float>& buffer,
                  int sampleRate,
                  int channels,
                  float reverbTime) {
-    // Feedback Delay Network semplice
-    int delaySamples = (int)(0.03f * sampleRate) * channels; // 30ms
-    float decay = std::exp(-3.0f / (reverbTime * sampleRate));
-    std::deque<float> fb(delaySamples, 0.0f);
-    for (size_t i = 0; i < buffer.size(); ++i) {
-        float in = buffer[i];
-        float out = in + fb.front() * decay;
-        fb.pop_front();
-        fb.push_back(out);
-        buffer[i] = out;
+    runEffect(std::make_unique<Reverb>(reverbTime), buffer, sampleRate, channels);
+}
+
+// Legge, ricampiona, normalizza e partiziona la risposta all'impulso
+static std::shared_ptr<const ConvolutionIr> buildImpulseResponse(const std::string& irPath, int sampleRate) {
+    AudioBuffer file;
+    int fileRate = 0;
+    if (!loadAudio(irPath, file, fileRate) || file.frames() == 0) return nullptr;
+
+    // Interpolazione lineare alla frequenza del segnale (le code dei
+    // riverberi hanno poca energia vicino a Nyquist)
+    double step = static_cast<double>(fileRate) / sampleRate;
+    size_t frames = static_cast<size_t>((file.frames() - 1) / step) + 1;
+    AudioBuffer ir(file.channels(), frames);
+    double energy = 0.0;
+    for (int c = 0; c < file.channels(); ++c) {
+        const float* in = file.channel(c);
+        float* out = ir.channel(c);
+        for (size_t i = 0; i < frames; ++i) {
+            double pos = i * step;
+            size_t j = static_cast<size_t>(pos);
+            float frac = static_cast<float>(pos - j);
+            out[i] = j + 1 < file.frames() ? in[j] + frac * (in[j + 1] - in[j]) : in[j];
+            energy += static_cast<double>(out[i]) * out[i];
+        }
+    }
+    // Energia unitaria per canale: mix ha lo stesso significato per ogni file
+    energy /= file.channels();
+    if (energy > 0.0) {
+        float gain = static_cast<float>(1.0 / std::sqrt(energy));
+        for (int c = 0; c < ir.channels(); ++c) {
+            for (size_t i = 0; i < frames; ++i) ir.channel(c)[i] *= gain;
+        }
+    }
+
+    return std::make_shared<const ConvolutionIr>(ir);
+}
+
+// Risposte all'impulso già partizionate, per file e frequenza di campionamento.
+// Il lock copre solo la mappa: ogni voce ha il proprio once_flag, così chi
+// chiede la stessa risposta attende il primo caricamento e chi ne chiede
+// un'altra non attende nessuno.
+struct IrCacheEntry {
+    std::once_flag once;
+    std::shared_ptr<const ConvolutionIr> ir;
+};
+static std::mutex ir_cache_mtx;
+static std::map<std::pair<std::string, int>, std::shared_ptr<IrCacheEntry>> ir_cache;
+
+std::shared_ptr<const ConvolutionIr> loadImpulseResponse(const std::string& irPath,
+                                                          int sampleRate) {
+    auto key = std::make_pair(irPath, sampleRate);
+    std::shared_ptr<IrCacheEntry> entry;
+    {
+        std::lock_guard<std::mutex> lock(ir_cache_mtx);
+        auto& slot = ir_cache[key];
+        if (!slot) slot = std::make_shared<IrCacheEntry>();
+        entry = slot;
     }
+
+    std::call_once(entry->once, [&] { entry->ir = buildImpulseResponse(irPath, sampleRate); });
+    if (!entry->ir) {
+        // File non aperto: la voce si toglie, la prossima richiesta riprova
+        std::lock_guard<std::mutex> lock(ir_cache_mtx);
+        auto it = ir_cache.find(key);
+        if (it != ir_cache.end() && it->second == entry) ir_cache.erase(it);
+    }
+    return entry->ir;
+}
+
+bool applyConvolutionReverb(std::vector<float>& buffer,
+                            int sampleRate,
+                            int& channels,
+                            const std::string& irPath,
+                            float mix) {
+    std::shared_ptr<const ConvolutionIr> ir = loadImpulseResponse(irPath, sampleRate);
+    if (!ir) {
+        std::cerr << "Error loading impulse response: " << irPath << std::endl;
+        return false;
+    }
+    if (channels == 1 && ir->channels() > 1) {
+        // Voce mono in una stanza stereo: ogni canale riceve la propria risposta
+        std::vector<float> mono = std::move(buffer);
+        buffer.resize(mono.size() * ir->channels());
+        for (size_t i = 0; i < mono.size(); ++i) {
+            for (int c = 0; c < ir->channels(); ++c) buffer[i * ir->channels() + c] = mono[i];
+        }
+        channels = ir->channels();
+    }
+    runEffect(std::make_unique<ConvolutionReverb>(ir, mix), buffer, sampleRate, channels);
+    return true;
 }
 
 void applyDelay(std::vector<float>& buffer,
                 int sampleRate,
                 int channels,
-                int delayMs,
+                float delayMs,
                 float feedback) {
-    int delaySamples = (int)(delayMs / 1000.0f * sampleRate) * channels;
-    std::deque<float> dbuf(delaySamples, 0.0f);
-    for (size_t i = 0; i < buffer.size(); ++i) {
-        float in = buffer[i];
-        float delayed = dbuf.front();
-        dbuf.pop_front();
-        float out = in + delayed * feedback;
-        dbuf.push_back(out);
-        buffer[i] = out;
-    }
+    runEffect(std::make_unique<Delay>(delayMs, feedback), buffer, sampleRate, channels);
 }
 
 } // namespace AudioManager
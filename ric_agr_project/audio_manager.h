@@ -4,6 +4,8 @@
 
 #include <vector>
 #include <string>
+#include "audio_processor.h"
+#include "synthesis_cache.h"
 
 namespace AudioManager {
 
@@ -17,11 +19,87 @@ namespace AudioManager {
                    int sampleRate,
                    int channels);
 
+    /**
+     * Carica un file WAV in un buffer planare (un array per canale).
+     */
+    bool loadAudio(const std::string& filepath,
+                   AudioBuffer& buffer,
+                   int& sampleRate);
+
+    /**
+     * Salva un buffer planare; i canali si interleavano solo per libsndfile.
+     */
+    bool saveAudio(const std::string& filepath,
+                   const AudioBuffer& buffer,
+                   int sampleRate);
+
+    /**
+     * Avvia il pool che elabora in parallelo i canali degli effetti (una volta, all'avvio).
+     * Se non viene chiamata, i canali si elaborano in sequenza.
+     * @param threads Thread che elaborano, compreso il chiamante (0 = uno per core).
+     */
+    void startAudioThreads(int threads);
+
+    /**
+     * Avvia il pool di sintetizzatori persistenti (una volta, all'avvio).
+     * Se non viene chiamata, il primo synthesizeTextToAudio avvia un solo worker.
+     * @param workers Numero di processi python3, ognuno con il proprio modello caricato.
+     */
+    void startSynthesizer(int workers);
+
+    /**
+     * Sintetizza il testo con un worker del pool (float PCM in memoria condivisa).
+     */
     bool synthesizeTextToAudio(const std::string& text,
                     std::vector<float>& buffer,
                     int& sampleRate,
-                    int& channels,
-                    int node_id);
+                    int& channels);
+
+    /**
+     * Imposta la catena di effetti di processAudio (letta da config.json);
+     * eccezione se un tipo non esiste. Va chiamata prima di startSynthesisCache.
+     */
+    void configureEffects(const std::vector<EffectSpec>& specs);
+
+    /**
+     * Descrizione testuale della catena configurata (parte della chiave della cache).
+     */
+    std::string effectsSignature();
+
+    /**
+     * Nuova istanza della catena configurata, con stato proprio (usa il pool
+     * di startAudioThreads, se avviato).
+     */
+    ProcessingGraph buildProcessingGraph();
+
+    /**
+     * Applica la catena configurata da file a file a blocchi di blockFrames:
+     * la memoria non cresce con la lunghezza del file.
+     */
+    bool processFile(const std::string& inputPath,
+                     const std::string& outputPath,
+                     size_t blockFrames = ProcessingGraph::DEFAULT_BLOCK_FRAMES);
+
+    /**
+     * Attiva la cache delle frasi già sintetizzate (una volta, all'avvio).
+     * @param memoryBytes Limite della LRU in memoria.
+     * @param directory Cartella dei blob su disco ("" = solo memoria).
+     */
+    void startSynthesisCache(size_t memoryBytes, const std::string& directory);
+
+    /**
+     * Sintesi e processAudio passando dalla cache: una frase già detta da un
+     * nodo non torna al sintetizzatore. Senza startSynthesisCache non usa cache.
+     */
+    bool synthesizeProcessedAudio(const std::string& text,
+                                  std::vector<float>& buffer,
+                                  int& sampleRate,
+                                  int& channels);
+
+    /**
+     * Contatori hit/miss della cache (tutti zero se non è attiva).
+     */
+    SynthesisCacheStats synthesisCacheStats();
 
     /**
      * Normalizza il buffer audio al picco massimo.
@@ -47,9 +125,9 @@ namespace AudioManager {
                       int durationMs);
 
     /**
-     * Equalizzatore passa-basso e passa-alto semplice a primo ordine.
-     * @param lowCut Frequenza di taglio basso (Hz).
-     * @param highCut Frequenza di taglio alto (Hz).
+     * Passa-alto e passa-basso biquad del secondo ordine (Butterworth).
+     * @param lowCut Frequenza di taglio basso (Hz), 0 = nessun passa-alto.
+     * @param highCut Frequenza di taglio alto (Hz), 0 = nessun passa-basso.
      */
     void applyEqualizer(std::vector<float>& buffer,
                         int sampleRate,
@@ -57,6 +135,15 @@ namespace AudioManager {
                         float lowCut,
                         float highCut);
 
+    /**
+     * Equalizzatore parametrico: biquad in cascata (shelf, peaking, passa-basso e passa-alto).
+     * @param bands Bande applicate in ordine.
+     */
+    void applyParametricEq(std::vector<float>& buffer,
+                           int sampleRate,
+                           int channels,
+                           const std::vector<EqBand>& bands);
+
     /**
      * Noise gate: azzera i campioni al di sotto di una soglia.
      * @param threshold Soglia di ampiezza.
@@ -74,7 +161,8 @@ namespace AudioManager {
                           float ratio);
 
     /**
-     * Riverbero semplice basato su feedback delay network.
+     * Riverbero a feedback delay network (otto linee, una rete per canale).
+     * @param reverbTime Tempo di decadimento di 60 dB in secondi.
      */
     void applyReverb(std::vector<float>& buffer,
                      int sampleRate,
@@ -82,23 +170,51 @@ namespace AudioManager {
                      float reverbTime);
 
     /**
-     * Delay semplice con buffer circolare.
+     * Risposta all'impulso di un file WAV, pronta per la convoluzione: portata a
+     * sampleRate, normalizzata a energia unitaria e divisa in partizioni nel
+     * dominio della frequenza. Calcolata una volta per file e frequenza, poi
+     * condivisa; nullptr se il file non si apre.
+     */
+    std::shared_ptr<const ConvolutionIr> loadImpulseResponse(const std::string& irPath,
+                                                              int sampleRate);
+
+    /**
+     * Riverbero a convoluzione con una risposta all'impulso misurata (FFT a partizioni).
+     * Con una risposta stereo un buffer mono diventa stereo (channels passa a 2);
+     * altrimenti il canale c usa il canale c della risposta, modulo i suoi canali.
+     * @param irPath File WAV della risposta all'impulso.
+     * @param mix Livello del segnale riverberato sommato all'originale.
+     */
+    bool applyConvolutionReverb(std::vector<float>& buffer,
+                                int sampleRate,
+                                int& channels,
+                                const std::string& irPath,
+                                float mix = 0.3f);
+
+    /**
+     * Delay con feedback su buffer circolare, una linea per canale.
      * @param delayMs Tempo di delay in millisecondi.
      * @param feedback Quantità di feedback (0.0-1.0).
      */
     void applyDelay(std::vector<float>& buffer,
                     int sampleRate,
                     int channels,
-                    int delayMs,
+                    float delayMs,
                     float feedback);
 
     /**
-     * Esegue la processazione completa: normalizzazione e tutti gli effetti.
+     * Esegue la catena di effetti configurata (default: normalizzazione) a blocchi.
      */
     void processAudio(std::vector<float>& buffer,
                       int sampleRate,
                       int channels);
 
+    /**
+     * Come sopra su un buffer planare, senza conversioni: i canali vanno in parallelo.
+     */
+    void processAudio(AudioBuffer& buffer,
+                      int sampleRate);
+
     /**
      * Riproduce un file WAV esterno via comando di sistema.
      */
@@ -0,0 +1,335 @@
+// Effetti audio a blocchi e grafo di elaborazione
+
+#include "audio_processor.h"
+#include "dsp_kernels.h"
+#include "effect_chain.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// ---- Sorgenti e destinazioni in memoria ----
+
+BufferSource::BufferSource(const std::vector<float>& buffer, int sample_rate, int channels)
+    : buffer_(buffer) {
+    info_.sample_rate = sample_rate;
+    info_.channels = channels;
+    info_.total_frames = buffer.size() / channels;
+}
+
+size_t BufferSource::read(AudioBuffer& dst, size_t frames) {
+    frames = std::min(frames, info_.total_frames - position_);
+    dst.deinterleave(buffer_.data() + position_ * info_.channels, frames);
+    position_ += frames;
+    return frames;
+}
+
+bool BufferSink::write(const AudioBuffer& block, size_t frames) {
+    size_t end = (position_ + frames) * channels_;
+    if (buffer_.size() < end) buffer_.resize(end);
+    block.interleave(buffer_.data() + position_ * channels_, frames);
+    position_ += frames;
+    return true;
+}
+
+// ---- Grafo ----
+
+void ProcessingGraph::add(std::unique_ptr<AudioProcessor> processor) {
+    processors_.push_back(std::move(processor));
+}
+
+void ProcessingGraph::for_each_channel(int channels, const std::function<void(size_t)>& fn) {
+    if (pool_) {
+        pool_->parallel_for(channels, fn);
+    } else {
+        for (int c = 0; c < channels; ++c) fn(c);
+    }
+}
+
+bool ProcessingGraph::run_analysis(AudioSource& source, size_t block_frames) {
+    StreamInfo info = source.info();
+    AudioBuffer block(info.channels, block_frames);
+
+    for (auto& processor : processors_) processor->prepare(info);
+
+    // Passate di analisi: l'effetto k vede il segnale già elaborato dagli effetti
+    // che lo precedono (un normalizzatore in fondo alla catena misura il picco finale)
+    for (size_t k = 0; k < processors_.size(); ++k) {
+        if (!processors_[k]->needs_analysis()) continue;
+        if (!source.rewind()) return false;
+        for (size_t j = 0; j < k; ++j) processors_[j]->prepare(info);
+        processors_[k]->begin_analysis();
+        while (size_t frames = source.read(block, block_frames)) {
+            for_each_channel(info.channels, [&](size_t c) {
+                int channel = static_cast<int>(c);
+                for (size_t j = 0; j < k; ++j) processors_[j]->process(block.channel(channel), frames, channel);
+                processors_[k]->analyze(block.channel(channel), frames, channel);
+            });
+        }
+    }
+    return true;
+}
+
+bool ProcessingGraph::run(AudioSource& source, AudioSink& sink, size_t block_frames) {
+    StreamInfo info = source.info();
+    if (info.channels <= 0 || block_frames == 0) return false;
+    if (!run_analysis(source, block_frames)) return false;
+
+    // Passata finale: ogni blocco attraversa tutta la catena, un canale per
+    // task, e va subito alla destinazione
+    AudioBuffer block(info.channels, block_frames);
+    if (!source.rewind()) return false;
+    for (auto& processor : processors_) processor->prepare(info);
+    while (size_t frames = source.read(block, block_frames)) {
+        for_each_channel(info.channels, [&](size_t c) {
+            int channel = static_cast<int>(c);
+            for (auto& processor : processors_) processor->process(block.channel(channel), frames, channel);
+        });
+        if (!sink.write(block, frames)) return false;
+    }
+    return true;
+}
+
+bool ProcessingGraph::process_planes(float* const* planes, int channels, size_t total_frames,
+                                     int sample_rate, size_t block_frames) {
+    if (channels <= 0 || block_frames == 0) return false;
+    StreamInfo info;
+    info.sample_rate = sample_rate;
+    info.channels = channels;
+    info.total_frames = total_frames;
+
+    for (auto& processor : processors_) processor->prepare(info);
+
+    // Passate di analisi su una copia del blocco (il buffer non cambia): ogni
+    // canale scorre tutti i blocchi nel proprio task, il pool fa da barriera
+    AudioBuffer scratch;
+    for (size_t k = 0; k < processors_.size(); ++k) {
+        if (!processors_[k]->needs_analysis()) continue;
+        if (scratch.channels() == 0) scratch.resize(channels, block_frames);
+        for (size_t j = 0; j < k; ++j) processors_[j]->prepare(info);
+        processors_[k]->begin_analysis();
+        for_each_channel(channels, [&](size_t c) {
+            int channel = static_cast<int>(c);
+            float* block = scratch.channel(channel);
+            for (size_t frame = 0; frame < total_frames; frame += block_frames) {
+                size_t frames = std::min(block_frames, total_frames - frame);
+                std::copy(planes[channel] + frame, planes[channel] + frame + frames, block);
+                for (size_t j = 0; j < k; ++j) processors_[j]->process(block, frames, channel);
+                processors_[k]->analyze(block, frames, channel);
+            }
+        });
+    }
+
+    // Passata finale direttamente nel buffer, un blocco alla volta: nessuna copia
+    for (auto& processor : processors_) processor->prepare(info);
+    for_each_channel(channels, [&](size_t c) {
+        int channel = static_cast<int>(c);
+        for (size_t frame = 0; frame < total_frames; frame += block_frames) {
+            size_t frames = std::min(block_frames, total_frames - frame);
+            for (auto& processor : processors_) processor->process(planes[channel] + frame, frames, channel);
+        }
+    });
+    return true;
+}
+
+bool ProcessingGraph::process(AudioBuffer& buffer, int sample_rate, size_t block_frames) {
+    return process_planes(buffer.planes(), buffer.channels(), buffer.frames(), sample_rate, block_frames);
+}
+
+bool ProcessingGraph::process(std::vector<float>& buffer, int sample_rate, int channels, size_t block_frames) {
+    if (channels <= 0) return false;
+    size_t frames = buffer.size() / channels;
+    if (channels == 1) {
+        // Un canale è già planare
+        float* plane = buffer.data();
+        return process_planes(&plane, 1, frames, sample_rate, block_frames);
+    }
+    AudioBuffer planar(channels, frames);
+    planar.deinterleave(buffer.data(), frames);
+    if (!process(planar, sample_rate, block_frames)) return false;
+    planar.interleave(buffer.data(), frames);
+    return true;
+}
+
+// Bande dell'equalizzatore: passa-alto low_cut e passa-basso high_cut (0 = assente),
+// poi shelf e fino a quattro peaking, presenti solo se ne è data la frequenza
+static std::vector<EqBand> equalizer_bands(const EffectSpec& spec) {
+    std::vector<EqBand> bands;
+    auto add = [&](EqBandType type, const std::string& prefix, float q) {
+        if (spec.params.count(prefix + "_freq") == 0) return;
+        bands.push_back(EqBand{type, spec.get(prefix + "_freq", 1000.0f),
+                               spec.get(prefix + "_gain_db", 0.0f), spec.get(prefix + "_q", q)});
+    };
+    float low_cut = spec.get("low_cut", 80.0f);
+    float high_cut = spec.get("high_cut", 8000.0f);
+    if (low_cut > 0.0f) bands.push_back(EqBand{EqBandType::HighPass, low_cut});
+    add(EqBandType::LowShelf, "low_shelf", 0.7071f);
+    for (int i = 1; i <= 4; ++i) add(EqBandType::Peaking, "peak" + std::to_string(i), 1.0f);
+    add(EqBandType::HighShelf, "high_shelf", 0.7071f);
+    if (high_cut > 0.0f) bands.push_back(EqBand{EqBandType::LowPass, high_cut});
+    return bands;
+}
+
+std::unique_ptr<AudioProcessor> make_audio_processor(const EffectSpec& spec) {
+    if (spec.type == "normalize") {
+        return std::make_unique<Normalizer>();
+    }
+    if (spec.type == "fade_in") {
+        return std::make_unique<FadeIn>(static_cast<int>(spec.get("duration_ms", 50)));
+    }
+    if (spec.type == "fade_out") {
+        return std::make_unique<FadeOut>(static_cast<int>(spec.get("duration_ms", 50)));
+    }
+    if (spec.type == "equalizer") {
+        return std::make_unique<Equalizer>(equalizer_bands(spec));
+    }
+    if (spec.type == "noise_gate") {
+        return std::make_unique<NoiseGate>(spec.get("threshold", 0.01f));
+    }
+    if (spec.type == "compressor") {
+        return std::make_unique<Compressor>(spec.get("threshold", 0.5f), spec.get("ratio", 4.0f));
+    }
+    if (spec.type == "reverb") {
+        return std::make_unique<Reverb>(spec.get("reverb_time", 1.0f), spec.get("damping", 0.3f), spec.get("mix", 0.3f));
+    }
+    if (spec.type == "delay") {
+        return std::make_unique<Delay>(spec.get("delay_ms", 250.0f), spec.get("feedback", 0.3f));
+    }
+    if (spec.type == "voice") {
+        // Gate, compressore, fade e normalizzazione fusi in un solo loop
+        return std::make_unique<VoiceChain>(
+            GateStage(spec.get("gate_threshold", 0.01f)),
+            CompressorStage(spec.get("threshold", 0.5f), spec.get("ratio", 4.0f)),
+            FadeInStage(static_cast<int>(spec.get("fade_in_ms", 50))),
+            FadeOutStage(static_cast<int>(spec.get("fade_out_ms", 50))),
+            NormalizeStage());
+    }
+    throw std::runtime_error("Unknown audio effect: " + spec.type);
+}
+
+// ---- Effetti ----
+
+void Normalizer::prepare(const StreamInfo& info) {
+    peaks_.resize(info.channels, 0.0f);
+    peak_ = 0.0f;
+    for (float peak : peaks_) peak_ = std::max(peak_, peak);
+}
+
+void Normalizer::begin_analysis() {
+    std::fill(peaks_.begin(), peaks_.end(), 0.0f);
+}
+
+void Normalizer::analyze(const float* samples, size_t frames, int channel) {
+    peaks_[channel] = std::max(peaks_[channel], dsp_kernels().max_abs(samples, frames));
+}
+
+void Normalizer::process(float* samples, size_t frames, int /*channel*/) {
+    if (peak_ > 0.0f) {
+        float invMax = 1.0f / peak_;
+        dsp_kernels().scale(samples, frames, invMax);
+    }
+}
+
+void FadeIn::prepare(const StreamInfo& info) {
+    fade_frames_ = (size_t)(duration_ms_ / 1000.0f * info.sample_rate);
+    positions_.assign(info.channels, 0);
+}
+
+void FadeIn::process(float* samples, size_t frames, int channel) {
+    size_t& position = positions_[channel];
+    if (position < fade_frames_) {
+        // Guadagno (posizione / durata) sui frame del blocco ancora dentro il fade
+        dsp_kernels().ramp(samples, std::min(frames, fade_frames_ - position), position, fade_frames_);
+    }
+    position += frames;
+}
+
+void FadeOut::prepare(const StreamInfo& info) {
+    fade_frames_ = (size_t)(duration_ms_ / 1000.0f * info.sample_rate);
+    total_frames_ = info.total_frames;
+    positions_.assign(info.channels, 0);
+}
+
+void FadeOut::process(float* samples, size_t frames, int channel) {
+    size_t& position = positions_[channel];
+    // Il fade copre gli ultimi fade_frames_ frame: il frame j ha
+    // guadagno (fade_frames_ - distanza dalla fine) / fade_frames_
+    size_t fade_start = total_frames_ > fade_frames_ ? total_frames_ - fade_frames_ : 0;
+    size_t begin = std::max(position, fade_start);
+    size_t end = std::min(position + frames, total_frames_);
+    if (begin < end) {
+        size_t first_step = begin + 1 + fade_frames_ - total_frames_;
+        dsp_kernels().ramp(samples + (begin - position), end - begin, first_step, fade_frames_);
+    }
+    position += frames;
+}
+
+Equalizer::Equalizer(float low_cut, float high_cut) {
+    if (low_cut > 0.0f) bands_.push_back(EqBand{EqBandType::HighPass, low_cut});
+    if (high_cut > 0.0f) bands_.push_back(EqBand{EqBandType::LowPass, high_cut});
+}
+
+void Equalizer::prepare(const StreamInfo& info) {
+    cascades_.assign(info.channels, BiquadCascade());
+    for (BiquadCascade& cascade : cascades_) cascade.prepare(info.sample_rate, bands_);
+}
+
+void Equalizer::process(float* samples, size_t frames, int channel) {
+    cascades_[channel].process(samples, frames);
+}
+
+void Equalizer::set_band(size_t index, const EqBand& band) {
+    bands_[index].frequency = band.frequency;
+    bands_[index].gain_db = band.gain_db;
+    bands_[index].q = band.q;
+    for (BiquadCascade& cascade : cascades_) cascade.set_band(index, band);
+}
+
+void NoiseGate::process(float* samples, size_t frames, int /*channel*/) {
+    dsp_kernels().noise_gate(samples, frames, threshold_);
+}
+
+void Compressor::process(float* samples, size_t frames, int /*channel*/) {
+    dsp_kernels().compress(samples, frames, threshold_, ratio_);
+}
+
+void Reverb::prepare(const StreamInfo& info) {
+    networks_.assign(info.channels, FdnReverb());
+    for (int c = 0; c < info.channels; ++c) networks_[c].prepare(info.sample_rate, reverb_time_, damping_, c);
+}
+
+void Reverb::process(float* samples, size_t frames, int channel) {
+    networks_[channel].process(samples, frames, mix_);
+}
+
+void ConvolutionReverb::prepare(const StreamInfo& info) {
+    convolvers_.assign(info.channels, PartitionedConvolver());
+    for (int c = 0; c < info.channels; ++c) convolvers_[c].prepare(ir_, c % ir_->channels());
+}
+
+void ConvolutionReverb::process(float* samples, size_t frames, int channel) {
+    convolvers_[channel].process(samples, frames, mix_);
+}
+
+void Delay::prepare(const StreamInfo& info) {
+    float delay = std::max(1.0f, delay_ms_ / 1000.0f * info.sample_rate);
+    delay_whole_ = static_cast<size_t>(delay);
+    delay_frac_ = delay - delay_whole_;
+    lines_.assign(info.channels, DelayLine());
+    for (DelayLine& line : lines_) line.resize(delay_whole_ + 1);
+}
+
+void Delay::process(float* samples, size_t frames, int channel) {
+    DelayLine& line = lines_[channel];
+    if (delay_frac_ == 0.0f) {
+        for (size_t f = 0; f < frames; ++f) {
+            samples[f] += line.read(delay_whole_) * feedback_;
+            line.push(samples[f]);
+        }
+    } else {
+        for (size_t f = 0; f < frames; ++f) {
+            samples[f] += line.read(delay_whole_, delay_frac_) * feedback_;
+            line.push(samples[f]);
+        }
+    }
+}
@@ -0,0 +1,291 @@
+// Elaborazione audio a blocchi: ogni effetto è un AudioProcessor che lavora
+// in place su blocchi planari (un array contiguo per canale, vedi AudioBuffer)
+// e conserva il proprio stato tra una chiamata e l'altra. Lo stato è separato
+// per canale, quindi i canali di un blocco si elaborano in parallelo. Un
+// ProcessingGraph compone gli effetti e trasferisce l'audio da una sorgente a
+// una destinazione con memoria costante.
+
+#ifndef AUDIO_PROCESSOR_H
+#define AUDIO_PROCESSOR_H
+
+#include "audio_buffer.h"
+#include "biquad_cascade.h"
+#include "delay_line.h"
+#include "fdn_reverb.h"
+#include "partitioned_convolver.h"
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Formato del flusso, noto prima del primo blocco
+struct StreamInfo {
+    int sample_rate = 0;
+    int channels = 1;
+    size_t total_frames = 0;    // Lunghezza del flusso (serve al fade-out)
+};
+
+class AudioProcessor {
+public:
+    virtual ~AudioProcessor() = default;
+
+    // Inizio di un flusso: azzera lo stato dell'effetto
+    virtual void prepare(const StreamInfo& info) = 0;
+
+    // Elabora in place i frames campioni del canale channel. I blocchi di un
+    // canale arrivano in ordine; canali diversi possono arrivare in parallelo
+    // da thread diversi, quindi la chiamata tocca solo lo stato di channel.
+    virtual void process(float* samples, size_t frames, int channel) = 0;
+
+    // Gli effetti che devono conoscere l'intero segnale (normalizzazione)
+    // ricevono prima una passata di analisi: begin_analysis() e poi analyze()
+    // su ogni blocco, già elaborato dagli effetti che li precedono. Come
+    // process(), analyze() può essere chiamata in parallelo su canali diversi;
+    // i risultati dei canali si combinano nel prepare() successivo.
+    virtual bool needs_analysis() const { return false; }
+    virtual void begin_analysis() {}
+    virtual void analyze(const float* /*samples*/, size_t /*frames*/, int /*channel*/) {}
+
+    virtual const char* name() const = 0;
+};
+
+// Sorgente di blocchi; rewind() serve alla passata di analisi
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+    virtual StreamInfo info() const = 0;
+    // Legge fino a frames frame all'inizio dei canali di dst; 0 a fine flusso
+    virtual size_t read(AudioBuffer& dst, size_t frames) = 0;
+    virtual bool rewind() = 0;
+};
+
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+    // Scrive i primi frames frame dei canali di block
+    virtual bool write(const AudioBuffer& block, size_t frames) = 0;
+};
+
+// Sorgente su un buffer interleaved in memoria (non ne possiede i dati)
+class BufferSource : public AudioSource {
+public:
+    BufferSource(const std::vector<float>& buffer, int sample_rate, int channels);
+    StreamInfo info() const override { return info_; }
+    size_t read(AudioBuffer& dst, size_t frames) override;
+    bool rewind() override { position_ = 0; return true; }
+
+private:
+    const std::vector<float>& buffer_;
+    StreamInfo info_;
+    size_t position_ = 0;   // In frame
+};
+
+// Destinazione su un buffer interleaved in memoria: scrive a partire
+// dall'inizio, quindi può coincidere con il buffer di una BufferSource
+class BufferSink : public AudioSink {
+public:
+    explicit BufferSink(std::vector<float>& buffer, int channels) : buffer_(buffer), channels_(channels) {}
+    bool write(const AudioBuffer& block, size_t frames) override;
+
+private:
+    std::vector<float>& buffer_;
+    int channels_;
+    size_t position_ = 0;   // In frame
+};
+
+class ProcessingGraph {
+public:
+    static constexpr size_t DEFAULT_BLOCK_FRAMES = 1024;
+
+    void add(std::unique_ptr<AudioProcessor> processor);
+    bool empty() const { return processors_.empty(); }
+
+    // Pool su cui elaborare i canali in parallelo (nullptr: in sequenza).
+    // Il pool non è posseduto dal grafo e deve sopravvivergli.
+    void set_thread_pool(ThreadPool* pool) { pool_ = pool; }
+
+    // Trasferisce l'intero flusso da source a sink a blocchi di block_frames.
+    // Per ogni effetto con needs_analysis() viene fatta prima una passata di
+    // analisi (la sorgente viene riavvolta): la memoria resta un solo blocco.
+    bool run(AudioSource& source, AudioSink& sink, size_t block_frames = DEFAULT_BLOCK_FRAMES);
+
+    // Elabora un buffer planare intero in place: ogni canale attraversa tutti
+    // i blocchi in un solo task del pool (stesso risultato di run con lo stesso block_frames)
+    bool process(AudioBuffer& buffer, int sample_rate, size_t block_frames = DEFAULT_BLOCK_FRAMES);
+
+    // Come sopra su un buffer interleaved: il mono si elabora direttamente,
+    // gli altri formati passano da un AudioBuffer
+    bool process(std::vector<float>& buffer, int sample_rate, int channels,
+                 size_t block_frames = DEFAULT_BLOCK_FRAMES);
+
+private:
+    // prepare() e passate di analisi; la sorgente resta da riavvolgere
+    bool run_analysis(AudioSource& source, size_t block_frames);
+
+    // Elaborazione in memoria di channels canali lunghi frames frame
+    bool process_planes(float* const* planes, int channels, size_t frames,
+                        int sample_rate, size_t block_frames);
+
+    // fn(c) per ogni canale, sul pool se c'è
+    void for_each_channel(int channels, const std::function<void(size_t)>& fn);
+
+    std::vector<std::unique_ptr<AudioProcessor>> processors_;
+    ThreadPool* pool_ = nullptr;
+};
+
+// Effetto letto da config.json: tipo e parametri numerici
+struct EffectSpec {
+    std::string type;
+    std::map<std::string, float> params;
+
+    float get(const std::string& key, float fallback) const {
+        auto it = params.find(key);
+        return it != params.end() ? it->second : fallback;
+    }
+};
+
+// Crea l'effetto indicato da spec.type; eccezione se il tipo non esiste
+std::unique_ptr<AudioProcessor> make_audio_processor(const EffectSpec& spec);
+
+// ---- Effetti ----
+
+// Normalizzazione al picco: il picco si misura nella passata di analisi
+class Normalizer : public AudioProcessor {
+public:
+    void prepare(const StreamInfo& info) override;   // Il picco resta quello analizzato
+    void process(float* samples, size_t frames, int channel) override;
+    bool needs_analysis() const override { return true; }
+    void begin_analysis() override;
+    void analyze(const float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "normalize"; }
+
+private:
+    std::vector<float> peaks_;   // Picco analizzato di ogni canale
+    float peak_ = 0.0f;          // Il massimo tra i canali: stesso guadagno per tutti
+};
+
+class FadeIn : public AudioProcessor {
+public:
+    explicit FadeIn(int duration_ms) : duration_ms_(duration_ms) {}
+    void prepare(const StreamInfo& info) override;
+    void process(float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "fade_in"; }
+
+private:
+    int duration_ms_;
+    size_t fade_frames_ = 0;
+    std::vector<size_t> positions_;   // Frame già elaborati di ogni canale
+};
+
+// Il fade-out dipende dalla distanza dalla fine: usa StreamInfo::total_frames
+class FadeOut : public AudioProcessor {
+public:
+    explicit FadeOut(int duration_ms) : duration_ms_(duration_ms) {}
+    void prepare(const StreamInfo& info) override;
+    void process(float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "fade_out"; }
+
+private:
+    int duration_ms_;
+    size_t fade_frames_ = 0;
+    size_t total_frames_ = 0;
+    std::vector<size_t> positions_;
+};
+
+// Equalizzatore parametrico: biquad in cascata, una catena per canale
+class Equalizer : public AudioProcessor {
+public:
+    explicit Equalizer(std::vector<EqBand> bands) : bands_(std::move(bands)) {}
+    // Passa-alto a low_cut e passa-basso a high_cut, Butterworth del secondo ordine (0 = assente)
+    Equalizer(float low_cut, float high_cut);
+    void prepare(const StreamInfo& info) override;
+    void process(float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "equalizer"; }
+
+    // Nuovi parametri della banda index durante il flusso, raggiunti senza
+    // salti; va chiamata tra un blocco e l'altro, non durante process()
+    void set_band(size_t index, const EqBand& band);
+
+private:
+    std::vector<EqBand> bands_;
+    std::vector<BiquadCascade> cascades_;
+};
+
+class NoiseGate : public AudioProcessor {
+public:
+    explicit NoiseGate(float threshold) : threshold_(threshold) {}
+    void prepare(const StreamInfo& /*info*/) override {}
+    void process(float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "noise_gate"; }
+
+private:
+    float threshold_;
+};
+
+class Compressor : public AudioProcessor {
+public:
+    Compressor(float threshold, float ratio) : threshold_(threshold), ratio_(ratio) {}
+    void prepare(const StreamInfo& /*info*/) override {}
+    void process(float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "compressor"; }
+
+private:
+    float threshold_;
+    float ratio_;
+};
+
+// Riverbero FDN a otto linee, una rete indipendente per canale; mix è il
+// livello del segnale riverberato sommato al segnale originale
+class Reverb : public AudioProcessor {
+public:
+    explicit Reverb(float reverb_time, float damping = 0.3f, float mix = 0.3f)
+        : reverb_time_(reverb_time), damping_(damping), mix_(mix) {}
+    void prepare(const StreamInfo& info) override;
+    void process(float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "reverb"; }
+
+private:
+    float reverb_time_;
+    float damping_;
+    float mix_;
+    std::vector<FdnReverb> networks_;
+};
+
+// Riverbero a convoluzione con una risposta all'impulso misurata, divisa in
+// partizioni una volta sola (ConvolutionIr, condivisa). Il canale c usa il
+// canale c della risposta, modulo i suoi canali; mix come in Reverb.
+class ConvolutionReverb : public AudioProcessor {
+public:
+    explicit ConvolutionReverb(std::shared_ptr<const ConvolutionIr> ir, float mix = 0.3f)
+        : ir_(std::move(ir)), mix_(mix) {}
+    void prepare(const StreamInfo& info) override;
+    void process(float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "convolution_reverb"; }
+
+private:
+    std::shared_ptr<const ConvolutionIr> ir_;
+    float mix_;
+    std::vector<PartitionedConvolver> convolvers_;
+};
+
+// Eco con feedback, una linea per canale; il ritardo può essere frazionario
+class Delay : public AudioProcessor {
+public:
+    Delay(float delay_ms, float feedback) : delay_ms_(delay_ms), feedback_(feedback) {}
+    void prepare(const StreamInfo& info) override;
+    void process(float* samples, size_t frames, int channel) override;
+    const char* name() const override { return "delay"; }
+
+private:
+    float delay_ms_;
+    float feedback_;
+    size_t delay_whole_ = 1;
+    float delay_frac_ = 0.0f;
+    std::vector<DelayLine> lines_;
+};
+
+#endif // AUDIO_PROCESSOR_H
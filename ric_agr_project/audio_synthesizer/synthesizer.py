@@ -1,24 +1,108 @@
 from TTS.api import TTS # API di Mozilla Text-To-Speech
+import mmap
 import os
-import soundfile as sf
+import socket
+import struct
 import sys
 import urllib.parse
+import numpy as np
+import soundfile as sf
+
+MODEL_NAME = "tts_models/en/ljspeech/tacotron2-DDC"
+DEFAULT_SAMPLE_RATE = 22050  # Frequenza di campionamento di default del modello
+
+# Carica il modello (operazione lenta: il worker la esegue una sola volta)
+def load_model():
+    return TTS(model_name=MODEL_NAME, gpu=False)
+
+def sample_rate_of(tts):
+    synthesizer = getattr(tts, "synthesizer", None)
+    return getattr(synthesizer, "output_sample_rate", None) or DEFAULT_SAMPLE_RATE
 
 # Funzione per generare tracce vocali
 def generate_audio(text, output_filename):
-    # Carica il modello
-    tts = TTS(model_name="tts_models/en/ljspeech/tacotron2-DDC", gpu=False)
-    
+    tts = load_model()
+
     # Sintetizza la traccia
     wav = tts.tts(text)
-    
+
     # Salva l'audio in un file WAV utilizzando soundfile
-    sf.write(output_filename, wav, 22050)  # 22050 è la frequenza di campionamento di default
+    sf.write(output_filename, wav, sample_rate_of(tts))
     print(f"Audio generato: {output_filename}")
 
+# Legge esattamente n byte dal socket; None se il client ha chiuso
+def recv_exact(conn, n):
+    data = b""
+    while len(data) < n:
+        chunk = conn.recv(n - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+# Scrive i campioni float32 in un segmento di memoria condivisa (/dev/shm) che
+# il client apre, copia e rimuove; restituisce il nome del segmento
+def write_shared_memory(samples, seq):
+    name = f"/ric_agr_tts_{os.getpid()}_{seq}"
+    data = samples.tobytes()
+    fd = os.open("/dev/shm" + name, os.O_CREAT | os.O_EXCL | os.O_RDWR, 0o600)
+    try:
+        os.ftruncate(fd, len(data))
+        with mmap.mmap(fd, len(data)) as shm:
+            shm[:] = data
+    finally:
+        os.close(fd)
+    return name
+
+# Risposta: [i32 stato][u32 sample rate][u32 canali][u32 campioni][u16 lunghezza][nome segmento o errore]
+def send_response(conn, status, sample_rate, samples, text):
+    payload = text.encode("utf-8")
+    conn.sendall(struct.pack("<iIIIH", status, sample_rate, 1, samples, len(payload)) + payload)
+
+# Worker persistente: carica il modello una volta e serve un solo client sul
+# socket Unix indicato. Richiesta: [u32 lunghezza][testo UTF-8]. Termina quando
+# il client chiude la connessione.
+def serve(socket_path):
+    tts = load_model()
+    sample_rate = sample_rate_of(tts)
+
+    if os.path.exists(socket_path):
+        os.unlink(socket_path)
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    server.bind(socket_path)
+    server.listen(1)
+
+    conn, _ = server.accept()
+    server.close()
+    os.unlink(socket_path)
+
+    seq = 0
+    with conn:
+        while True:
+            header = recv_exact(conn, 4)
+            if header is None:
+                break
+            (length,) = struct.unpack("<I", header)
+            payload = recv_exact(conn, length)
+            if payload is None:
+                break
+
+            try:
+                samples = np.asarray(tts.tts(payload.decode("utf-8")), dtype="<f4")
+                name = write_shared_memory(samples, seq) if samples.size else ""
+                seq += 1
+                send_response(conn, 0, sample_rate, samples.size, name)
+            except Exception as e:  # Il worker sopravvive a un testo non sintetizzabile
+                send_response(conn, 1, sample_rate, 0, str(e))
+
 if __name__ == "__main__":
+    if len(sys.argv) == 3 and sys.argv[1] == "--serve":
+        serve(sys.argv[2])
+        sys.exit(0)
+
     if len(sys.argv) != 3:
         print("Usage: python3 synthesizer.py <node_id> <text>")
+        print("       python3 synthesizer.py --serve <socket_path>")
         sys.exit(1)
 
     node_id = sys.argv[1]
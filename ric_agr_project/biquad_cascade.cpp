@@ -0,0 +1,240 @@
+// Biquad in cascata (RBJ) calcolati a gruppi di campioni
+
+#include "biquad_cascade.h"
+#include "dsp_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Un gruppo di campioni come un solo vettore; allineato a 32 byte anche
+// senza -mavx, perché la variante AVX2 lo carica come tale
+typedef float Lane __attribute__((vector_size(BiquadCascade::LANES * sizeof(float)), aligned(32)));
+
+// Scarta denormali nella coda che si spegne: x + 1e-18 - 1e-18 vale 0 per |x| minuscolo
+constexpr float ANTI_DENORMAL = 1e-18f;
+
+struct Coefficients {
+    double b0, b1, b2, a1, a2;
+};
+
+// Audio EQ Cookbook, normalizzato per a0
+Coefficients cookbook(const EqBand& band, int sample_rate) {
+    double frequency = std::clamp<double>(band.frequency, 1.0, 0.49 * sample_rate);
+    double q = std::max(band.q, 0.01f);
+    double w0 = 2.0 * M_PI * frequency / sample_rate;
+    double cos_w0 = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * q);
+    double A = std::pow(10.0, band.gain_db / 40.0);
+    double sqrt_A_alpha = 2.0 * std::sqrt(A) * alpha;
+
+    double b0, b1, b2, a0, a1, a2;
+    switch (band.type) {
+    case EqBandType::LowPass:
+        b0 = (1.0 - cos_w0) / 2.0; b1 = 1.0 - cos_w0; b2 = b0;
+        a0 = 1.0 + alpha; a1 = -2.0 * cos_w0; a2 = 1.0 - alpha;
+        break;
+    case EqBandType::HighPass:
+        b0 = (1.0 + cos_w0) / 2.0; b1 = -(1.0 + cos_w0); b2 = b0;
+        a0 = 1.0 + alpha; a1 = -2.0 * cos_w0; a2 = 1.0 - alpha;
+        break;
+    case EqBandType::LowShelf:
+        b0 = A * ((A + 1) - (A - 1) * cos_w0 + sqrt_A_alpha);
+        b1 = 2 * A * ((A - 1) - (A + 1) * cos_w0);
+        b2 = A * ((A + 1) - (A - 1) * cos_w0 - sqrt_A_alpha);
+        a0 = (A + 1) + (A - 1) * cos_w0 + sqrt_A_alpha;
+        a1 = -2 * ((A - 1) + (A + 1) * cos_w0);
+        a2 = (A + 1) + (A - 1) * cos_w0 - sqrt_A_alpha;
+        break;
+    case EqBandType::HighShelf:
+        b0 = A * ((A + 1) + (A - 1) * cos_w0 + sqrt_A_alpha);
+        b1 = -2 * A * ((A - 1) + (A + 1) * cos_w0);
+        b2 = A * ((A + 1) + (A - 1) * cos_w0 - sqrt_A_alpha);
+        a0 = (A + 1) - (A - 1) * cos_w0 + sqrt_A_alpha;
+        a1 = 2 * ((A - 1) - (A + 1) * cos_w0);
+        a2 = (A + 1) - (A - 1) * cos_w0 - sqrt_A_alpha;
+        break;
+    case EqBandType::Peaking:
+    default:
+        b0 = 1.0 + alpha * A; b1 = -2.0 * cos_w0; b2 = 1.0 - alpha * A;
+        a0 = 1.0 + alpha / A; a1 = -2.0 * cos_w0; a2 = 1.0 - alpha / A;
+        break;
+    }
+    return {b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0};
+}
+
+// Uscite TDF-II per LANES campioni di ingresso x a partire dallo stato (s1, s2)
+void simulate(const Coefficients& c, const double* x, double s1, double s2, double* y) {
+    for (size_t n = 0; n < BiquadCascade::LANES; ++n) {
+        y[n] = c.b0 * x[n] + s1;
+        s1 = c.b1 * x[n] - c.a1 * y[n] + s2;
+        s2 = c.b2 * x[n] - c.a2 * y[n];
+    }
+}
+
+// Frequenza e Q si avvicinano in scala logaritmica, il guadagno in dB
+float approach_log(float current, float target, float keep) {
+    return target * std::pow(current / target, keep);
+}
+
+bool close_enough(const EqBand& a, const EqBand& b) {
+    return std::fabs(a.frequency / b.frequency - 1.0f) < 1e-4f &&
+           std::fabs(a.q / b.q - 1.0f) < 1e-4f &&
+           std::fabs(a.gain_db - b.gain_db) < 1e-3f;
+}
+
+}  // namespace
+
+void BiquadCascade::prepare(int sample_rate, const std::vector<EqBand>& bands) {
+    sample_rate_ = sample_rate;
+    // Dopo un passo resta exp(-passo / tau) della distanza dal target
+    smooth_keep_ = std::exp(-static_cast<float>(SMOOTH_FRAMES) / (SMOOTH_MS / 1000.0f * sample_rate));
+    smoothing_ = false;
+    smooth_countdown_ = 0;
+    sections_.assign(bands.size(), Section());
+    for (size_t i = 0; i < bands.size(); ++i) {
+        sections_[i].current = bands[i];
+        sections_[i].target = bands[i];
+        update_coefficients(sections_[i]);
+    }
+}
+
+void BiquadCascade::set_band(size_t index, const EqBand& band) {
+    Section& section = sections_[index];
+    section.target = band;
+    section.target.type = section.current.type;
+    smoothing_ = true;
+}
+
+void BiquadCascade::update_coefficients(Section& section) {
+    Coefficients c = cookbook(section.current, sample_rate_);
+    section.b1 = static_cast<float>(c.b1);
+    section.b2 = static_cast<float>(c.b2);
+    section.a1 = static_cast<float>(c.a1);
+    section.a2 = static_cast<float>(c.a2);
+
+    // Forma a stati del gruppo: y = somma_k x[k] * impulse[k] + s1 * from_s1 + s2 * from_s2
+    double zero[LANES] = {};
+    double x[LANES], y[LANES];
+    for (size_t k = 0; k < LANES; ++k) {
+        std::fill(x, x + LANES, 0.0);
+        x[k] = 1.0;
+        simulate(c, x, 0.0, 0.0, y);
+        for (size_t n = 0; n < LANES; ++n) section.impulse[k][n] = static_cast<float>(y[n]);
+    }
+    simulate(c, zero, 1.0, 0.0, y);
+    for (size_t n = 0; n < LANES; ++n) section.from_s1[n] = static_cast<float>(y[n]);
+    simulate(c, zero, 0.0, 1.0, y);
+    for (size_t n = 0; n < LANES; ++n) section.from_s2[n] = static_cast<float>(y[n]);
+}
+
+void BiquadCascade::smoothing_step() {
+    bool pending = false;
+    for (Section& section : sections_) {
+        EqBand& current = section.current;
+        const EqBand& target = section.target;
+        if (close_enough(current, target)) {
+            if (current.frequency == target.frequency && current.q == target.q && current.gain_db == target.gain_db) continue;
+            current = target;   // Ultimo passo: esattamente sul target
+        } else {
+            current.frequency = approach_log(current.frequency, target.frequency, smooth_keep_);
+            current.q = approach_log(current.q, target.q, smooth_keep_);
+            current.gain_db = target.gain_db + (current.gain_db - target.gain_db) * smooth_keep_;
+            pending = true;
+        }
+        update_coefficients(section);
+    }
+    smoothing_ = pending;
+}
+
+void BiquadCascade::process(float* samples, size_t frames) {
+    while (frames > 0) {
+        if (smoothing_ && smooth_countdown_ == 0) {
+            smoothing_step();
+            smooth_countdown_ = SMOOTH_FRAMES;
+        }
+        // Durante lo smoothing i coefficienti restano fissi per SMOOTH_FRAMES frame
+        size_t n = smoothing_ ? std::min(frames, smooth_countdown_) : frames;
+        run_sections(samples, n);
+        smooth_countdown_ = smoothing_ ? smooth_countdown_ - n : 0;
+        samples += n;
+        frames -= n;
+    }
+}
+
+void BiquadCascade::run_sections(float* samples, size_t frames) {
+    // Una sezione alla volta su tutto il tratto: coefficienti e stato restano nei registri
+    for (Section& section : sections_) {
+#if defined(__x86_64__) || defined(__i386__)
+        if (dsp_kernels().isa >= DspIsa::AVX2) {
+            run_section_avx2(section, samples, frames);
+            continue;
+        }
+#endif
+        run_section(section, samples, frames);
+    }
+}
+
+namespace {
+
+// Un gruppo di valid campioni (gli altri valgono 0): uscite dalla forma a
+// stati, poi lo stato TDF-II dopo l'ultimo campione ricavato dalle ultime
+// due uscite (s2 = b2 x - a2 y, s1 = b1 x - a1 y + s2 precedente)
+__attribute__((always_inline)) inline void run_group(const Lane (&impulse)[BiquadCascade::LANES],
+                                                     const Lane& from_s1, const Lane& from_s2,
+                                                     float b1, float b2, float a1, float a2,
+                                                     float& s1, float& s2, Lane& x, size_t valid) {
+    Lane y = x[0] * impulse[0];
+    for (size_t k = 1; k < BiquadCascade::LANES; ++k) y += x[k] * impulse[k];
+    y += from_s1 * s1 + from_s2 * s2;
+
+    size_t m = valid - 1;
+    float s2_m = m > 0 ? b2 * x[m - 1] - a2 * y[m - 1] : s2;
+    s1 = b1 * x[m] - a1 * y[m] + s2_m;
+    s2 = b2 * x[m] - a2 * y[m];
+    s1 = (s1 + ANTI_DENORMAL) - ANTI_DENORMAL;
+    s2 = (s2 + ANTI_DENORMAL) - ANTI_DENORMAL;
+    x = y;
+}
+
+template <class Section>
+__attribute__((always_inline)) inline void run_section_lanes(Section& section, float* samples, size_t frames) {
+    constexpr size_t LANES = BiquadCascade::LANES;
+    Lane impulse[LANES];
+    std::memcpy(impulse, section.impulse, sizeof(impulse));
+    Lane from_s1, from_s2;
+    std::memcpy(&from_s1, section.from_s1, sizeof(from_s1));
+    std::memcpy(&from_s2, section.from_s2, sizeof(from_s2));
+    float s1 = section.s1, s2 = section.s2;
+
+    size_t i = 0;
+    for (; i + LANES <= frames; i += LANES) {
+        Lane x;
+        std::memcpy(&x, samples + i, sizeof(x));
+        run_group(impulse, from_s1, from_s2, section.b1, section.b2, section.a1, section.a2, s1, s2, x, LANES);
+        std::memcpy(samples + i, &x, sizeof(x));
+    }
+    if (i < frames) {
+        // Gruppo parziale completato con zeri: non tocca le uscite valide
+        Lane x{};
+        std::memcpy(&x, samples + i, (frames - i) * sizeof(float));
+        run_group(impulse, from_s1, from_s2, section.b1, section.b2, section.a1, section.a2, s1, s2, x, frames - i);
+        std::memcpy(samples + i, &x, (frames - i) * sizeof(float));
+    }
+    section.s1 = s1;
+    section.s2 = s2;
+}
+
+}  // namespace
+
+void BiquadCascade::run_section(Section& section, float* samples, size_t frames) {
+    run_section_lanes(section, samples, frames);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Stesso loop compilato per AVX2: un gruppo occupa un registro invece di due
+__attribute__((target("avx2"))) void BiquadCascade::run_section_avx2(Section& section, float* samples, size_t frames) {
+    run_section_lanes(section, samples, frames);
+}
+#endif
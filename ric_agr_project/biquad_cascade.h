@@ -0,0 +1,70 @@
+// Equalizzatore parametrico a biquad in cascata per un singolo canale:
+// passa-basso, passa-alto, shelf e peaking con i coefficienti dell'Audio EQ
+// Cookbook di R. Bristow-Johnson. Ogni sezione è in forma diretta II trasposta;
+// i campioni si calcolano a gruppi di LANES con la forma a stati del gruppo
+// (risposta all'impulso e risposta allo stato), quindi il loop è SIMD anche
+// se la ricorsione della singola sezione è seriale.
+//
+// I cambi di parametri durante il flusso (set_band) non saltano: frequenza,
+// guadagno e Q si avvicinano al nuovo valore con un passo ogni SMOOTH_FRAMES
+// frame, ricalcolando i coefficienti solo finché lo smoothing è in corso.
+
+#ifndef BIQUAD_CASCADE_H
+#define BIQUAD_CASCADE_H
+
+#include <cstddef>
+#include <vector>
+
+enum class EqBandType { LowPass, HighPass, LowShelf, HighShelf, Peaking };
+
+struct EqBand {
+    EqBandType type = EqBandType::Peaking;
+    float frequency = 1000.0f;   // Hz: taglio, centro o frequenza dello shelf
+    float gain_db = 0.0f;        // Solo shelf e peaking
+    float q = 0.7071f;           // 0.7071: Butterworth per passa-basso e passa-alto
+};
+
+class BiquadCascade {
+public:
+    static constexpr size_t LANES = 8;            // Campioni calcolati insieme
+    static constexpr size_t SMOOTH_FRAMES = 64;   // Frame tra due passi dello smoothing
+    static constexpr float SMOOTH_MS = 20.0f;     // Costante di tempo dello smoothing
+
+    // Inizio del flusso: stato azzerato, parametri subito ai valori di bands
+    void prepare(int sample_rate, const std::vector<EqBand>& bands);
+
+    // Nuovi parametri per la banda index (il tipo resta quello di prepare),
+    // raggiunti gradualmente nei blocchi successivi
+    void set_band(size_t index, const EqBand& band);
+
+    // Filtra in place frames campioni consecutivi del canale
+    void process(float* samples, size_t frames);
+
+private:
+    struct alignas(32) Section {
+        float impulse[LANES][LANES];   // impulse[k][n]: uscita n per un impulso in ingresso k
+        float from_s1[LANES];          // Uscite per lo stato (1, 0) senza ingresso
+        float from_s2[LANES];          // Uscite per lo stato (0, 1) senza ingresso
+        float b1, b2, a1, a2;          // Coefficienti normalizzati (a0 = 1)
+        float s1 = 0.0f;               // Stato TDF-II
+        float s2 = 0.0f;
+        EqBand current;                // Parametri dei coefficienti in uso
+        EqBand target;                 // Parametri da raggiungere
+    };
+
+    void update_coefficients(Section& section);
+    void smoothing_step();
+    void run_sections(float* samples, size_t frames);
+    static void run_section(Section& section, float* samples, size_t frames);
+#if defined(__x86_64__) || defined(__i386__)
+    static void run_section_avx2(Section& section, float* samples, size_t frames);
+#endif
+
+    std::vector<Section> sections_;
+    int sample_rate_ = 0;
+    float smooth_keep_ = 0.0f;    // Quota della distanza dal target che resta dopo un passo
+    bool smoothing_ = false;
+    size_t smooth_countdown_ = 0; // Frame al prossimo passo dello smoothing
+};
+
+#endif // BIQUAD_CASCADE_H
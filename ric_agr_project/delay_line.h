@@ -0,0 +1,60 @@
+// Linea di ritardo su buffer circolare di dimensione potenza di due: l'indice
+// si riduce con una maschera, senza modulo e senza le allocazioni a blocchi di
+// una deque. Le letture frazionarie interpolano linearmente tra due campioni.
+//
+// Frame è il contenuto di una posizione: un float per una linea sola, oppure
+// una struttura con un valore per linea quando più linee avanzano insieme
+// (la FDN scrive le sue otto linee con un solo store).
+
+#ifndef DELAY_LINE_H
+#define DELAY_LINE_H
+
+#include <cstddef>
+#include <vector>
+
+template <class Frame>
+class BasicDelayLine {
+public:
+    // Spazio per ritardi fino a max_delay campioni; la linea riparte da zero
+    void resize(size_t max_delay) {
+        size_t size = 1;
+        while (size < max_delay + 1) size <<= 1;
+        buffer_.assign(size, Frame{});
+        mask_ = size - 1;
+        write_ = 0;
+    }
+
+    void clear() {
+        buffer_.assign(buffer_.size(), Frame{});
+        write_ = 0;
+    }
+
+    void push(const Frame& x) {
+        buffer_[write_ & mask_] = x;
+        ++write_;
+    }
+
+    // Frame inserito delay push fa (1 = l'ultimo); prima del riempimento vale zero
+    const Frame& read(size_t delay) const { return buffer_[(write_ - delay) & mask_]; }
+
+    // Ritardo frazionario whole + frac, con 0 <= frac < 1 (Frame aritmetico)
+    Frame read(size_t whole, float frac) const {
+        const Frame& a = read(whole);
+        const Frame& b = read(whole + 1);
+        return a + frac * (b - a);
+    }
+
+    Frame read_frac(float delay) const {
+        size_t whole = static_cast<size_t>(delay);
+        return read(whole, delay - whole);
+    }
+
+private:
+    std::vector<Frame> buffer_;
+    size_t mask_ = 0;
+    size_t write_ = 0;   // Push totali: la posizione è write_ & mask_
+};
+
+using DelayLine = BasicDelayLine<float>;
+
+#endif // DELAY_LINE_H
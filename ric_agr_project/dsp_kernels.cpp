@@ -0,0 +1,330 @@
+// Kernel SIMD dei loop sui campioni e dispatch a runtime.
+// Le varianti AVX2 e AVX-512 sono compilate con l'attributo target: il
+// Makefile non ha bisogno di flag -m e il binario gira anche su CPU più vecchie.
+
+#include "dsp_kernels.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DSP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// ---- Scalare (riferimento e code dei vettori) ----
+
+float max_abs_scalar(const float* x, size_t n) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; ++i) peak = std::max(peak, std::abs(x[i]));
+    return peak;
+}
+
+void scale_scalar(float* x, size_t n, float gain) {
+    for (size_t i = 0; i < n; ++i) x[i] *= gain;
+}
+
+void noise_gate_scalar(float* x, size_t n, float threshold) {
+    for (size_t i = 0; i < n; ++i) {
+        if (std::abs(x[i]) < threshold) x[i] = 0.0f;
+    }
+}
+
+void compress_scalar(float* x, size_t n, float threshold, float ratio) {
+    for (size_t i = 0; i < n; ++i) {
+        float v = x[i];
+        float mag = std::abs(v);
+        if (mag > threshold) {
+            float excess = mag - threshold;
+            x[i] = (v / mag) * (threshold + excess / ratio);
+        }
+    }
+}
+
+void ramp_scalar(float* x, size_t n, size_t first_step, size_t steps) {
+    for (size_t i = 0; i < n; ++i) {
+        float gain = (float)(first_step + i) / steps;
+        x[i] *= gain;
+    }
+}
+
+#ifdef DSP_X86
+
+// ---- SSE2 (sempre disponibile su x86-64) ----
+
+__attribute__((target("sse2")))
+float max_abs_sse2(const float* x, size_t n) {
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 peak = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        peak = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(x + i), abs_mask), peak);
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, peak);
+    float result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    return std::max(result, max_abs_scalar(x + i, n - i));
+}
+
+__attribute__((target("sse2")))
+void scale_sse2(float* x, size_t n, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), g));
+    scale_scalar(x + i, n - i, gain);
+}
+
+__attribute__((target("sse2")))
+void noise_gate_sse2(float* x, size_t n, float threshold) {
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 t = _mm_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        __m128 below = _mm_cmplt_ps(_mm_and_ps(v, abs_mask), t);
+        _mm_storeu_ps(x + i, _mm_andnot_ps(below, v));
+    }
+    noise_gate_scalar(x + i, n - i, threshold);
+}
+
+__attribute__((target("sse2")))
+void compress_sse2(float* x, size_t n, float threshold, float ratio) {
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 t = _mm_set1_ps(threshold);
+    const __m128 r = _mm_set1_ps(ratio);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        __m128 mag = _mm_and_ps(v, abs_mask);
+        __m128 over = _mm_cmpgt_ps(mag, t);
+        __m128 compressed = _mm_mul_ps(_mm_div_ps(v, mag), _mm_add_ps(t, _mm_div_ps(_mm_sub_ps(mag, t), r)));
+        // Blend senza salti: compressed dove over, v altrove
+        _mm_storeu_ps(x + i, _mm_or_ps(_mm_and_ps(over, compressed), _mm_andnot_ps(over, v)));
+    }
+    compress_scalar(x + i, n - i, threshold, ratio);
+}
+
+__attribute__((target("sse2")))
+void ramp_sse2(float* x, size_t n, size_t first_step, size_t steps) {
+    // I passi sono convertiti da int32: oltre si ricade sulla versione scalare
+    if (first_step + n > static_cast<size_t>(INT_MAX)) return ramp_scalar(x, n, first_step, steps);
+    const __m128 s = _mm_set1_ps((float)steps);
+    __m128i k = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(first_step)), _mm_setr_epi32(0, 1, 2, 3));
+    const __m128i four = _mm_set1_epi32(4);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 gain = _mm_div_ps(_mm_cvtepi32_ps(k), s);
+        _mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), gain));
+        k = _mm_add_epi32(k, four);
+    }
+    ramp_scalar(x + i, n - i, first_step + i, steps);
+}
+
+// ---- AVX2 ----
+
+__attribute__((target("avx2")))
+float max_abs_avx2(const float* x, size_t n) {
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 peak = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        peak = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(x + i), abs_mask), peak);
+    }
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+    half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+    return std::max(_mm_cvtss_f32(half), max_abs_scalar(x + i, n - i));
+}
+
+__attribute__((target("avx2")))
+void scale_avx2(float* x, size_t n, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), g));
+    scale_scalar(x + i, n - i, gain);
+}
+
+__attribute__((target("avx2")))
+void noise_gate_avx2(float* x, size_t n, float threshold) {
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 t = _mm256_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 below = _mm256_cmp_ps(_mm256_and_ps(v, abs_mask), t, _CMP_LT_OQ);
+        _mm256_storeu_ps(x + i, _mm256_andnot_ps(below, v));
+    }
+    noise_gate_scalar(x + i, n - i, threshold);
+}
+
+__attribute__((target("avx2")))
+void compress_avx2(float* x, size_t n, float threshold, float ratio) {
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 t = _mm256_set1_ps(threshold);
+    const __m256 r = _mm256_set1_ps(ratio);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 mag = _mm256_and_ps(v, abs_mask);
+        __m256 over = _mm256_cmp_ps(mag, t, _CMP_GT_OQ);
+        __m256 compressed = _mm256_mul_ps(_mm256_div_ps(v, mag),
+                                          _mm256_add_ps(t, _mm256_div_ps(_mm256_sub_ps(mag, t), r)));
+        _mm256_storeu_ps(x + i, _mm256_blendv_ps(v, compressed, over));
+    }
+    compress_scalar(x + i, n - i, threshold, ratio);
+}
+
+__attribute__((target("avx2")))
+void ramp_avx2(float* x, size_t n, size_t first_step, size_t steps) {
+    if (first_step + n > static_cast<size_t>(INT_MAX)) return ramp_scalar(x, n, first_step, steps);
+    const __m256 s = _mm256_set1_ps((float)steps);
+    __m256i k = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first_step)),
+                                 _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i eight = _mm256_set1_epi32(8);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 gain = _mm256_div_ps(_mm256_cvtepi32_ps(k), s);
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), gain));
+        k = _mm256_add_epi32(k, eight);
+    }
+    ramp_scalar(x + i, n - i, first_step + i, steps);
+}
+
+// ---- AVX-512: la coda usa load e store mascherati invece del loop scalare ----
+
+// Gli header AVX-512 di GCC 12 inizializzano i registri "undefined" con se stessi:
+// falsi positivi di -Wuninitialized nelle funzioni inline degli intrinsic
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+inline __mmask16 tail_mask(size_t remaining) {
+    return static_cast<__mmask16>((1u << remaining) - 1);
+}
+
+__attribute__((target("avx512f")))
+float max_abs_avx512(const float* x, size_t n) {
+    __m512 peak = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) peak = _mm512_max_ps(_mm512_abs_ps(_mm512_loadu_ps(x + i)), peak);
+    if (i < n) {
+        // Le corsie fuori dal buffer valgono 0 e non alterano il massimo
+        peak = _mm512_max_ps(_mm512_abs_ps(_mm512_maskz_loadu_ps(tail_mask(n - i), x + i)), peak);
+    }
+    return _mm512_reduce_max_ps(peak);
+}
+
+__attribute__((target("avx512f")))
+void scale_avx512(float* x, size_t n, float gain) {
+    const __m512 g = _mm512_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) _mm512_storeu_ps(x + i, _mm512_mul_ps(_mm512_loadu_ps(x + i), g));
+    if (i < n) {
+        __mmask16 m = tail_mask(n - i);
+        _mm512_mask_storeu_ps(x + i, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, x + i), g));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline __m512 noise_gate_lanes(__m512 v, __m512 t) {
+    __mmask16 below = _mm512_cmp_ps_mask(_mm512_abs_ps(v), t, _CMP_LT_OQ);
+    return _mm512_mask_blend_ps(below, v, _mm512_setzero_ps());
+}
+
+__attribute__((target("avx512f")))
+void noise_gate_avx512(float* x, size_t n, float threshold) {
+    const __m512 t = _mm512_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) _mm512_storeu_ps(x + i, noise_gate_lanes(_mm512_loadu_ps(x + i), t));
+    if (i < n) {
+        __mmask16 m = tail_mask(n - i);
+        _mm512_mask_storeu_ps(x + i, m, noise_gate_lanes(_mm512_maskz_loadu_ps(m, x + i), t));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline __m512 compress_lanes(__m512 v, __m512 t, __m512 r) {
+    __m512 mag = _mm512_abs_ps(v);
+    __mmask16 over = _mm512_cmp_ps_mask(mag, t, _CMP_GT_OQ);
+    __m512 compressed = _mm512_mul_ps(_mm512_div_ps(v, mag), _mm512_add_ps(t, _mm512_div_ps(_mm512_sub_ps(mag, t), r)));
+    return _mm512_mask_blend_ps(over, v, compressed);
+}
+
+__attribute__((target("avx512f")))
+void compress_avx512(float* x, size_t n, float threshold, float ratio) {
+    const __m512 t = _mm512_set1_ps(threshold);
+    const __m512 r = _mm512_set1_ps(ratio);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) _mm512_storeu_ps(x + i, compress_lanes(_mm512_loadu_ps(x + i), t, r));
+    if (i < n) {
+        __mmask16 m = tail_mask(n - i);
+        _mm512_mask_storeu_ps(x + i, m, compress_lanes(_mm512_maskz_loadu_ps(m, x + i), t, r));
+    }
+}
+
+__attribute__((target("avx512f")))
+void ramp_avx512(float* x, size_t n, size_t first_step, size_t steps) {
+    if (first_step + n > static_cast<size_t>(INT_MAX)) return ramp_scalar(x, n, first_step, steps);
+    const __m512 s = _mm512_set1_ps((float)steps);
+    __m512i k = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(first_step)),
+                                 _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    const __m512i sixteen = _mm512_set1_epi32(16);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 gain = _mm512_div_ps(_mm512_cvtepi32_ps(k), s);
+        _mm512_storeu_ps(x + i, _mm512_mul_ps(_mm512_loadu_ps(x + i), gain));
+        k = _mm512_add_epi32(k, sixteen);
+    }
+    if (i < n) {
+        __mmask16 m = tail_mask(n - i);
+        __m512 gain = _mm512_div_ps(_mm512_cvtepi32_ps(k), s);
+        _mm512_mask_storeu_ps(x + i, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, x + i), gain));
+    }
+}
+
+#pragma GCC diagnostic pop
+
+#endif // DSP_X86
+
+const DspKernels SCALAR_KERNELS{DspIsa::SCALAR, "scalar", max_abs_scalar, scale_scalar,
+                                noise_gate_scalar, compress_scalar, ramp_scalar};
+#ifdef DSP_X86
+const DspKernels SSE2_KERNELS{DspIsa::SSE2, "sse2", max_abs_sse2, scale_sse2,
+                              noise_gate_sse2, compress_sse2, ramp_sse2};
+const DspKernels AVX2_KERNELS{DspIsa::AVX2, "avx2", max_abs_avx2, scale_avx2,
+                              noise_gate_avx2, compress_avx2, ramp_avx2};
+const DspKernels AVX512_KERNELS{DspIsa::AVX512, "avx512", max_abs_avx512, scale_avx512,
+                                noise_gate_avx512, compress_avx512, ramp_avx512};
+#endif
+
+}  // namespace
+
+const DspKernels* dsp_kernels_for(DspIsa isa) {
+    switch (isa) {
+    case DspIsa::SCALAR:
+        return &SCALAR_KERNELS;
+#ifdef DSP_X86
+    case DspIsa::SSE2:
+        return __builtin_cpu_supports("sse2") ? &SSE2_KERNELS : nullptr;
+    case DspIsa::AVX2:
+        return __builtin_cpu_supports("avx2") ? &AVX2_KERNELS : nullptr;
+    case DspIsa::AVX512:
+        return __builtin_cpu_supports("avx512f") ? &AVX512_KERNELS : nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const DspKernels& dsp_kernels() {
+    static const DspKernels& best = [] () -> const DspKernels& {
+        for (DspIsa isa : {DspIsa::AVX512, DspIsa::AVX2, DspIsa::SSE2}) {
+            if (const DspKernels* kernels = dsp_kernels_for(isa)) return *kernels;
+        }
+        return SCALAR_KERNELS;
+    }();
+    return best;
+}
@@ -0,0 +1,42 @@
+// Kernel vettoriali dei loop sui campioni (normalizzazione, noise gate,
+// compressione, fade) con scelta a runtime dell'istruzione SIMD migliore
+// disponibile: AVX-512, AVX2, SSE2 o la versione scalare.
+//
+// Tolleranza: tutte le varianti eseguono le stesse operazioni IEEE nello
+// stesso ordine per ogni campione (nessuna FMA, nessun reciproco approssimato),
+// quindi i risultati coincidono bit per bit con la versione scalare.
+
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <cstddef>
+
+enum class DspIsa { SCALAR, SSE2, AVX2, AVX512 };
+
+struct DspKernels {
+    DspIsa isa;
+    const char* name;
+
+    // Massimo di |x[i]| (0 se n == 0)
+    float (*max_abs)(const float* x, size_t n);
+
+    // x[i] *= gain
+    void (*scale)(float* x, size_t n, float gain);
+
+    // x[i] = 0 se |x[i]| < threshold
+    void (*noise_gate)(float* x, size_t n, float threshold);
+
+    // Oltre threshold l'eccesso viene diviso per ratio (segno conservato)
+    void (*compress)(float* x, size_t n, float threshold, float ratio);
+
+    // Rampa dei fade: x[i] *= (first_step + i) / steps
+    void (*ramp)(float* x, size_t n, size_t first_step, size_t steps);
+};
+
+// Kernel migliori per la CPU corrente (scelti una volta sola)
+const DspKernels& dsp_kernels();
+
+// Kernel di una variante specifica; nullptr se la CPU non la supporta
+const DspKernels* dsp_kernels_for(DspIsa isa);
+
+#endif // DSP_KERNELS_H
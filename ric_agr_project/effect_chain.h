@@ -0,0 +1,317 @@
+// Catena di effetti fusa a tempo di compilazione: Chain<NoiseGate, Compressor, ...>
+// applica tutti gli stadi a un gruppo di campioni prima di passare al successivo,
+// in un unico loop che il compilatore inlinea. Ogni campione viene letto e
+// scritto una volta sola invece che una volta per effetto.
+//
+// Il loop lavora a lane di CHAIN_LANES campioni consecutivi di un canale (estensioni
+// vettoriali di GCC): gli stadi sono scritti senza salti e il compilatore li
+// traduce in istruzioni SIMD, con il codice AVX2 scelto a runtime se disponibile.
+//
+// Uno stadio ha uno stato proprio e l'interfaccia:
+//   static constexpr bool analyzes;        // Serve una passata di analisi?
+//   void prepare(const StreamInfo& info);  // Inizio del flusso
+//   void tick(LaneF& x, size_t n);         // In place; n = frame della prima lane
+// e, se analyzes, begin_analysis(), observe(const LaneF& x) e merge(other),
+// che unisce l'analisi di un altro canale.
+// Ogni canale ha la propria copia degli stadi: i canali si elaborano in
+// parallelo e le analisi si uniscono nel prepare() successivo.
+// Le lane si passano sempre per riferimento: un vettore da 32 byte per valore
+// avrebbe un ABI diverso tra codice con e senza AVX.
+//
+// Un Chain è un AudioProcessor: si aggiunge a un ProcessingGraph come un
+// effetto qualsiasi. Il ProcessingGraph costruito da config.json resta la
+// catena configurabile a runtime.
+
+#ifndef EFFECT_CHAIN_H
+#define EFFECT_CHAIN_H
+
+#include "audio_processor.h"
+#include "dsp_kernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+constexpr size_t CHAIN_LANES = 8;
+// Allineamento esplicito: senza -mavx GCC allinea questi tipi a 16 byte, ma il
+// codice compilato per AVX2 li carica da memoria come se fossero a 32
+typedef float LaneF __attribute__((vector_size(CHAIN_LANES * sizeof(float)), aligned(32)));
+typedef int32_t LaneI __attribute__((vector_size(CHAIN_LANES * sizeof(int32_t)), aligned(32)));
+
+constexpr LaneI LANE_ABS_MASK = {0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF,
+                                 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF};
+constexpr LaneI LANE_INDEX = {0, 1, 2, 3, 4, 5, 6, 7};
+
+// ---- Stadi (stesse operazioni IEEE dei kernel di dsp_kernels.h: risultati identici) ----
+
+class GateStage {
+public:
+    static constexpr bool analyzes = false;
+    explicit GateStage(float threshold) : threshold_(threshold) {}
+    void prepare(const StreamInfo& /*info*/) {}
+    void tick(LaneF& x, size_t /*n*/) const {
+        LaneF mag = (LaneF)((LaneI)x & LANE_ABS_MASK);
+        x = mag < threshold_ ? LaneF{} : x;
+    }
+
+private:
+    float threshold_;
+};
+
+class CompressorStage {
+public:
+    static constexpr bool analyzes = false;
+    CompressorStage(float threshold, float ratio) : threshold_(threshold), ratio_(ratio) {}
+    void prepare(const StreamInfo& /*info*/) {}
+    void tick(LaneF& x, size_t /*n*/) const {
+        // Calcolato su tutte le lane e poi selezionato (0/0 finisce nelle lane scartate)
+        LaneF mag = (LaneF)((LaneI)x & LANE_ABS_MASK);
+        LaneF compressed = (x / mag) * (threshold_ + (mag - threshold_) / ratio_);
+        x = mag > threshold_ ? compressed : x;
+    }
+
+private:
+    float threshold_;
+    float ratio_;
+};
+
+// I passi dei fade sono interi a 32 bit: fade più lunghi di INT_MAX campioni non sono previsti
+class FadeInStage {
+public:
+    static constexpr bool analyzes = false;
+    explicit FadeInStage(int duration_ms) : duration_ms_(duration_ms) {}
+    void prepare(const StreamInfo& info) {
+        fade_frames_ = (size_t)(duration_ms_ / 1000.0f * info.sample_rate);
+    }
+    void tick(LaneF& x, size_t n) const {
+        if (n >= fade_frames_) return;
+        LaneI step = static_cast<int32_t>(n) + LANE_INDEX;
+        LaneF gain = __builtin_convertvector(step, LaneF) / (float)fade_frames_;
+        x = step < static_cast<int32_t>(fade_frames_) ? x * gain : x;
+    }
+
+private:
+    int duration_ms_;
+    size_t fade_frames_ = 0;
+};
+
+class FadeOutStage {
+public:
+    static constexpr bool analyzes = false;
+    explicit FadeOutStage(int duration_ms) : duration_ms_(duration_ms) {}
+    void prepare(const StreamInfo& info) {
+        fade_frames_ = (size_t)(duration_ms_ / 1000.0f * info.sample_rate);
+        total_frames_ = info.total_frames;
+        fade_start_ = total_frames_ > fade_frames_ ? total_frames_ - fade_frames_ : 0;
+    }
+    void tick(LaneF& x, size_t n) const {
+        if (n + CHAIN_LANES <= fade_start_) return;
+        // Passo n + 1 + fade_frames_ - total_frames_: almeno 1 dentro il fade,
+        // piccolo e negativo nelle lane che lo precedono
+        LaneI step = static_cast<int32_t>(n + 1 + fade_frames_ - total_frames_) + LANE_INDEX;
+        LaneF gain = __builtin_convertvector(step, LaneF) / (float)fade_frames_;
+        x = step > 0 ? x * gain : x;
+    }
+
+private:
+    int duration_ms_;
+    size_t fade_frames_ = 0;
+    size_t total_frames_ = 0;
+    size_t fade_start_ = 0;
+};
+
+// Normalizzazione al picco misurato nella passata di analisi (il massimo tra
+// i canali, come Normalizer: tutti i canali ricevono lo stesso guadagno)
+class NormalizeStage {
+public:
+    static constexpr bool analyzes = true;
+    void prepare(const StreamInfo& /*info*/) {
+        peak_ = 0.0f;
+        for (size_t i = 0; i < CHAIN_LANES; ++i) peak_ = std::max(peak_, peak_lanes_[i]);
+        gain_ = peak_ > 0.0f ? 1.0f / peak_ : 1.0f;
+    }
+    void begin_analysis() { peak_lanes_ = LaneF{}; }
+    void observe(const LaneF& x) {
+        LaneF mag = (LaneF)((LaneI)x & LANE_ABS_MASK);
+        peak_lanes_ = mag > peak_lanes_ ? mag : peak_lanes_;
+    }
+    void merge(const NormalizeStage& other) {
+        peak_lanes_ = other.peak_lanes_ > peak_lanes_ ? other.peak_lanes_ : peak_lanes_;
+    }
+    void tick(LaneF& x, size_t /*n*/) const {
+        if (peak_ > 0.0f) x *= gain_;
+    }
+
+private:
+    LaneF peak_lanes_{};
+    float peak_ = 0.0f;
+    float gain_ = 1.0f;
+};
+
+// ---- Catena ----
+
+template <class... Stages>
+class Chain : public AudioProcessor {
+    static constexpr int ANALYZING_STAGES = (0 + ... + (Stages::analyzes ? 1 : 0));
+    // Con un solo stadio di analisi basta una passata (come il ProcessingGraph per effetto)
+    static_assert(ANALYZING_STAGES <= 1, "Chain supports at most one analyzing stage");
+
+public:
+    explicit Chain(const Stages&... stages) : initial_(stages...) {}
+
+    void prepare(const StreamInfo& info) override {
+        info_ = info;
+        if (stages_.size() != static_cast<size_t>(info.channels)) stages_.assign(info.channels, initial_);
+        positions_.assign(info.channels, 0);
+        merge_analysis_at<0>();
+        for (auto& stages : stages_) {
+            std::apply([&](auto&... stage) { (stage.prepare(info), ...); }, stages);
+        }
+    }
+
+    void process(float* samples, size_t frames, int channel) override {
+        StageTuple& stages = stages_[channel];
+        size_t& position = positions_[channel];
+#if defined(__x86_64__) || defined(__i386__)
+        if (dsp_kernels().isa >= DspIsa::AVX2) {
+            process_avx2(stages, samples, frames, position);
+            position += frames;
+            return;
+        }
+#endif
+        process_lanes(stages, samples, frames, position);
+        position += frames;
+    }
+
+    bool needs_analysis() const override { return ANALYZING_STAGES > 0; }
+
+    void begin_analysis() override {
+        // Gli stadi prima di quello di analisi ripartono dall'inizio del flusso
+        prepare(info_);
+        for (auto& stages : stages_) begin_analysis_at<0>(stages);
+    }
+
+    void analyze(const float* samples, size_t frames, int channel) override {
+        StageTuple& stages = stages_[channel];
+        size_t& position = positions_[channel];
+#if defined(__x86_64__) || defined(__i386__)
+        if (dsp_kernels().isa >= DspIsa::AVX2) {
+            analyze_avx2(stages, samples, frames, position);
+            position += frames;
+            return;
+        }
+#endif
+        analyze_lanes(stages, samples, frames, position);
+        position += frames;
+    }
+
+    const char* name() const override { return "chain"; }
+
+private:
+    using StageTuple = std::tuple<Stages...>;
+
+    // Un solo loop: ogni lane attraversa tutti gli stadi tra un load e uno store.
+    // La coda del blocco usa una lane parziale completata con zeri.
+    __attribute__((always_inline)) static void process_lanes(StageTuple& stages, float* samples,
+                                                             size_t frames, size_t position) {
+        size_t i = 0;
+        for (; i + CHAIN_LANES <= frames; i += CHAIN_LANES) {
+            LaneF x;
+            std::memcpy(&x, samples + i, sizeof(x));
+            tick_all(stages, x, position + i);
+            std::memcpy(samples + i, &x, sizeof(x));
+        }
+        if (i < frames) {
+            LaneF x{};
+            std::memcpy(&x, samples + i, (frames - i) * sizeof(float));
+            tick_all(stages, x, position + i);
+            std::memcpy(samples + i, &x, (frames - i) * sizeof(float));
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Stesso loop compilato per AVX2: una lane occupa un registro invece di due
+    __attribute__((target("avx2"))) static void process_avx2(StageTuple& stages, float* samples,
+                                                             size_t frames, size_t position) {
+        process_lanes(stages, samples, frames, position);
+    }
+#endif
+
+    __attribute__((always_inline)) static void analyze_lanes(StageTuple& stages, const float* samples,
+                                                             size_t frames, size_t position) {
+        size_t i = 0;
+        for (; i + CHAIN_LANES <= frames; i += CHAIN_LANES) {
+            LaneF x;
+            std::memcpy(&x, samples + i, sizeof(x));
+            observe_at<0>(stages, x, position + i, CHAIN_LANES);
+        }
+        if (i < frames) {
+            LaneF x{};
+            std::memcpy(&x, samples + i, (frames - i) * sizeof(float));
+            observe_at<0>(stages, x, position + i, static_cast<int>(frames - i));
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    __attribute__((target("avx2"))) static void analyze_avx2(StageTuple& stages, const float* samples,
+                                                             size_t frames, size_t position) {
+        analyze_lanes(stages, samples, frames, position);
+    }
+#endif
+
+    __attribute__((always_inline)) static void tick_all(StageTuple& stages, LaneF& x, size_t n) {
+        std::apply([&](auto&... stage) __attribute__((always_inline)) { (stage.tick(x, n), ...); }, stages);
+    }
+
+    template <size_t I>
+    static void begin_analysis_at(StageTuple& stages) {
+        if constexpr (I < sizeof...(Stages)) {
+            auto& stage = std::get<I>(stages);
+            if constexpr (std::decay_t<decltype(stage)>::analyzes) stage.begin_analysis();
+            else begin_analysis_at<I + 1>(stages);
+        }
+    }
+
+    // Unisce le analisi dei canali e ne dà il risultato a tutti i canali
+    template <size_t I>
+    void merge_analysis_at() {
+        if constexpr (I < sizeof...(Stages)) {
+            if constexpr (std::tuple_element_t<I, StageTuple>::analyzes) {
+                if (stages_.empty()) return;
+                auto& merged = std::get<I>(stages_[0]);
+                for (size_t c = 1; c < stages_.size(); ++c) merged.merge(std::get<I>(stages_[c]));
+                for (size_t c = 1; c < stages_.size(); ++c) std::get<I>(stages_[c]) = merged;
+            } else {
+                merge_analysis_at<I + 1>();
+            }
+        }
+    }
+
+    // Applica gli stadi che precedono quello di analisi, poi gli passa le prime
+    // valid lane (le altre, oltre la fine del blocco, valgono 0)
+    template <size_t I>
+    __attribute__((always_inline)) static void observe_at(StageTuple& stages, LaneF& x, size_t n, int valid) {
+        if constexpr (I < sizeof...(Stages)) {
+            auto& stage = std::get<I>(stages);
+            if constexpr (std::decay_t<decltype(stage)>::analyzes) {
+                stage.observe(LANE_INDEX < valid ? x : LaneF{});
+            } else {
+                stage.tick(x, n);
+                observe_at<I + 1>(stages, x, n, valid);
+            }
+        }
+    }
+
+    StageTuple initial_;               // Stadi come costruiti, copiati per ogni canale
+    std::vector<StageTuple> stages_;   // Uno per canale
+    std::vector<size_t> positions_;    // Frame già elaborati (o analizzati) di ogni canale
+    StreamInfo info_;
+};
+
+// Catena tipica della voce sintetizzata, fusa in un solo loop:
+// noise gate -> compressore -> fade-in -> fade-out -> normalizzazione
+using VoiceChain = Chain<GateStage, CompressorStage, FadeInStage, FadeOutStage, NormalizeStage>;
+
+#endif // EFFECT_CHAIN_H
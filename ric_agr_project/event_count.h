@@ -0,0 +1,71 @@
+// Contatore di eventi su futex (Linux): chi attende non perde le notifiche
+// arrivate tra il controllo della condizione e la sospensione, chi notifica
+// non prende alcun lock e fa una syscall solo se qualcuno sta attendendo.
+//
+// Uso:  key = prepare_wait(); if (condizione) cancel_wait(); else wait(key, limite);
+
+#ifndef EVENT_COUNT_H
+#define EVENT_COUNT_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+class EventCount {
+public:
+    // Registra il chiamante come in attesa e restituisce la chiave da passare a wait()
+    uint32_t prepare_wait() {
+        waiters_.fetch_add(1);
+        return seq_.load();
+    }
+
+    // La condizione era già vera: annulla prepare_wait()
+    void cancel_wait() {
+        waiters_.fetch_sub(1);
+    }
+
+    // Si sospende finché non arriva una notify successiva a prepare_wait()
+    // (o un risveglio spurio). false se give_up_at era già passato.
+    bool wait(uint32_t key, std::chrono::steady_clock::time_point give_up_at) {
+        timespec timeout{};
+        timespec* timeout_ptr = nullptr;
+        if (give_up_at != std::chrono::steady_clock::time_point::max()) {
+            auto remaining = give_up_at - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::steady_clock::duration::zero()) {
+                waiters_.fetch_sub(1);
+                return false;
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+            timeout.tv_sec = static_cast<time_t>(ns / 1000000000);
+            timeout.tv_nsec = static_cast<long>(ns % 1000000000);
+            timeout_ptr = &timeout;
+        }
+        // Ritorna subito se seq_ è già cambiato rispetto a key
+        syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, key, timeout_ptr, nullptr, 0);
+        waiters_.fetch_sub(1);
+        return true;
+    }
+
+    // Risveglia tutti i thread in attesa
+    void notify_all() {
+        seq_.fetch_add(1);
+        if (waiters_.load() > 0) {
+            syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+private:
+    uint32_t* futex_word() { return reinterpret_cast<uint32_t*>(&seq_); }
+
+    std::atomic<uint32_t> seq_{0};       // Incrementato a ogni notifica (parola del futex)
+    std::atomic<uint32_t> waiters_{0};   // Thread tra prepare_wait() e la fine di wait()
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bit");
+};
+
+#endif // EVENT_COUNT_H
@@ -0,0 +1,81 @@
+// Rilevatore di guasti a heartbeat
+
+#include "failure_detector.h"
+#include "network.h"
+#include <algorithm>
+#include <iostream>
+
+FailureDetector::FailureDetector(int self_id, Network* network, std::vector<int> peers,
+                                 std::chrono::milliseconds heartbeat_interval,
+                                 std::chrono::milliseconds suspect_timeout)
+    : self_id_(self_id), network_(network), peers_(std::move(peers)),
+      heartbeat_interval_(heartbeat_interval), suspect_timeout_(suspect_timeout) {
+    int size = peers_.empty() ? 0 : *std::max_element(peers_.begin(), peers_.end()) + 1;
+    last_heard_ms_ = std::vector<std::atomic<long long>>(size);
+    suspected_ = std::vector<std::atomic<bool>>(size);
+}
+
+FailureDetector::~FailureDetector() {
+    stop();
+}
+
+void FailureDetector::set_callbacks(std::function<void(int)> on_down, std::function<void(int)> on_up) {
+    on_down_ = std::move(on_down);
+    on_up_ = std::move(on_up);
+}
+
+void FailureDetector::start() {
+    // All'avvio ogni peer ha un intero timeout per farsi sentire
+    long long now = now_ms();
+    for (int peer : peers_) last_heard_ms_[peer].store(now);
+    thread_ = std::thread(&FailureDetector::run, this);
+}
+
+void FailureDetector::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void FailureDetector::heard_from(int peer) {
+    if (peer < 0 || peer >= static_cast<int>(last_heard_ms_.size())) return;
+    last_heard_ms_[peer].store(now_ms(), std::memory_order_relaxed);
+}
+
+bool FailureDetector::suspected(int peer) const {
+    if (peer < 0 || peer >= static_cast<int>(suspected_.size())) return false;
+    return suspected_[peer].load();
+}
+
+void FailureDetector::run() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (!stopping_) {
+        lock.unlock();
+        network_->broadcast(Message(MessageType::HEARTBEAT, self_id_, 0, 0));
+
+        // Sospetta chi tace da troppo, riammette chi è tornato a farsi sentire
+        long long now = now_ms();
+        for (int peer : peers_) {
+            bool silent = now - last_heard_ms_[peer].load(std::memory_order_relaxed) > suspect_timeout_.count();
+            if (silent && !suspected_[peer].load()) {
+                suspected_[peer].store(true);
+                std::cout << "[Node " << self_id_ << "] Peer " << peer << " suspected down" << std::endl;
+                if (on_down_) on_down_(peer);
+            } else if (!silent && suspected_[peer].load()) {
+                suspected_[peer].store(false);
+                std::cout << "[Node " << self_id_ << "] Peer " << peer << " is back" << std::endl;
+                if (on_up_) on_up_(peer);
+            }
+        }
+
+        lock.lock();
+        cv_.wait_for(lock, heartbeat_interval_, [this] { return stopping_; });
+    }
+}
+
+long long FailureDetector::now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,67 @@
+// Rilevatore di guasti basato su heartbeat, sopra Network: ogni nodo invia
+// periodicamente un HEARTBEAT a tutti i peer; un peer da cui non arriva nulla
+// (heartbeat o messaggi del protocollo) per suspect_timeout viene sospettato
+// e riammesso appena torna a farsi sentire.
+
+#ifndef FAILURE_DETECTOR_H
+#define FAILURE_DETECTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Network;
+
+class FailureDetector {
+public:
+    FailureDetector(int self_id, Network* network, std::vector<int> peers,
+                    std::chrono::milliseconds heartbeat_interval,
+                    std::chrono::milliseconds suspect_timeout);
+
+    // Ferma il thread degli heartbeat
+    ~FailureDetector();
+
+    // Callback invocate dal thread del rilevatore quando un peer viene
+    // sospettato o riammesso (da impostare prima di start())
+    void set_callbacks(std::function<void(int)> on_down, std::function<void(int)> on_up);
+
+    // Avvia l'invio degli heartbeat e il controllo dei timeout
+    void start();
+
+    // Smette di inviare heartbeat (il nodo appare guasto agli altri)
+    void stop();
+
+    // Segno di vita dal peer: chiamata per ogni messaggio ricevuto
+    void heard_from(int peer);
+
+    // true se il peer è attualmente sospettato
+    bool suspected(int peer) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Loop del rilevatore: heartbeat e controllo dei timeout a ogni intervallo
+    void run();
+
+    static long long now_ms();
+
+    int self_id_;
+    Network* network_;
+    std::vector<int> peers_;
+    std::chrono::milliseconds heartbeat_interval_;
+    std::chrono::milliseconds suspect_timeout_;
+    std::vector<std::atomic<long long>> last_heard_ms_;   // Indicizzato per node id
+    std::vector<std::atomic<bool>> suspected_;             // Indicizzato per node id
+    std::function<void(int)> on_down_;
+    std::function<void(int)> on_up_;
+    std::mutex mtx_;
+    std::condition_variable cv_;                           // Interrompe l'attesa tra due heartbeat
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+#endif // FAILURE_DETECTOR_H
@@ -0,0 +1,107 @@
+// Feedback delay network a otto linee
+
+#include "fdn_reverb.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Le otto linee come un solo vettore (estensioni vettoriali di GCC): usato
+// solo all'interno di questo file, mai passato per valore tra unità diverse
+typedef float Lines __attribute__((vector_size(FdnReverb::LINES * sizeof(float))));
+typedef int Indices __attribute__((vector_size(FdnReverb::LINES * sizeof(int))));
+
+// Lunghezze di base in ms, scelte sparse tra 30 e 80 ms
+constexpr float BASE_LENGTH_MS[FdnReverb::LINES] = {29.7f, 37.1f, 41.1f, 43.7f, 53.9f, 61.3f, 67.9f, 73.1f};
+
+// Scarta denormali nella coda che si spegne: x + 1e-18 - 1e-18 vale 0 per |x| minuscolo
+constexpr float ANTI_DENORMAL = 1e-18f;
+
+bool is_prime(size_t n) {
+    if (n < 2) return false;
+    for (size_t d = 2; d * d <= n; ++d) {
+        if (n % d == 0) return false;
+    }
+    return true;
+}
+
+size_t next_prime(size_t n) {
+    while (!is_prime(n)) ++n;
+    return n;
+}
+
+// Trasformata di Hadamard veloce su 8 elementi, normalizzata (matrice ortogonale):
+// a ogni stadio l'elemento j si combina con j ^ h
+void hadamard(Lines& v) {
+    v = __builtin_shuffle(v, Indices{1, 0, 3, 2, 5, 4, 7, 6}) + Lines{1, -1, 1, -1, 1, -1, 1, -1} * v;
+    v = __builtin_shuffle(v, Indices{2, 3, 0, 1, 6, 7, 4, 5}) + Lines{1, 1, -1, -1, 1, 1, -1, -1} * v;
+    v = __builtin_shuffle(v, Indices{4, 5, 6, 7, 0, 1, 2, 3}) + Lines{1, 1, 1, 1, -1, -1, -1, -1} * v;
+    v *= 0.35355339f;   // 1 / sqrt(8)
+}
+
+}  // namespace
+
+void FdnReverb::prepare(int sample_rate, float reverb_time, float damping, int channel) {
+    damping_ = std::clamp(damping, 0.0f, 0.99f);
+    // Ogni canale allunga le linee di un 1.3% in più: lunghezze diverse, code scorrelate
+    float spread = 1.0f + 0.013f * channel;
+    size_t previous = 0;
+    for (size_t j = 0; j < LINES; ++j) {
+        size_t samples = static_cast<size_t>(BASE_LENGTH_MS[j] * spread / 1000.0f * sample_rate);
+        // Lunghezze prime e distinte: a due a due prime tra loro, niente risonanze comuni
+        length_[j] = next_prime(std::max(samples, previous + 1));
+        previous = length_[j];
+        // Attenuazione per giro tale da perdere 60 dB in reverb_time secondi
+        gain_[j] = reverb_time > 0.0f
+                       ? std::pow(10.0f, -3.0f * length_[j] / (reverb_time * sample_rate))
+                       : 0.0f;
+        lowpass_[j] = 0.0f;
+    }
+    lines_.resize(length_[LINES - 1]);   // La più lunga
+}
+
+void FdnReverb::process(float* samples, size_t frames, float mix) {
+    // Stato e costanti restano nei registri per tutto il blocco
+    Lines lowpass, gain;
+    std::memcpy(&lowpass, lowpass_, sizeof(lowpass));
+    std::memcpy(&gain, gain_, sizeof(gain));
+    const Lines signs = {1, -1, 1, -1, 1, -1, 1, -1};
+
+    alignas(32) float taps[BATCH][LINES];
+    for (size_t done = 0; done < frames;) {
+        // Nessuna linea è più corta del lotto: le uscite di tutto il lotto sono
+        // già nelle linee e si leggono prima, una linea alla volta. Così il loop
+        // principale carica le otto uscite di un campione con un solo load.
+        size_t batch = std::min({frames - done, BATCH, length_[0]});
+        for (size_t j = 0; j < LINES; ++j) {
+            for (size_t t = 0; t < batch; ++t) taps[t][j] = lines_.read(length_[j] - t).line[j];
+        }
+
+        for (size_t t = 0; t < batch; ++t, ++samples) {
+            Lines out;
+            std::memcpy(&out, taps[t], sizeof(out));
+
+            // Passa-basso a un polo in ogni anello, poi attenuazione e mixing
+            lowpass = out + damping_ * (lowpass - out);
+            lowpass = (lowpass + ANTI_DENORMAL) - ANTI_DENORMAL;
+            Lines feedback = lowpass * gain;
+            hadamard(feedback);
+
+            // L'ingresso entra in tutte le linee con ampiezza 1/sqrt(8)
+            Lines input = *samples * 0.35355339f + feedback;
+            Frame frame;
+            std::memcpy(frame.line, &input, sizeof(input));
+            lines_.push(frame);
+
+            // Uscita: somma delle linee a segni alterni, normalizzata come l'ingresso
+            Lines wet = out * signs;
+            wet += __builtin_shuffle(wet, Indices{4, 5, 6, 7, 0, 1, 2, 3});
+            wet += __builtin_shuffle(wet, Indices{2, 3, 0, 1, 6, 7, 4, 5});
+            wet += __builtin_shuffle(wet, Indices{1, 0, 3, 2, 5, 4, 7, 6});
+            *samples += mix * (wet[0] * 0.35355339f);
+        }
+        done += batch;
+    }
+    std::memcpy(lowpass_, &lowpass, sizeof(lowpass));
+}
@@ -0,0 +1,41 @@
+// Riverbero a feedback delay network (FDN) per un singolo canale: otto linee
+// di ritardo di lunghezze prime tra loro, matrice di Hadamard come mixing
+// (ortogonale, quindi senza perdite né guadagno) e un passa-basso a un polo in
+// ogni anello per smorzare prima le alte frequenze. Lo stato delle otto linee
+// è un vettore: smorzamento, attenuazione e mixing lavorano su tutte le linee
+// con le stesse istruzioni SIMD.
+
+#ifndef FDN_REVERB_H
+#define FDN_REVERB_H
+
+#include "delay_line.h"
+#include <cstddef>
+
+class FdnReverb {
+public:
+    static constexpr size_t LINES = 8;
+    static constexpr size_t BATCH = 64;   // Campioni le cui uscite si leggono insieme
+
+    // reverb_time: secondi per scendere di 60 dB; damping in [0, 1): quota di
+    // alte frequenze tolta a ogni giro. Il canale varia le lunghezze delle
+    // linee, così le code dei canali non sono correlate tra loro.
+    void prepare(int sample_rate, float reverb_time, float damping, int channel);
+
+    // Elabora in place frames campioni consecutivi di un canale: a ogni
+    // campione si somma mix volte il segnale riverberato
+    void process(float* samples, size_t frames, float mix);
+
+private:
+    // Una posizione per tutte le linee: la scrittura è un solo store da 32 byte
+    struct alignas(32) Frame {
+        float line[LINES];
+    };
+
+    BasicDelayLine<Frame> lines_;
+    size_t length_[LINES] = {};
+    alignas(32) float gain_[LINES] = {};      // Attenuazione per giro di ogni linea
+    alignas(32) float lowpass_[LINES] = {};   // Stato dei passa-basso
+    float damping_ = 0.0f;
+};
+
+#endif // FDN_REVERB_H
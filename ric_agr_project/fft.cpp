@@ -0,0 +1,255 @@
+// FFT reale: una FFT complessa di metà punti sui campioni pari e dispari
+
+#include "fft.h"
+#include "dsp_kernels.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Otto farfalle (o bin) insieme; allineato a 32 byte anche senza -mavx,
+// perché la variante AVX2 lo carica come tale
+constexpr size_t FFT_LANES = 8;
+typedef float Lane __attribute__((vector_size(FFT_LANES * sizeof(float)), aligned(32)));
+typedef int32_t LaneIndex __attribute__((vector_size(FFT_LANES * sizeof(int32_t)), aligned(32)));
+
+__attribute__((always_inline)) inline void load(Lane& v, const float* p) {
+    std::memcpy(&v, p, sizeof(v));
+}
+
+__attribute__((always_inline)) inline void store(float* p, const Lane& v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// p[7], p[6], ..., p[0]: i bin M - k per otto k crescenti
+__attribute__((always_inline)) inline void load_reversed(Lane& v, const float* p) {
+    load(v, p);
+    v = __builtin_shuffle(v, LaneIndex{7, 6, 5, 4, 3, 2, 1, 0});
+}
+
+// Farfalla con il prodotto per il twiddle già fatto: a += v, b = a - v
+__attribute__((always_inline)) inline void butterfly(float* re, float* im, size_t a, size_t b, float vr, float vi) {
+    re[b] = re[a] - vr;
+    im[b] = im[a] - vi;
+    re[a] += vr;
+    im[a] += vi;
+}
+
+// FFT complessa su ingresso già in ordine bit-reversal. Gli stadi di
+// lunghezza 2, 4 e 8 sono un solo passo radix-8 (twiddle 1, -i e
+// (±1 - i) / sqrt(2), senza prodotti generici); gli altri lavorano su
+// FFT_LANES farfalle contigue
+__attribute__((always_inline)) inline void butterflies(float* re, float* im, size_t n,
+                                                       const float* twiddle_re, const float* twiddle_im) {
+    constexpr float C = 0.70710678f;
+    for (size_t i = 0; i < n; i += 8) {
+        float* r = re + i;
+        float* m = im + i;
+        for (size_t j = 0; j < 8; j += 2) butterfly(r, m, j, j + 1, r[j + 1], m[j + 1]);
+        for (size_t j = 0; j < 8; j += 4) {
+            butterfly(r, m, j, j + 2, r[j + 2], m[j + 2]);
+            butterfly(r, m, j + 1, j + 3, m[j + 3], -r[j + 3]);
+        }
+        butterfly(r, m, 0, 4, r[4], m[4]);
+        butterfly(r, m, 1, 5, C * (r[5] + m[5]), C * (m[5] - r[5]));
+        butterfly(r, m, 2, 6, m[6], -r[6]);
+        butterfly(r, m, 3, 7, C * (m[7] - r[7]), -C * (r[7] + m[7]));
+    }
+    for (size_t len = 16; len <= n; len <<= 1) {
+        size_t half = len / 2;
+        const float* wr = twiddle_re + half - 1;
+        const float* wi = twiddle_im + half - 1;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; j += FFT_LANES) {
+                Lane ar, ai, br, bi, cr, ci;
+                load(ar, re + i + j);
+                load(ai, im + i + j);
+                load(br, re + i + j + half);
+                load(bi, im + i + j + half);
+                load(cr, wr + j);
+                load(ci, wi + j);
+                Lane vr = br * cr - bi * ci;
+                Lane vi = br * ci + bi * cr;
+                store(re + i + j, ar + vr);
+                store(im + i + j, ai + vi);
+                store(re + i + j + half, ar - vr);
+                store(im + i + j + half, ai - vi);
+            }
+        }
+    }
+}
+
+// X[k] = E[k] + W^k O[k], con E e O gli spettri dei campioni pari e dispari:
+// E = (Z[k] + conj(Z[M-k])) / 2, O = (Z[k] - conj(Z[M-k])) / 2i.
+// Per k = 0 serve Z[M] = Z[0] in fondo a zr e zi
+__attribute__((always_inline)) inline void split_forward(const float* zr, const float* zi, size_t m,
+                                                         const float* wr, const float* wi, float* re, float* im) {
+    for (size_t k = 0; k < m; k += FFT_LANES) {
+        Lane ar, ai, br, bi, cr, ci;
+        load(ar, zr + k);
+        load(ai, zi + k);
+        load_reversed(br, zr + m - k - 7);
+        load_reversed(bi, zi + m - k - 7);
+        load(cr, wr + k);
+        load(ci, wi + k);
+        Lane er = 0.5f * (ar + br);
+        Lane ei = 0.5f * (ai - bi);
+        Lane or_ = 0.5f * (ai + bi);
+        Lane oi = -0.5f * (ar - br);
+        store(re + k, er + cr * or_ - ci * oi);
+        store(im + k, ei + cr * oi + ci * or_);
+    }
+}
+
+// Z[k] = E[k] + i O[k], con E = (X[k] + conj(X[M-k])) / 2 e
+// O = (X[k] - conj(X[M-k])) conj(W^k) / 2, coniugato (FFT inversa come
+// FFT diretta dei coniugati) e scalato
+__attribute__((always_inline)) inline void split_inverse(const float* re, const float* im, size_t m, float scale,
+                                                         const float* wr, const float* wi, float* zr, float* zi) {
+    for (size_t k = 0; k < m; k += FFT_LANES) {
+        Lane ar, ai, br, bi, cr, ci;
+        load(ar, re + k);
+        load(ai, im + k);
+        load_reversed(br, re + m - k - 7);
+        load_reversed(bi, im + m - k - 7);
+        load(cr, wr + k);
+        load(ci, wi + k);
+        Lane er = scale * (ar + br);
+        Lane ei = scale * (ai - bi);
+        Lane dr = scale * (ar - br);
+        Lane di = scale * (ai + bi);
+        Lane or_ = dr * cr + di * ci;
+        Lane oi = di * cr - dr * ci;
+        store(zr + k, er - oi);
+        store(zi + k, -(ei + or_));
+    }
+}
+
+void butterflies_generic(float* re, float* im, size_t n, const float* twiddle_re, const float* twiddle_im) {
+    butterflies(re, im, n, twiddle_re, twiddle_im);
+}
+void split_forward_generic(const float* zr, const float* zi, size_t m, const float* wr, const float* wi,
+                           float* re, float* im) {
+    split_forward(zr, zi, m, wr, wi, re, im);
+}
+void split_inverse_generic(const float* re, const float* im, size_t m, float scale, const float* wr,
+                           const float* wi, float* zr, float* zi) {
+    split_inverse(re, im, m, scale, wr, wi, zr, zi);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) void butterflies_avx2(float* re, float* im, size_t n,
+                                                      const float* twiddle_re, const float* twiddle_im) {
+    butterflies(re, im, n, twiddle_re, twiddle_im);
+}
+__attribute__((target("avx2"))) void split_forward_avx2(const float* zr, const float* zi, size_t m,
+                                                        const float* wr, const float* wi, float* re, float* im) {
+    split_forward(zr, zi, m, wr, wi, re, im);
+}
+__attribute__((target("avx2"))) void split_inverse_avx2(const float* re, const float* im, size_t m, float scale,
+                                                        const float* wr, const float* wi, float* zr, float* zi) {
+    split_inverse(re, im, m, scale, wr, wi, zr, zi);
+}
+#endif
+
+void run_butterflies(float* re, float* im, size_t n, const float* twiddle_re, const float* twiddle_im) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (dsp_kernels().isa >= DspIsa::AVX2) return butterflies_avx2(re, im, n, twiddle_re, twiddle_im);
+#endif
+    butterflies_generic(re, im, n, twiddle_re, twiddle_im);
+}
+
+void run_split_forward(const float* zr, const float* zi, size_t m, const float* wr, const float* wi,
+                       float* re, float* im) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (dsp_kernels().isa >= DspIsa::AVX2) return split_forward_avx2(zr, zi, m, wr, wi, re, im);
+#endif
+    split_forward_generic(zr, zi, m, wr, wi, re, im);
+}
+
+void run_split_inverse(const float* re, const float* im, size_t m, float scale, const float* wr,
+                       const float* wi, float* zr, float* zi) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (dsp_kernels().isa >= DspIsa::AVX2) return split_inverse_avx2(re, im, m, scale, wr, wi, zr, zi);
+#endif
+    split_inverse_generic(re, im, m, scale, wr, wi, zr, zi);
+}
+
+}  // namespace
+
+RealFft::RealFft(size_t size) : size_(size), half_(size / 2) {
+    if (size < 16 || (size & (size - 1)) != 0) {
+        throw std::runtime_error("FFT size must be a power of two >= 16: " + std::to_string(size));
+    }
+    // Permutazione bit-reversal su half_ punti
+    size_t bits = 0;
+    while ((size_t(1) << bits) < half_) ++bits;
+    reverse_.resize(half_);
+    for (size_t i = 0; i < half_; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+        reverse_[i] = r;
+    }
+    // Twiddle dello stadio di lunghezza len: exp(-2 pi i j / len), j < len / 2
+    twiddle_re_.resize(half_);
+    twiddle_im_.resize(half_);
+    for (size_t len = 2; len <= half_; len <<= 1) {
+        for (size_t j = 0; j < len / 2; ++j) {
+            double angle = -2.0 * M_PI * j / len;
+            twiddle_re_[len / 2 - 1 + j] = static_cast<float>(std::cos(angle));
+            twiddle_im_[len / 2 - 1 + j] = static_cast<float>(std::sin(angle));
+        }
+    }
+    split_re_.resize(half_);
+    split_im_.resize(half_);
+    for (size_t k = 0; k < half_; ++k) {
+        double angle = -2.0 * M_PI * k / size_;
+        split_re_[k] = static_cast<float>(std::cos(angle));
+        split_im_[k] = static_cast<float>(std::sin(angle));
+    }
+    // Un punto in più: Z[M] = Z[0] per la separazione di forward
+    work_re_.resize(half_ + 1);
+    work_im_.resize(half_ + 1);
+    unpacked_re_.resize(half_);
+    unpacked_im_.resize(half_);
+}
+
+void RealFft::forward(const float* in, float* re, float* im) {
+    // z[k] = x[2k] + i x[2k+1], già in ordine bit-reversal
+    float* zr = work_re_.data();
+    float* zi = work_im_.data();
+    for (size_t j = 0; j < half_; ++j) {
+        size_t k = reverse_[j];
+        zr[j] = in[2 * k];
+        zi[j] = in[2 * k + 1];
+    }
+    run_butterflies(zr, zi, half_, twiddle_re_.data(), twiddle_im_.data());
+
+    zr[half_] = zr[0];
+    zi[half_] = zi[0];
+    run_split_forward(zr, zi, half_, split_re_.data(), split_im_.data(), re, im);
+    re[half_] = zr[0] - zi[0];
+    im[half_] = 0.0f;
+}
+
+void RealFft::inverse(const float* re, const float* im, float* out) {
+    // La scala 1 / M dell'inversa entra nella separazione
+    float* ur = unpacked_re_.data();
+    float* ui = unpacked_im_.data();
+    run_split_inverse(re, im, half_, 0.5f / half_, split_re_.data(), split_im_.data(), ur, ui);
+
+    float* zr = work_re_.data();
+    float* zi = work_im_.data();
+    for (size_t j = 0; j < half_; ++j) {
+        zr[j] = ur[reverse_[j]];
+        zi[j] = ui[reverse_[j]];
+    }
+    run_butterflies(zr, zi, half_, twiddle_re_.data(), twiddle_im_.data());
+    for (size_t k = 0; k < half_; ++k) {
+        out[2 * k] = zr[k];
+        out[2 * k + 1] = -zi[k];
+    }
+}
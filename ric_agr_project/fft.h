@@ -0,0 +1,39 @@
+// FFT reale radix-2 per dimensioni potenza di due, senza dipendenze esterne.
+// Gli spettri sono in formato separato (parte reale e immaginaria in due
+// array): i loop sui bin e le farfalle vettorizzano senza rimescolare.
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <cstddef>
+#include <vector>
+
+class RealFft {
+public:
+    // size potenza di due, almeno 16; eccezione altrimenti
+    explicit RealFft(size_t size);
+
+    size_t size() const { return size_; }
+    size_t bins() const { return size_ / 2 + 1; }
+
+    // size campioni reali -> bins() bin complessi in re/im
+    void forward(const float* in, float* re, float* im);
+
+    // Inversa esatta di forward: bins() bin -> size campioni (già scalati)
+    void inverse(const float* re, const float* im, float* out);
+
+private:
+    size_t size_;
+    size_t half_;                         // Punti della FFT complessa interna
+    std::vector<size_t> reverse_;         // Indice bit-reversal di ogni punto della FFT interna
+    std::vector<float> twiddle_re_;       // Per stadio, contigui: stadio di lunghezza len da len/2 - 1
+    std::vector<float> twiddle_im_;
+    std::vector<float> split_re_;         // Fattori W^k che separano pari e dispari
+    std::vector<float> split_im_;
+    std::vector<float> work_re_;          // Scratch della FFT interna (half_ + 1 punti)
+    std::vector<float> work_im_;
+    std::vector<float> unpacked_re_;      // Scratch dell'inversa prima della permutazione
+    std::vector<float> unpacked_im_;
+};
+
+#endif // FFT_H
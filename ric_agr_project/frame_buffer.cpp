@@ -0,0 +1,67 @@
+// Buffer di ricezione compattante per lo split dello stream TCP in frame
+
+#include "frame_buffer.h"
+#include <cstring>
+
+// Lo spazio copre un frame massimo più un blocco di recv
+FrameBuffer::FrameBuffer(WireFormat format, size_t max_frame)
+    : format_(format), max_frame_(max_frame), storage_(max_frame + 4096) {}
+
+// Restituisce la zona libera; se è poca, sposta in testa i dati non consumati
+char* FrameBuffer::write_ptr() {
+    if (read_pos_ > 0 && storage_.size() - write_pos_ < 4096) {
+        size_t pending = write_pos_ - read_pos_;
+        std::memmove(storage_.data(), storage_.data() + read_pos_, pending);
+        scan_pos_ = scan_pos_ > read_pos_ ? scan_pos_ - read_pos_ : 0;
+        write_pos_ = pending;
+        read_pos_ = 0;
+    }
+    return storage_.data() + write_pos_;
+}
+
+size_t FrameBuffer::writable() const {
+    return storage_.size() - write_pos_;
+}
+
+void FrameBuffer::commit(size_t n) {
+    write_pos_ += n;
+}
+
+// Cerca il prossimo frame completo nei dati ricevuti
+bool FrameBuffer::next_frame(std::string_view& frame) {
+    if (error_) return false;
+    const char* base = storage_.data();
+    size_t available = write_pos_ - read_pos_;
+
+    if (format_ == WireFormat::TEXT) {
+        // Scansione incrementale: ogni byte viene esaminato una sola volta
+        if (scan_pos_ < read_pos_) scan_pos_ = read_pos_;
+        const void* nl = std::memchr(base + scan_pos_, '\n', write_pos_ - scan_pos_);
+        if (!nl) {
+            scan_pos_ = write_pos_;
+            if (available > max_frame_) error_ = true;   // Riga troppo lunga
+            return false;
+        }
+        size_t end = static_cast<const char*>(nl) - base;
+        frame = std::string_view(base + read_pos_, end - read_pos_);
+        read_pos_ = end + 1;
+        scan_pos_ = read_pos_;
+    } else {
+        // Frame binari: la lunghezza è nel prefisso
+        if (available < WIRE_HEADER_SIZE) return false;
+        size_t frame_len = peek_frame_length(base + read_pos_, available);
+        if (frame_len < WIRE_HEADER_SIZE || frame_len > max_frame_) {
+            error_ = true;                               // Stream corrotto
+            return false;
+        }
+        if (available < frame_len) return false;         // Frame incompleto
+        frame = std::string_view(base + read_pos_, frame_len);
+        read_pos_ += frame_len;
+    }
+
+    // Buffer svuotato: si riparte dall'inizio senza memmove
+    if (read_pos_ == write_pos_) {
+        read_pos_ = write_pos_ = scan_pos_ = 0;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+// Buffer di ricezione riutilizzabile per una connessione: i dati letti dal socket
+// vengono suddivisi in frame restituiti come std::string_view, senza copie né
+// allocazioni per messaggio
+
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "message_structs.h"
+
+class FrameBuffer {
+public:
+    // Dimensione massima di default di un frame
+    static constexpr size_t DEFAULT_MAX_FRAME = 64 * 1024;
+
+    explicit FrameBuffer(WireFormat format, size_t max_frame = DEFAULT_MAX_FRAME);
+
+    // Zona libera in cui scrivere con recv(); compatta il buffer se serve.
+    // Invalida le view restituite in precedenza da next_frame().
+    char* write_ptr();
+
+    // Byte scrivibili a partire da write_ptr() (da chiamare dopo write_ptr())
+    size_t writable() const;
+
+    // Registra n byte appena scritti in write_ptr()
+    void commit(size_t n);
+
+    // Estrae il prossimo frame completo (senza il '\n' finale nel formato testo).
+    // La view resta valida fino alla successiva chiamata a write_ptr().
+    bool next_frame(std::string_view& frame);
+
+    // true se lo stream ha superato la dimensione massima o è corrotto
+    bool error() const { return error_; }
+
+private:
+    WireFormat format_;
+    size_t max_frame_;
+    std::vector<char> storage_;   // Allocato una volta, riusato per tutta la connessione
+    size_t read_pos_ = 0;         // Inizio dei dati non ancora consumati
+    size_t write_pos_ = 0;        // Fine dei dati ricevuti
+    size_t scan_pos_ = 0;         // Fin dove si è già cercato il '\n' (formato testo)
+    bool error_ = false;
+};
+
+#endif // FRAME_BUFFER_H
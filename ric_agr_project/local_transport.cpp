@@ -0,0 +1,108 @@
+// Trasporto in-process basato su inbox MPSC lock-free
+
+#include "local_transport.h"
+#include <iostream>
+#include <mutex>
+
+// Inbox del nodo nel registro, creata al primo uso
+std::shared_ptr<LocalInbox> LocalRegistry::inbox_for(int node_id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto& inbox = inboxes_[node_id];
+    if (!inbox) inbox = std::make_shared<LocalInbox>();
+    return inbox;
+}
+
+LocalTransport::LocalTransport(int self_id, LocalRegistry& registry)
+    : self_id_(self_id), registry_(registry), inbox_(registry.inbox_for(self_id)) {}
+
+// Distruttore: risveglia e ferma il dispatcher
+LocalTransport::~LocalTransport() {
+    stopping_.store(true);
+    inbox_->ready.notify_all();
+    if (dispatcher_.joinable()) dispatcher_.join();
+}
+
+// Aggancia l'inbox del peer una volta sola
+void LocalTransport::add_peer(int id) {
+    peers_.emplace(id, registry_.inbox_for(id));
+}
+
+// Imposta la callback invocata per ogni messaggio ricevuto
+void LocalTransport::set_message_callback(std::function<void(const Message&)> cb) {
+    msg_cb_ = std::move(cb);
+}
+
+// Avvia il dispatcher della propria inbox
+void LocalTransport::start() {
+    if (!dispatcher_.joinable()) {
+        dispatcher_ = std::thread(&LocalTransport::dispatch_loop, this);
+    }
+}
+
+// Inbox piena: il mittente si sospende su space (notificato dal dispatcher a
+// ogni pop) invece di girare a vuoto. Il limite evita che due dispatcher che
+// si scrivono a vicenda con le inbox piene restino bloccati per sempre.
+bool LocalTransport::push_blocking(LocalInbox& inbox, const Message& message) {
+    auto give_up_at = std::chrono::steady_clock::now() + FULL_INBOX_TIMEOUT;
+    while (!inbox.queue.try_push(message)) {
+        uint32_t key = inbox.space.prepare_wait();
+        if (inbox.queue.try_push(message)) {
+            inbox.space.cancel_wait();
+            return true;
+        }
+        if (!inbox.space.wait(key, give_up_at)) return false;
+    }
+    return true;
+}
+
+// Invio: push lock-free nella inbox del destinatario; la notifica fa una
+// syscall solo se il dispatcher del destinatario è sospeso
+void LocalTransport::send(int target_id, const Message& message,
+                          std::shared_ptr<SendCompletion> completion) {
+    auto it = peers_.find(target_id);
+    if (it == peers_.end()) {
+        std::cerr << "LocalTransport: peer " << target_id << " not found\n";
+        if (completion) completion->complete(false);
+        return;
+    }
+
+    LocalInbox& inbox = *it->second;
+    if (!inbox.queue.try_push(message) && !push_blocking(inbox, message)) {
+        std::cerr << "LocalTransport: inbox of peer " << target_id << " full, dropping message\n";
+        if (completion) completion->complete(false);
+        return;
+    }
+
+    inbox.ready.notify_all();
+    if (completion) completion->complete(true);
+}
+
+// Dispatcher: consuma la inbox; quando è vuota gira brevemente e poi si sospende
+void LocalTransport::dispatch_loop() {
+    constexpr int SPIN_ROUNDS = 64;
+    Message msg;
+
+    while (!stopping_.load()) {
+        if (inbox_->queue.try_pop(msg)) {
+            inbox_->space.notify_all();      // Syscall solo se un mittente attende
+            if (msg_cb_) msg_cb_(msg);
+            continue;
+        }
+
+        bool found = false;
+        for (int i = 0; i < SPIN_ROUNDS && !found; ++i) {
+            std::this_thread::yield();
+            found = !inbox_->queue.empty();
+        }
+        if (found) continue;
+
+        // Ci si registra prima di ricontrollare la coda: un push successivo
+        // cambia la chiave e risveglia il dispatcher, senza timeout di ripiego
+        uint32_t key = inbox_->ready.prepare_wait();
+        if (!inbox_->queue.empty() || stopping_.load()) {
+            inbox_->ready.cancel_wait();
+        } else {
+            inbox_->ready.wait(key, std::chrono::steady_clock::time_point::max());
+        }
+    }
+}
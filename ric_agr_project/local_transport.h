@@ -0,0 +1,87 @@
+// Trasporto in-process per i nodi che condividono lo stesso processo:
+// ogni nodo ha una inbox (coda MPSC lock-free) e i messaggi viaggiano come
+// struct Message, senza syscall né serializzazione. Le inbox di un cluster
+// stanno in un LocalRegistry (di solito quello della PeerDirectory): più
+// cluster nello stesso processo non si vedono tra loro.
+
+#ifndef LOCAL_TRANSPORT_H
+#define LOCAL_TRANSPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "event_count.h"
+#include "mpsc_queue.h"
+#include "transport.h"
+
+// Inbox di un nodo: più nodi produttori, un solo dispatcher consumatore
+struct LocalInbox {
+    static constexpr size_t CAPACITY = 4096;
+
+    LocalInbox() : queue(CAPACITY) {}
+
+    MpscQueue<Message> queue;
+    EventCount ready;                    // Notificato a ogni push e all'arresto
+    EventCount space;                    // Notificato a ogni pop (mittenti con inbox piena)
+};
+
+// Registro delle inbox dei nodi di un cluster, per node id. Il lock serve
+// solo in fase di configurazione, mai durante gli invii.
+class LocalRegistry {
+public:
+    // Restituisce l'inbox del nodo, creandola se non esiste ancora
+    // (i mittenti possono arrivare prima che il destinatario sia avviato)
+    std::shared_ptr<LocalInbox> inbox_for(int node_id);
+
+private:
+    std::mutex mtx_;
+    std::unordered_map<int, std::shared_ptr<LocalInbox>> inboxes_;
+};
+
+class LocalTransport : public Transport {
+public:
+    // Attesa massima di un mittente davanti a una inbox piena; poi il
+    // messaggio viene scartato con complete(false)
+    static constexpr std::chrono::milliseconds FULL_INBOX_TIMEOUT{100};
+
+    // L'inbox del nodo e quelle dei peer vengono prese da registry
+    LocalTransport(int self_id, LocalRegistry& registry);
+
+    // Ferma il dispatcher della propria inbox
+    ~LocalTransport() override;
+
+    // Registra un peer che vive nello stesso processo
+    void add_peer(int id);
+
+    // Deposita il messaggio nella inbox del peer (lock-free); se è piena
+    // attende al più FULL_INBOX_TIMEOUT che il dispatcher la svuoti
+    void send(int target_id, const Message& message,
+              std::shared_ptr<SendCompletion> completion) override;
+
+    // Imposta la callback invocata per ogni messaggio della propria inbox
+    void set_message_callback(std::function<void(const Message&)> cb);
+
+    // Avvia il thread che consegna i messaggi della propria inbox
+    void start();
+
+private:
+    // Attende spazio nella inbox piena fino al limite; false se scaduto
+    static bool push_blocking(LocalInbox& inbox, const Message& message);
+
+    // Loop del dispatcher: svuota la inbox e invoca la callback
+    void dispatch_loop();
+
+    int self_id_;
+    LocalRegistry& registry_;
+    std::shared_ptr<LocalInbox> inbox_;                              // Inbox di questo nodo
+    std::unordered_map<int, std::shared_ptr<LocalInbox>> peers_;     // Inbox dei peer locali
+    std::function<void(const Message&)> msg_cb_;
+    std::atomic<bool> stopping_{false};
+    std::thread dispatcher_;
+};
+
+#endif // LOCAL_TRANSPORT_H
@@ -15,9 +15,9 @@ void Logger::initialize_log(const std::string& file_path) {
 }
 
 // Logga l'invio di una richiesta
-void Logger::log_request(int node_id, int clock) {
+void Logger::log_request(int node_id, int clock, int resource_id) {
     if (log_file.is_open()) {
-        log_file << "[LOG] Node " << node_id << " sending REQUEST with clock " << clock << std::endl;
+        log_file << "[LOG] Node " << node_id << " sending REQUEST for track " << resource_id << " with clock " << clock << std::endl;
     }
 }
 
@@ -29,16 +29,48 @@ void Logger::log_ack_received(int node_id) {
 }
 
 // Logga quando un nodo entra nella sezione critica
-void Logger::log_critical_section_entry(int node_id) {
+void Logger::log_critical_section_entry(int node_id, int resource_id) {
     if (log_file.is_open()) {
-        log_file << "[LOG] Node " << node_id << " entering critical section" << std::endl;
+        log_file << "[LOG] Node " << node_id << " entering critical section of track " << resource_id << std::endl;
     }
 }
 
 // Logga quando un nodo esce dalla sezione critica
-void Logger::log_critical_section_exit(int node_id) {
+void Logger::log_critical_section_exit(int node_id, int resource_id) {
     if (log_file.is_open()) {
-        log_file << "[LOG] Node " << node_id << " exiting critical section" << std::endl;
+        log_file << "[LOG] Node " << node_id << " exiting critical section of track " << resource_id << std::endl;
+    }
+}
+
+// Logga il riepilogo dei messaggi inviati da un nodo
+void Logger::log_message_stats(int node_id, long entries, long messages, long free_entries) {
+    if (log_file.is_open()) {
+        log_file << "[LOG] Node " << node_id << " stats: " << entries << " CS entries, "
+                 << messages << " messages sent, " << free_entries << " entries without messages" << std::endl;
+    }
+}
+
+// Logga un ingresso in sezione critica avvenuto dopo la deadline
+void Logger::log_deadline_miss(int node_id, int resource_id, int late_ms) {
+    if (log_file.is_open()) {
+        log_file << "[LOG] Node " << node_id << " missed deadline on track " << resource_id
+                 << " by " << late_ms << " ms" << std::endl;
+    }
+}
+
+// Logga il riepilogo delle deadline di un nodo
+void Logger::log_deadline_stats(int node_id, long entries, long misses, int p99_lateness_ms) {
+    if (log_file.is_open()) {
+        log_file << "[LOG] Node " << node_id << " deadline stats: " << misses << "/" << entries
+                 << " missed, p99 lateness " << p99_lateness_ms << " ms" << std::endl;
+    }
+}
+
+// Logga i contatori della cache di sintesi
+void Logger::log_cache_stats(long hits, long disk_hits, long misses, long coalesced) {
+    if (log_file.is_open()) {
+        log_file << "[LOG] Synthesis cache: " << hits << " memory hits, " << disk_hits << " disk hits, "
+                 << misses << " misses, " << coalesced << " coalesced" << std::endl;
     }
 }
 
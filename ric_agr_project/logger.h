@@ -12,10 +12,14 @@ public:
     static void initialize_log(const std::string& file_path);
 
     // Funzioni per loggare eventi specifici
-    static void log_request(int node_id, int clock);
+    static void log_request(int node_id, int clock, int resource_id);
     static void log_ack_received(int node_id);
-    static void log_critical_section_entry(int node_id);
-    static void log_critical_section_exit(int node_id);
+    static void log_critical_section_entry(int node_id, int resource_id);
+    static void log_critical_section_exit(int node_id, int resource_id);
+    static void log_message_stats(int node_id, long entries, long messages, long free_entries);
+    static void log_deadline_miss(int node_id, int resource_id, int late_ms);
+    static void log_deadline_stats(int node_id, long entries, long misses, int p99_lateness_ms);
+    static void log_cache_stats(long hits, long disk_hits, long misses, long coalesced);
 
     // Funzione per chiudere il file di log
     static void close_log();
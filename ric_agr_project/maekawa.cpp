@@ -0,0 +1,254 @@
+#include "maekawa.h"
+#include "logger.h"
+#include "network.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+Maekawa::Maekawa(const ProtocolContext& ctx)
+    : ctx_(ctx), quorum_(grid_quorum(ctx.id, ctx.num_nodes)),
+      granted_(ctx.num_nodes, false), failed_(ctx.num_nodes, false), suspected_(ctx.num_nodes, false) {}
+
+std::vector<int> Maekawa::grid_quorum(int id, int num_nodes) {
+    int k = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(num_nodes))));
+    int row = id / k, col = id % k;
+
+    // Con l'ultima riga incompleta due quorum si intersecano comunque: se la cella
+    // (riga di a, colonna di b) manca, esiste la cella (riga di b, colonna di a)
+    std::vector<int> quorum;
+    for (int i = 0; i < num_nodes; ++i) {
+        if (i / k == row || i % k == col) quorum.push_back(i);
+    }
+    return quorum;
+}
+
+Message Maekawa::make(MessageType type) const {
+    return Message(type, ctx_.id, ctx_.clock->now(), 0, ctx_.resource_id);
+}
+
+bool Maekawa::acquire(int deadline_ms, LockMode /*mode*/, std::chrono::steady_clock::time_point give_up_at) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    my_request_ts_ = ctx_.clock->tick();
+    requesting_ = true;
+    std::fill(granted_.begin(), granted_.end(), false);
+    std::fill(failed_.begin(), failed_.end(), false);
+    pending_inquiries_.clear();
+
+    Logger::log_request(ctx_.id, my_request_ts_, ctx_.resource_id);
+
+    Outbox out;
+    Message request(MessageType::REQUEST, ctx_.id, my_request_ts_, deadline_ms, ctx_.resource_id);
+    for (int arbiter : quorum_) out.emplace_back(arbiter, request);
+    flush(out);
+
+    // Aspetta il voto di tutto il quorum (o il timeout)
+    if (!wait_or_give_up(cv_, lock, give_up_at, [this] { return holds_quorum(); })) {
+        // Richiesta ritirata: il RELEASE libera i voti concessi e svuota le code degli arbitri
+        // (la outbox contiene ancora le REQUEST già inviate)
+        out.clear();
+        send_release(out);
+        flush(out);
+        return false;
+    }
+    in_cs_ = true;
+    // Le INQUIRE rimaste in sospeso avranno risposta con il RELEASE
+    pending_inquiries_.clear();
+    return true;
+}
+
+void Maekawa::release() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Outbox out;
+    send_release(out);
+    flush(out);
+}
+
+void Maekawa::send_release(Outbox& out) {
+    requesting_ = false;
+    in_cs_ = false;
+    std::fill(granted_.begin(), granted_.end(), false);
+    pending_inquiries_.clear();
+    ctx_.clock->tick();
+
+    std::cout << "[Node " << ctx_.id << "] Sending RELEASE to quorum of " << quorum_.size() << std::endl;
+
+    Message release_message = make(MessageType::RELEASE);
+    for (int arbiter : quorum_) out.emplace_back(arbiter, release_message);
+}
+
+void Maekawa::on_message(const Message& message) {
+    ctx_.clock->update(message.logical_clock);
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    Outbox out;
+    process(message, out);
+    flush(out);
+}
+
+void Maekawa::process(const Message& message, Outbox& out) {
+    int sender = message.sender_id;
+    Request request(message.logical_clock, sender);
+
+    switch (message.type) {
+    // --- Ruolo di arbitro ---
+    case MessageType::REQUEST:
+        if (!locked_) {
+            waiting_.insert(request);
+            grant_next(out);
+            break;
+        }
+        {
+            Request previous_head = waiting_.empty() ? Request(0, -1) : *waiting_.begin();
+            waiting_.insert(request);
+            if (request == *waiting_.begin() && request < holder_) {
+                // La nuova richiesta precede il detentore: gli si chiede di cedere il voto.
+                // La vecchia testa della coda, se lo precedeva, ora è scavalcata.
+                if (previous_head.second >= 0 && previous_head < holder_) {
+                    out.emplace_back(previous_head.second, make(MessageType::FAILED));
+                }
+                if (!inquired_) {
+                    inquired_ = true;
+                    out.emplace_back(holder_.second, make(MessageType::INQUIRE));
+                }
+            } else {
+                out.emplace_back(sender, make(MessageType::FAILED));
+            }
+        }
+        break;
+
+    case MessageType::RELEASE:
+        // Una richiesta ritirata per timeout può essere ancora in coda: la si scarta
+        for (auto it = waiting_.begin(); it != waiting_.end();) {
+            it = it->second == sender ? waiting_.erase(it) : std::next(it);
+        }
+        if (locked_ && holder_.second == sender) {
+            locked_ = false;
+            grant_next(out);
+        }
+        break;
+
+    case MessageType::YIELD:
+        if (locked_ && holder_.second == sender) {
+            // Il detentore torna in coda e il voto passa alla richiesta più vecchia
+            waiting_.insert(holder_);
+            locked_ = false;
+            grant_next(out);
+        }
+        break;
+
+    // --- Ruolo di richiedente (ACK vale come LOCKED) ---
+    case MessageType::ACK:
+        // Il voto vale solo per la richiesta corrente
+        if (!requesting_ || message.request_ts != my_request_ts_) break;
+        granted_[sender] = true;
+        failed_[sender] = false;
+        Logger::log_ack_received(ctx_.id);
+        if (holds_quorum()) cv_.notify_all();
+        break;
+
+    case MessageType::INQUIRE:
+        // INQUIRE obsoleta (voto già restituito o sezione critica in corso): il RELEASE risponderà
+        if (!requesting_ || in_cs_ || !granted_[sender]) break;
+        if (cannot_succeed()) {
+            yield_to(sender, out);
+        } else {
+            pending_inquiries_.push_back(sender);
+        }
+        break;
+
+    case MessageType::FAILED:
+        if (!requesting_) break;
+        failed_[sender] = true;
+        for (int arbiter : pending_inquiries_) {
+            if (granted_[arbiter]) yield_to(arbiter, out);
+        }
+        pending_inquiries_.clear();
+        break;
+
+    case MessageType::TOKEN:
+    case MessageType::HEARTBEAT:
+        // Non appartengono a questo protocollo
+        break;
+    }
+}
+
+void Maekawa::grant_next(Outbox& out) {
+    if (waiting_.empty()) return;
+    holder_ = *waiting_.begin();
+    waiting_.erase(waiting_.begin());
+    locked_ = true;
+    inquired_ = false;
+    Message ack = make(MessageType::ACK);
+    ack.request_ts = holder_.first;
+    out.emplace_back(holder_.second, ack);
+}
+
+void Maekawa::yield_to(int arbiter, Outbox& out) {
+    granted_[arbiter] = false;
+    failed_[arbiter] = true;
+    out.emplace_back(arbiter, make(MessageType::YIELD));
+}
+
+bool Maekawa::cannot_succeed() const {
+    for (int arbiter : quorum_) {
+        if (failed_[arbiter] && !granted_[arbiter] && !suspected_[arbiter]) return true;
+    }
+    return false;
+}
+
+bool Maekawa::holds_quorum() const {
+    for (int arbiter : quorum_) {
+        if (!granted_[arbiter] && !suspected_[arbiter]) return false;
+    }
+    return true;
+}
+
+void Maekawa::flush(Outbox& out) {
+    // I messaggi verso se stessi possono generarne altri: si elaborano finché la coda non si svuota
+    for (size_t i = 0; i < out.size(); ++i) {
+        auto [target, message] = out[i];
+        if (target == ctx_.id) {
+            process(message, out);
+            continue;
+        }
+        ctx_.network->send_message(target, message);
+        switch (message.type) {
+        case MessageType::REQUEST: ctx_.stats->requests.fetch_add(1); break;
+        case MessageType::ACK:     ctx_.stats->acks.fetch_add(1); break;
+        case MessageType::RELEASE: ctx_.stats->releases.fetch_add(1); break;
+        default:                   ctx_.stats->control.fetch_add(1); break;
+        }
+    }
+}
+
+void Maekawa::on_peer_down(int peer) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    suspected_[peer] = true;
+
+    // Ruolo di arbitro: le richieste del peer guasto non vanno servite
+    Outbox out;
+    for (auto it = waiting_.begin(); it != waiting_.end();) {
+        it = it->second == peer ? waiting_.erase(it) : std::next(it);
+    }
+    if (locked_ && holder_.second == peer) {
+        locked_ = false;
+        grant_next(out);
+    }
+    flush(out);
+
+    // Ruolo di richiedente: il quorum richiesto si è ridotto
+    cv_.notify_all();
+}
+
+void Maekawa::on_peer_up(int peer) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    suspected_[peer] = false;
+
+    // La nostra REQUEST può essere andata persa mentre l'arbitro era sospettato
+    if (requesting_ && !in_cs_ && !granted_[peer] &&
+        std::find(quorum_.begin(), quorum_.end(), peer) != quorum_.end()) {
+        Outbox out;
+        out.emplace_back(peer, Message(MessageType::REQUEST, ctx_.id, my_request_ts_, 0, ctx_.resource_id));
+        flush(out);
+    }
+}
@@ -0,0 +1,77 @@
+// Algoritmo di Maekawa su quorum a griglia: ogni nodo chiede il permesso solo
+// alla propria riga e colonna (O(sqrt N) messaggi per ingresso). Lo stallo tra
+// richieste concorrenti è risolto con i messaggi INQUIRE / YIELD / FAILED.
+
+#ifndef MAEKAWA_H
+#define MAEKAWA_H
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+#include "mutex_protocol.h"
+
+class Maekawa : public MutexProtocol {
+public:
+    explicit Maekawa(const ProtocolContext& ctx);
+
+    bool acquire(int deadline_ms, LockMode mode, std::chrono::steady_clock::time_point give_up_at) override;
+    void release() override;
+    void on_message(const Message& message) override;
+    void on_peer_down(int peer) override;
+    void on_peer_up(int peer) override;
+    const char* name() const override { return "maekawa"; }
+
+    // Quorum a griglia del nodo id: riga e colonna in una griglia ceil(sqrt N) x ceil(sqrt N)
+    static std::vector<int> grid_quorum(int id, int num_nodes);
+
+private:
+    using Request = std::pair<int, int>;  // (timestamp, id): ordinamento totale delle richieste
+    using Outbox = std::vector<std::pair<int, Message>>;
+
+    // Elabora un messaggio con mtx_ acquisito; i messaggi prodotti finiscono in out
+    void process(const Message& message, Outbox& out);
+
+    // Ruolo di arbitro: concede il proprio voto alla richiesta in testa alla coda
+    void grant_next(Outbox& out);
+
+    // Ruolo di richiedente: restituisce all'arbitro il voto concesso
+    void yield_to(int arbiter, Outbox& out);
+
+    // true se la richiesta corrente è stata scavalcata da almeno un arbitro
+    bool cannot_succeed() const;
+
+    bool holds_quorum() const;
+
+    // Restituisce i voti del quorum e toglie dalle code degli arbitri la richiesta corrente
+    void send_release(Outbox& out);
+
+    // Consegna i messaggi diretti a se stessi e invia gli altri (con mtx_ acquisito,
+    // così l'ordine FIFO per destinatario è preservato tra thread diversi)
+    void flush(Outbox& out);
+
+    Message make(MessageType type) const;
+
+    ProtocolContext ctx_;
+    std::vector<int> quorum_;          // Arbitri di questo nodo (incluso se stesso)
+    std::mutex mtx_;                   // Protegge tutto lo stato sottostante
+    std::condition_variable cv_;
+
+    // Stato da richiedente
+    bool requesting_ = false;
+    bool in_cs_ = false;
+    int my_request_ts_ = 0;
+    std::vector<bool> granted_;        // Voto ricevuto da ciascun arbitro
+    std::vector<bool> failed_;         // Arbitri che hanno preferito un'altra richiesta
+    std::vector<bool> suspected_;      // Arbitri sospettati guasti: il loro voto non si attende
+    std::vector<int> pending_inquiries_;
+
+    // Stato da arbitro
+    bool locked_ = false;              // Voto concesso a holder_
+    Request holder_{0, -1};
+    bool inquired_ = false;            // INQUIRE già inviato a holder_
+    std::set<Request> waiting_;        // Richieste in attesa del voto
+};
+
+#endif // MAEKAWA_H
@@ -1,6 +1,8 @@
 #include "node.h"               
 #include "logger.h"             
 #include "network.h"            
+#include "peer_directory.h"     
+#include "audio_manager.h"
 #include <thread>               // Per la gestione dei thread
 #include <vector>               // Per l'uso del contenitore std::vector
 #include <fstream>              // Per la lettura/scrittura su file
@@ -37,6 +39,83 @@ int main() {
         return 1;
     }
 
+    // Directory dei peer: analizzata una sola volta e condivisa da tutti i nodi
+    std::shared_ptr<const PeerDirectory> directory;
+    try {
+        directory = PeerDirectory::from_json(config_json);
+    } catch (const std::exception& e) {
+        std::cerr << "Errore: configurazione dei nodi non valida: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Opzioni del protocollo di mutua esclusione
+    NodeOptions options;
+    options.protocol = config_json.value("protocol", std::string("ricart_agrawala"));
+    options.permission_reuse = config_json.value("permission_reuse", false);
+    options.num_tracks = config_json.value("num_tracks", 1);
+    options.priority = config_json.value("priority", std::string("lamport"));
+    options.deadline_ms = config_json.value("deadline_ms", 0);
+    options.read_ratio = config_json.value("read_ratio", 0.0);
+    options.heartbeat_ms = config_json.value("heartbeat_ms", 0);
+    options.suspect_timeout_ms = config_json.value("suspect_timeout_ms", 3000);
+    options.acquire_timeout_ms = config_json.value("acquire_timeout_ms", 0);
+    if (config_json.contains("fault_injection")) {
+        const auto& fault = config_json["fault_injection"];
+        options.crash_node = fault.value("node", -1);
+        options.crash_after_entries = fault.value("after_entries", 0);
+        options.crash_while_holding = fault.value("while_holding", false);
+    }
+    if (options.priority != "lamport" && options.priority != "edf") {
+        std::cerr << "Errore: priority deve essere \"lamport\" o \"edf\"\n";
+        return 1;
+    }
+    if (options.num_tracks < 1 || options.num_tracks > 65536) {
+        std::cerr << "Errore: num_tracks deve essere compreso tra 1 e 65536\n";
+        return 1;
+    }
+
+    // Sintetizzatori persistenti condivisi dai nodi: il modello si carica una volta sola
+    int tts_workers = config_json.value("tts_workers", 1);
+    if (tts_workers < 1) {
+        std::cerr << "Errore: tts_workers deve essere almeno 1\n";
+        return 1;
+    }
+    AudioManager::startSynthesizer(tts_workers);
+
+    // Thread che elaborano in parallelo i canali degli effetti (0 = uno per core)
+    int audio_threads = config_json.value("audio_threads", 0);
+    if (audio_threads < 0) {
+        std::cerr << "Errore: audio_threads non può essere negativo\n";
+        return 1;
+    }
+    AudioManager::startAudioThreads(audio_threads);
+
+    // Catena di effetti applicata a ogni frase: [{"type": "compressor", "ratio": 4}, ...]
+    if (config_json.contains("audio_effects")) {
+        std::vector<EffectSpec> effects;
+        for (const auto& effect_json : config_json["audio_effects"]) {
+            EffectSpec spec;
+            spec.type = effect_json.value("type", std::string());
+            for (const auto& [key, value] : effect_json.items()) {
+                if (value.is_number()) spec.params[key] = value.get<float>();
+            }
+            effects.push_back(spec);
+        }
+        try {
+            AudioManager::configureEffects(effects);
+        } catch (const std::exception& e) {
+            std::cerr << "Errore: audio_effects non valido: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Cache delle frasi sintetizzate: LRU in memoria e blob su disco
+    int cache_mb = config_json.value("synthesis_cache_mb", 64);
+    if (cache_mb > 0) {
+        AudioManager::startSynthesisCache(static_cast<size_t>(cache_mb) << 20,
+                                          config_json.value("synthesis_cache_dir", std::string("output_audio/cache")));
+    }
+
     std::vector<std::unique_ptr<Node>> nodes;  // Contenitore per tutti i nodi creati
     std::vector<std::thread> threads;          // Contenitore per tutti i thread associati ai nodi
 
@@ -47,7 +126,7 @@ int main() {
         int port = node_json["port"];         
 
         // Creazione dinamica di un oggetto Node
-        auto node = std::make_unique<Node>(id, host, port, num_nodes);
+        auto node = std::make_unique<Node>(id, host, port, num_nodes, directory, options);
 
         // Avvio del metodo start() del nodo in un nuovo thread
         threads.emplace_back(&Node::start, node.get());
@@ -65,6 +144,13 @@ int main() {
             t.join();        
     }
 
+    // Riepilogo della cache di sintesi, condivisa da tutti i nodi
+    SynthesisCacheStats cache_stats = AudioManager::synthesisCacheStats();
+    std::cout << "Synthesis cache: " << cache_stats.hits << " memory hits, " << cache_stats.disk_hits
+              << " disk hits, " << cache_stats.misses << " misses, " << cache_stats.coalesced
+              << " coalesced" << std::endl;
+    Logger::log_cache_stats(cache_stats.hits, cache_stats.disk_hits, cache_stats.misses, cache_stats.coalesced);
+
     Logger::close_log();     
 
     return 0;                
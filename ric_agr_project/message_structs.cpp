@@ -3,22 +3,180 @@
 #include "message_structs.h"
 #include <sstream>
 #include <iostream>
+#include <charconv>
+#include <chrono>
 
 // Funzione per serializzare un messaggio
 std::string serialize_message(const Message& msg) {
     std::ostringstream oss;
     // Serializza il tipo del messaggio (conversione in int per l'enum)
     oss << static_cast<int>(msg.type) << " " << msg.sender_id << " " 
-        << msg.logical_clock << " " << msg.deadline_ms;
+        << msg.logical_clock << " " << msg.deadline_ms << " " << msg.resource_id
+        << " " << static_cast<int>(msg.mode) << " " << msg.request_ts;
+    // Il TOKEN prosegue con "n LN... n coda..."
+    if (msg.type == MessageType::TOKEN) {
+        oss << " " << msg.token_ln.size();
+        for (int v : msg.token_ln) oss << " " << v;
+        oss << " " << msg.token_queue.size();
+        for (int v : msg.token_queue) oss << " " << v;
+    }
     return oss.str();  // Restituisce il messaggio serializzato come stringa
 }
 
-// Funzione per deserializzare un messaggio da una stringa
-Message deserialize_message(const std::string& str) {
-    std::istringstream iss(str);
-    int type, sender_id, logical_clock, deadline;
-    // Deserializza i campi dalla stringa
-    iss >> type >> sender_id >> logical_clock >> deadline;
-    // Crea e restituisce il messaggio deserializzato
-    return Message(static_cast<MessageType>(type), sender_id, logical_clock, deadline);
+int32_t wire_now_ms() {
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return static_cast<int32_t>(static_cast<uint32_t>(now));
+}
+
+int make_deadline(int budget_ms) {
+    if (budget_ms <= 0) return 0;
+    int deadline = static_cast<int32_t>(static_cast<uint32_t>(wire_now_ms()) + static_cast<uint32_t>(budget_ms));
+    return deadline != 0 ? deadline : 1;  // 0 è riservato a "nessuna deadline"
+}
+
+// Legge il prossimo intero separato da spazi
+static bool parse_int(const char*& p, const char* end, int& value) {
+    while (p < end && *p == ' ') ++p;
+    auto [next, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc()) return false;
+    p = next;
+    return true;
+}
+
+// Legge "n v1 ... vn" nel vettore
+static bool parse_list(const char*& p, const char* end, std::vector<int>& out) {
+    int count;
+    if (!parse_int(p, end, count) || count < 0 || count > end - p) return false;
+    out.resize(count);
+    for (int& v : out) {
+        if (!parse_int(p, end, v)) return false;
+    }
+    return true;
+}
+
+// Analizza "tipo sender clock deadline traccia modalità request_ts" con from_chars
+// (nessun locale, nessuna copia)
+bool parse_message(std::string_view str, Message& out) {
+    int fields[7];
+    const char* p = str.data();
+    const char* end = str.data() + str.size();
+    for (int& field : fields) {
+        if (!parse_int(p, end, field)) return false;
+    }
+    if (fields[0] < 0 || fields[0] > static_cast<int>(LAST_MESSAGE_TYPE)) return false;
+    if (fields[5] < 0 || fields[5] > static_cast<int>(LockMode::SHARED)) return false;
+
+    out.type = static_cast<MessageType>(fields[0]);
+    out.sender_id = fields[1];
+    out.logical_clock = fields[2];
+    out.deadline_ms = fields[3];
+    out.resource_id = fields[4];
+    out.mode = static_cast<LockMode>(fields[5]);
+    out.request_ts = fields[6];
+    out.token_ln.clear();
+    out.token_queue.clear();
+    if (out.type == MessageType::TOKEN) {
+        return parse_list(p, end, out.token_ln) && parse_list(p, end, out.token_queue);
+    }
+    return true;
+}
+
+// Scrittura/lettura little-endian indipendente dall'architettura
+static void put_u16(char* p, uint16_t v) {
+    p[0] = static_cast<char>(v & 0xFF);
+    p[1] = static_cast<char>(v >> 8);
+}
+
+static void put_i32(char* p, int32_t value) {
+    uint32_t v = static_cast<uint32_t>(value);
+    p[0] = static_cast<char>(v & 0xFF);
+    p[1] = static_cast<char>((v >> 8) & 0xFF);
+    p[2] = static_cast<char>((v >> 16) & 0xFF);
+    p[3] = static_cast<char>(v >> 24);
+}
+
+static uint16_t get_u16(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>(u[0] | (u[1] << 8));
+}
+
+static int32_t get_i32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<int32_t>(static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) |
+                                (static_cast<uint32_t>(u[2]) << 16) | (static_cast<uint32_t>(u[3]) << 24));
+}
+
+size_t encoded_size(const Message& msg) {
+    if (msg.type != MessageType::TOKEN) return WIRE_FRAME_SIZE;
+    return WIRE_FRAME_SIZE + 4 + 4 * (msg.token_ln.size() + msg.token_queue.size());
+}
+
+// Codifica binaria del messaggio nel buffer fornito dal chiamante
+size_t encode_message(const Message& msg, char* buf, size_t cap) {
+    size_t size = encoded_size(msg);
+    if (cap < size || size > UINT16_MAX) return 0;
+    if (msg.resource_id < 0 || msg.resource_id > UINT16_MAX) return 0;
+
+    put_u16(buf, static_cast<uint16_t>(size));
+    buf[2] = static_cast<char>(WIRE_MAGIC);
+    buf[3] = static_cast<char>(WIRE_VERSION);
+    buf[4] = static_cast<char>(msg.type);
+    buf[5] = static_cast<char>(msg.mode);
+    put_u16(buf + 6, static_cast<uint16_t>(msg.resource_id));
+    put_i32(buf + 8, msg.sender_id);
+    put_i32(buf + 12, msg.logical_clock);
+    put_i32(buf + 16, msg.deadline_ms);
+    put_i32(buf + 20, msg.request_ts);
+
+    if (msg.type == MessageType::TOKEN) {
+        char* p = buf + WIRE_FRAME_SIZE;
+        put_u16(p, static_cast<uint16_t>(msg.token_ln.size()));
+        put_u16(p + 2, static_cast<uint16_t>(msg.token_queue.size()));
+        p += 4;
+        for (int v : msg.token_ln) { put_i32(p, v); p += 4; }
+        for (int v : msg.token_queue) { put_i32(p, v); p += 4; }
+    }
+    return size;
+}
+
+// Decodifica sul posto di un frame binario
+bool decode_message(const char* data, size_t len, Message& out) {
+    if (len < WIRE_FRAME_SIZE || get_u16(data) != len) return false;
+    if (static_cast<uint8_t>(data[2]) != WIRE_MAGIC || static_cast<uint8_t>(data[3]) != WIRE_VERSION) return false;
+
+    uint8_t type = static_cast<uint8_t>(data[4]);
+    if (type > static_cast<uint8_t>(LAST_MESSAGE_TYPE)) return false;
+    uint8_t mode = static_cast<uint8_t>(data[5]);
+    if (mode > static_cast<uint8_t>(LockMode::SHARED)) return false;
+
+    out.type = static_cast<MessageType>(type);
+    out.sender_id = get_i32(data + 8);
+    out.logical_clock = get_i32(data + 12);
+    out.deadline_ms = get_i32(data + 16);
+    out.request_ts = get_i32(data + 20);
+    out.resource_id = get_u16(data + 6);
+    out.mode = static_cast<LockMode>(mode);
+
+    out.token_ln.clear();
+    out.token_queue.clear();
+    if (out.type != MessageType::TOKEN) return len == WIRE_FRAME_SIZE;
+
+    // Payload del TOKEN: le due lunghezze devono coincidere con quella del frame
+    if (len < WIRE_FRAME_SIZE + 4) return false;
+    const char* p = data + WIRE_FRAME_SIZE;
+    size_t ln_count = get_u16(p), queue_count = get_u16(p + 2);
+    if (len != WIRE_FRAME_SIZE + 4 + 4 * (ln_count + queue_count)) return false;
+    p += 4;
+    out.token_ln.resize(ln_count);
+    for (int& v : out.token_ln) { v = get_i32(p); p += 4; }
+    out.token_queue.resize(queue_count);
+    for (int& v : out.token_queue) { v = get_i32(p); p += 4; }
+    return true;
+}
+
+// Lunghezza del frame dal prefisso, per lo split dello stream TCP
+size_t peek_frame_length(const char* data, size_t len) {
+    if (len < WIRE_HEADER_SIZE) return 0;
+    return get_u16(data);
 }
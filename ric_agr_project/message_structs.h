@@ -1,33 +1,108 @@
-// Definizioni dei messaggi (REQUEST, ACK, RELEASE)
+// Definizioni dei messaggi (REQUEST, ACK, RELEASE, controllo di Maekawa, TOKEN e HEARTBEAT)
 
 #ifndef MESSAGE_STRUCTS_H
 #define MESSAGE_STRUCTS_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <vector>
 
 enum class MessageType {
     REQUEST,  // Richiesta di accesso alla traccia
     ACK,      // Risposta (acknowledgement)
-    RELEASE   // Rilascio della traccia
+    RELEASE,  // Rilascio della traccia
+    INQUIRE,  // Maekawa: l'arbitro chiede se il permesso concesso può essere restituito
+    YIELD,    // Maekawa: il permesso viene restituito all'arbitro
+    FAILED,   // Maekawa: l'arbitro ha già concesso il permesso a una richiesta precedente
+    TOKEN,    // Suzuki-Kasami: passaggio del token (con l'array LN e la coda)
+    HEARTBEAT // Rilevatore di guasti: segno di vita periodico (non riguarda alcuna traccia)
+};
+
+// Ultimo tipo valido, per la validazione dei messaggi ricevuti
+constexpr MessageType LAST_MESSAGE_TYPE = MessageType::HEARTBEAT;
+
+// Modalità di accesso richiesta da una REQUEST
+enum class LockMode {
+    EXCLUSIVE,  // Scrittura: esclude chiunque altro
+    SHARED      // Lettura/riproduzione: compatibile con altre richieste SHARED
 };
 
 // Struttura di un messaggio
 struct Message {
-    MessageType type;     // Tipo del messaggio (REQUEST, ACK, RELEASE)
+    MessageType type;     // Tipo del messaggio (REQUEST, ACK, RELEASE, ...)
     int sender_id;        // ID del nodo che invia il messaggio
     int logical_clock;    // Clock logico del nodo (per Ricart-Agrawala)
     int deadline_ms;      // Deadline associata al messaggio (se applicabile)
+    int resource_id;      // Traccia (sezione critica) a cui si riferisce il messaggio
+    LockMode mode = LockMode::EXCLUSIVE;  // REQUEST: accesso esclusivo o condiviso
+    int request_ts = 0;   // ACK: timestamp della REQUEST a cui risponde
+    std::vector<int> token_ln;     // TOKEN: numero dell'ultima richiesta servita per ogni nodo
+    std::vector<int> token_queue;  // TOKEN: nodi in attesa del token, in ordine
 
     // Costruttore della struttura
-    Message(MessageType t, int id, int clock, int deadline)
-        : type(t), sender_id(id), logical_clock(clock), deadline_ms(deadline) {}
+    Message(MessageType t, int id, int clock, int deadline, int resource = 0)
+        : type(t), sender_id(id), logical_clock(clock), deadline_ms(deadline), resource_id(resource) {}
+
+    // Messaggio vuoto, da riempire con decode_message
+    Message() : Message(MessageType::REQUEST, 0, 0, 0) {}
 };
 
+// Deadline sul filo: tempo di parete in millisecondi troncato a 32 bit (0 = nessuna
+// deadline). I confronti usano l'aritmetica modulare, come i numeri di sequenza TCP.
+int32_t wire_now_ms();
+
+// Deadline assoluta tra budget_ms millisecondi; 0 se budget_ms <= 0
+int make_deadline(int budget_ms);
+
+// true se la deadline a scade prima della deadline b
+inline bool deadline_before(int a, int b) {
+    return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b)) < 0;
+}
+
+// Millisecondi rimasti prima della deadline (negativi se già superata)
+inline int deadline_slack(int deadline_ms) {
+    return static_cast<int32_t>(static_cast<uint32_t>(deadline_ms) - static_cast<uint32_t>(wire_now_ms()));
+}
+
+// Formato dei messaggi sul filo (selezionabile da config.json con "wire_format")
+enum class WireFormat {
+    TEXT,    // Testo separato da spazi, un messaggio per riga (debug)
+    BINARY   // Frame binario little-endian a lunghezza fissa
+};
+
+// Frame binario: header [u16 lunghezza totale][u8 magic][u8 versione]
+// seguito da [u8 tipo][u8 modalità][u16 traccia][i32 sender][i32 clock][i32 deadline]
+// [i32 request_ts]. Solo il TOKEN prosegue con [u16 n LN][u16 n coda][i32 LN...][i32 coda...].
+// La versione 3 ha aggiunto request_ts: i frame v2 vengono rifiutati.
+constexpr uint8_t WIRE_MAGIC = 0xA7;
+constexpr uint8_t WIRE_VERSION = 3;
+constexpr size_t WIRE_HEADER_SIZE = 4;
+constexpr size_t WIRE_FRAME_SIZE = WIRE_HEADER_SIZE + 20;
+
 // Funzione per serializzare un messaggio in una stringa
 std::string serialize_message(const Message& msg);
 
-// Funzione per deserializzare una stringa in un messaggio
-Message deserialize_message(const std::string& str);
+// Analizza il formato testo direttamente da una view, senza allocazioni.
+// Restituisce false se la riga non contiene sette interi validi.
+bool parse_message(std::string_view str, Message& out);
+
+// Dimensione del frame binario del messaggio (WIRE_FRAME_SIZE, di più solo per il TOKEN)
+size_t encoded_size(const Message& msg);
+
+// Codifica il messaggio in formato binario nel buffer del chiamante.
+// Restituisce i byte scritti, oppure 0 se il buffer è troppo piccolo
+// o la traccia non sta in 16 bit.
+size_t encode_message(const Message& msg, char* buf, size_t cap);
+
+// Decodifica un frame binario completo direttamente dal buffer, senza allocazioni.
+// Restituisce false se il frame è troncato o ha magic/versione non validi.
+bool decode_message(const char* data, size_t len, Message& out);
+
+// Legge la lunghezza totale del frame binario che inizia in data.
+// Restituisce 0 se l'header non è ancora completo.
+size_t peek_frame_length(const char* data, size_t len);
 
 #endif // MESSAGE_STRUCTS_H
@@ -0,0 +1,84 @@
+// Coda circolare lock-free a capacità fissa, multi-produttore / singolo consumatore.
+// Ogni cella porta un numero di sequenza (schema di D. Vyukov): i produttori si
+// contendono la posizione di coda con una CAS, il consumatore avanza senza CAS.
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+template <typename T>
+class MpscQueue {
+public:
+    // La capacità deve essere una potenza di due
+    explicit MpscQueue(size_t capacity)
+        : mask_(capacity - 1), cells_(new Cell[capacity]) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("MpscQueue capacity must be a power of two");
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Inserisce un elemento; false se la coda è piena (chiamabile da più thread)
+    bool try_push(const T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;                    // Piena
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Estrae un elemento; false se la coda è vuota (solo dal thread consumatore)
+    bool try_pop(T& out) {
+        Cell& cell = cells_[head_ & mask_];
+        size_t seq = cell.seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(head_ + 1) < 0) {
+            return false;                        // Vuota (o produttore non ancora concluso)
+        }
+        out = std::move(cell.value);
+        cell.seq.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    // true se non ci sono elementi pronti (solo dal thread consumatore)
+    bool empty() const {
+        const Cell& cell = cells_[head_ & mask_];
+        return static_cast<intptr_t>(cell.seq.load(std::memory_order_acquire)) -
+               static_cast<intptr_t>(head_ + 1) < 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> tail_{0};   // Posizione di inserimento (produttori)
+    alignas(64) size_t head_ = 0;               // Posizione di estrazione (consumatore)
+};
+
+#endif // MPSC_QUEUE_H
@@ -0,0 +1,23 @@
+// Selezione del protocollo di mutua esclusione
+
+#include "mutex_protocol.h"
+#include "ricart_agrawala.h"
+#include "ricart_agrawala_locked.h"
+#include "maekawa.h"
+#include "suzuki_kasami.h"
+#include <stdexcept>
+
+std::unique_ptr<MutexProtocol> make_mutex_protocol(const ProtocolContext& ctx) {
+    if (ctx.options.protocol == "ricart_agrawala") {
+        // Oltre MAX_NODES i permessi non stanno nella parola di stato lock-free
+        if (ctx.num_nodes > RicartAgrawala::MAX_NODES) return std::make_unique<RicartAgrawalaLocked>(ctx);
+        return std::make_unique<RicartAgrawala>(ctx);
+    }
+    if (ctx.options.protocol == "maekawa") {
+        return std::make_unique<Maekawa>(ctx);
+    }
+    if (ctx.options.protocol == "suzuki_kasami") {
+        return std::make_unique<SuzukiKasami>(ctx);
+    }
+    throw std::runtime_error("Unknown mutual exclusion protocol: " + ctx.options.protocol);
+}
@@ -0,0 +1,133 @@
+// Interfaccia dei protocolli di mutua esclusione distribuita guidati da Node
+
+#ifndef MUTEX_PROTOCOL_H
+#define MUTEX_PROTOCOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "message_structs.h"
+
+class Network;
+
+// Opzioni del protocollo lette da config.json
+struct NodeOptions {
+    std::string protocol = "ricart_agrawala"; // Protocollo di mutua esclusione
+    bool permission_reuse = false;  // Modalità Roucairol-Carvalho: riuso dei permessi già ottenuti
+    int num_tracks = 1;             // Tracce indipendenti, ognuna con la propria sezione critica
+    std::string priority = "lamport"; // Ordine delle richieste: "lamport" oppure "edf" (deadline più vicina)
+    int deadline_ms = 0;            // Budget di ogni richiesta simulata (0 = nessuna deadline)
+    double read_ratio = 0.0;        // Frazione delle richieste simulate in lettura (accesso condiviso)
+    int heartbeat_ms = 0;           // Intervallo degli heartbeat (0 = rilevatore di guasti disattivato)
+    int suspect_timeout_ms = 3000;  // Silenzio dopo il quale un peer è sospettato guasto
+    int acquire_timeout_ms = 0;     // Timeout delle richieste simulate (0 = attesa illimitata)
+    int crash_node = -1;            // Fault injection: nodo che si ferma a metà esecuzione (-1 = nessuno)
+    int crash_after_entries = 0;    // Ingressi in sezione critica prima del guasto simulato
+    bool crash_while_holding = false; // Il guasto avviene dentro l'ingresso successivo, senza rilascio
+};
+
+// Contatori dei messaggi inviati dal nodo, per confrontare le modalità
+struct MessageStats {
+    std::atomic<long> requests{0};      // REQUEST inviate
+    std::atomic<long> acks{0};          // ACK inviati
+    std::atomic<long> releases{0};      // RELEASE inviati
+    std::atomic<long> control{0};       // Messaggi di controllo (INQUIRE, YIELD, FAILED, TOKEN)
+    std::atomic<long> timeouts{0};      // Richieste ritirate per timeout
+    std::atomic<long> entries{0};       // Ingressi in sezione critica
+    std::atomic<long> free_entries{0};  // Ingressi senza alcuna REQUEST
+    std::atomic<long> deadline_entries{0}; // Ingressi con una deadline
+    std::atomic<long> deadline_misses{0};  // Ingressi avvenuti dopo la deadline
+    std::atomic<long> hold_us{0};       // Tempo totale trascorso in sezione critica (µs)
+
+    long total() const { return requests.load() + acks.load() + releases.load() + control.load(); }
+};
+
+// Clock logico di Lamport condiviso tra il nodo e il suo protocollo (lock-free)
+class LamportClock {
+public:
+    // Evento locale: incrementa e restituisce il nuovo valore
+    int tick() {
+        return value_.fetch_add(1) + 1;
+    }
+
+    // Ricezione: max(locale, ricevuto) + 1
+    int update(int received) {
+        int current = value_.load();
+        int next;
+        do {
+            next = std::max(current, received) + 1;
+        } while (!value_.compare_exchange_weak(current, next));
+        return next;
+    }
+
+    int now() const {
+        return value_.load();
+    }
+
+private:
+    std::atomic<int> value_{0};
+};
+
+// Istante limite di acquire() per un'attesa senza timeout
+constexpr std::chrono::steady_clock::time_point NO_TIMEOUT = std::chrono::steady_clock::time_point::max();
+
+// Attende pred fino a give_up_at (NO_TIMEOUT = senza limite); restituisce pred()
+template <class Predicate>
+bool wait_or_give_up(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                     std::chrono::steady_clock::time_point give_up_at, Predicate pred) {
+    if (give_up_at == NO_TIMEOUT) {
+        cv.wait(lock, pred);
+        return true;
+    }
+    return cv.wait_until(lock, give_up_at, pred);
+}
+
+// Servizi del nodo a disposizione del protocollo
+struct ProtocolContext {
+    int id;                 // ID del nodo
+    int num_nodes;          // Numero totale nodi
+    int resource_id;        // Traccia protetta da questa istanza del protocollo
+    Network* network;       // Rete di comunicazione
+    LamportClock* clock;    // Clock logico del nodo
+    std::vector<int>* rn;   // Suzuki-Kasami: RN del nodo (protetto dal mutex del protocollo)
+    MessageStats* stats;    // Contatori dei messaggi
+    NodeOptions options;
+};
+
+class MutexProtocol {
+public:
+    virtual ~MutexProtocol() = default;
+
+    // Richiede la sezione critica e blocca finché non è concessa o fino a
+    // give_up_at: in quel caso la richiesta viene ritirata e restituisce false.
+    // deadline_ms (0 = nessuna) viaggia nella REQUEST; con priority "edf"
+    // Ricart-Agrawala la usa per decidere chi differisce l'ACK.
+    // Solo Ricart-Agrawala distingue LockMode::SHARED: gli altri protocolli
+    // trattano ogni richiesta come esclusiva.
+    virtual bool acquire(int deadline_ms, LockMode mode, std::chrono::steady_clock::time_point give_up_at) = 0;
+
+    // Rilascia la sezione critica
+    virtual void release() = 0;
+
+    // Elabora un messaggio del protocollo ricevuto da un peer
+    virtual void on_message(const Message& message) = 0;
+
+    // Il rilevatore di guasti sospetta il peer: non va più atteso
+    virtual void on_peer_down(int peer) = 0;
+
+    // Il peer sospettato è tornato: va di nuovo coinvolto nelle richieste
+    virtual void on_peer_up(int peer) = 0;
+
+    // Nome del protocollo (per i log)
+    virtual const char* name() const = 0;
+};
+
+// Crea il protocollo indicato da ctx.options.protocol per la traccia ctx.resource_id
+std::unique_ptr<MutexProtocol> make_mutex_protocol(const ProtocolContext& ctx);
+
+#endif // MUTEX_PROTOCOL_H
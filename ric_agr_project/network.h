@@ -1,29 +1,62 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <tuple>
+#include "message_structs.h"
+#include "peer_directory.h"
+#include "transport.h"
+#include "tcp_transport.h"
+#include "local_transport.h"
 
 class Network {
 public:
-    // Costruisce il modulo di rete e carica la configurazione dei peer
-    explicit Network(int port, const std::string& config_path = "config.json");
+    // Costruisce il modulo di rete del nodo a partire dalla directory condivisa
+    Network(int self_id, std::shared_ptr<const PeerDirectory> directory);
 
-    // Imposta la callback da chiamare quando arriva un messaggio
-    void set_receive_callback(std::function<void(const std::string&)> cb);
+    // Imposta la callback da chiamare quando arriva un frame TCP completo
+    void set_receive_callback(std::function<void(std::string_view)> cb);
 
-    // Avvia il server TCP per ricevere messaggi
+    // Imposta la callback per i messaggi consegnati dal trasporto in-process
+    void set_message_callback(std::function<void(const Message&)> cb);
+
+    // Avvia la ricezione: dispatcher della inbox locale e/o reactor del server TCP,
+    // ciascuno nel proprio thread (non bloccante, fermati dal distruttore)
     void start_server();
 
-    // Invia un messaggio al nodo target (specificato da ID)
-    void send_message(int target_id, const std::string& message);
+    // Accoda il messaggio per il nodo target (specificato da ID) sul trasporto
+    // configurato per quel peer; non bloccante
+    void send_message(int target_id, const Message& message);
+
+    // Come send_message, restituendo l'handle di completamento
+    std::shared_ptr<SendCompletion> send_async(int target_id, const Message& message);
+
+    // Invia il messaggio a tutti i peer in parallelo (una coda per peer):
+    // un peer lento o irraggiungibile non rallenta gli altri
+    std::shared_ptr<SendCompletion> broadcast(const Message& message);
 
-    // Carica la configurazione dei peer da file JSON
-    void load_config(const std::string& config_path);
+    // ID di tutti i peer raggiungibili (escluso se stesso)
+    std::vector<int> peer_ids() const;
+
+    // Decodifica un frame TCP ricevuto secondo il formato configurato
+    bool decode_frame(std::string_view frame, Message& out) const;
+
+    // Formato dei messaggi sul filo
+    WireFormat wire_format() const { return directory_->wire_format(); }
 
 private:
-    int port_;
-    std::vector<std::tuple<int, std::string, int>> peers_;  // (node_id, host, port)
-    std::function<void(const std::string&)> recv_cb_;
-};
\ No newline at end of file
+    // Trasporto verso il peer (O(1)); nullptr se il peer non esiste
+    Transport* route(int target_id) const {
+        if (target_id < 0 || target_id >= static_cast<int>(routes_.size())) return nullptr;
+        return routes_[target_id];
+    }
+
+    int self_id_;
+    std::shared_ptr<const PeerDirectory> directory_;
+    std::unique_ptr<TcpTransport> tcp_;                     // Peer remoti
+    std::unique_ptr<LocalTransport> local_;                 // Peer nello stesso processo
+    std::vector<Transport*> routes_;                        // node_id -> trasporto scelto
+    int num_peers_ = 0;
+};
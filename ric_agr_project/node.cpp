@@ -2,63 +2,227 @@
 #include "logger.h" // Logger incluso per l'utilizzo delle funzioni di log
 #include "message_structs.h"
 #include <random>
+#include <algorithm>
+#include <filesystem>
 #include "audio_manager.h"
 
-Node::Node(int id, const std::string& host, int port, int num_nodes)
-    : id_(id), host_(host), port_(port), clock_(0), num_nodes_(num_nodes),
-      requesting_(std::make_shared<std::atomic<bool>>(false)),
-      ack_count_(std::make_shared<std::atomic<int>>(0)),
-      mtx_(std::make_shared<std::mutex>()),
-      cv_(std::make_shared<std::condition_variable>()) {
-    network_ = std::make_unique<Network>(port_);
-    network_->set_receive_callback([this](const std::string& msg) {
-        this->receive_message(msg);
+namespace fs = std::filesystem;
+
+Node::Node(int id, const std::string& host, int port, int num_nodes,
+           std::shared_ptr<const PeerDirectory> directory, const NodeOptions& options)
+    : id_(id), host_(host), port_(port), num_nodes_(num_nodes), options_(options) {
+    network_ = std::make_unique<Network>(id_, std::move(directory));
+
+    // Un'istanza del protocollo per traccia: richieste su tracce diverse non si contendono nulla
+    resources_.resize(std::max(1, options_.num_tracks));
+    for (int r = 0; r < static_cast<int>(resources_.size()); ++r) {
+        resources_[r].rn.assign(num_nodes_, 0);
+        resources_[r].protocol = make_mutex_protocol(
+            {id_, num_nodes_, r, network_.get(), &clock_, &resources_[r].rn, &stats_, options_});
+    }
+
+    // Rilevatore di guasti: un peer sospettato non viene più atteso da nessuna traccia
+    if (options_.heartbeat_ms > 0) {
+        detector_ = std::make_unique<FailureDetector>(
+            id_, network_.get(), network_->peer_ids(), std::chrono::milliseconds(options_.heartbeat_ms),
+            std::chrono::milliseconds(options_.suspect_timeout_ms));
+        detector_->set_callbacks(
+            [this](int peer) {
+                for (auto& r : resources_) r.protocol->on_peer_down(peer);
+            },
+            [this](int peer) {
+                for (auto& r : resources_) r.protocol->on_peer_up(peer);
+            });
+    }
+
+    network_->set_receive_callback([this](std::string_view frame) {
+        this->receive_message(frame);
+    });
+    network_->set_message_callback([this](const Message& msg) {
+        this->handle_message(msg);
     });
 }
 
+Node::~Node() {
+    // Il thread del rilevatore e il dispatcher della rete entrano in resources_
+    // (e il dispatcher anche in detector_): vanno fermati e attesi per primi
+    if (detector_) detector_->stop();
+    network_.reset();
+}
+
 void Node::start() {
     // Avvia il server per la comunicazione con altri nodi
-    std::thread server_thread(&Network::start_server, network_.get());
-    server_thread.detach();
-    std::this_thread::sleep_for(std::chrono::seconds(1)); // Aspetta che parta il server
+    network_->start_server();
+    std::this_thread::sleep_for(std::chrono::seconds(1)); // Aspetta che partano i server degli altri nodi
+    if (detector_) detector_->start();
 
     // Prepara il generator di numeri casuali
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> dist(1, 5);
+    std::uniform_int_distribution<> track_dist(0, static_cast<int>(resources_.size()) - 1);
+    std::bernoulli_distribution read_dist(options_.read_ratio);
 
-    // Simulazione delle richieste periodiche di accesso alla traccia
+    // Simulazione delle richieste periodiche di accesso a una traccia casuale
     for (int i = 0; i < 5; ++i) {
         int delay = dist(gen);
         std::this_thread::sleep_for(std::chrono::seconds(delay)); // Richiedi ogni 5 secondi
-        request_critical_section();
+        if (read_dist(gen)) {
+            request_shared_critical_section(track_dist(gen), make_deadline(options_.deadline_ms));
+        } else if (options_.acquire_timeout_ms > 0) {
+            if (!try_request_critical_section(track_dist(gen), std::chrono::milliseconds(options_.acquire_timeout_ms),
+                                              make_deadline(options_.deadline_ms)) &&
+                !crashed_.load()) {
+                std::cout << "[Node " << id_ << "] Request timed out, giving up" << std::endl;
+            }
+        } else {
+            request_critical_section(track_dist(gen), make_deadline(options_.deadline_ms));
+        }
+
+        // Fault injection: il nodo configurato si ferma dopo crash_after_entries ingressi
+        // (con while_holding è già caduto dentro la sezione critica)
+        if (crashed_.load()) return;
+        if (id_ == options_.crash_node && stats_.entries.load() >= options_.crash_after_entries) {
+            crash();
+            return;
+        }
     }
-}
 
-void Node::request_critical_section() {
-    requesting_->store(true);
+    // Riepilogo dei messaggi inviati, per confrontare le modalità del protocollo
+    long entries = stats_.entries.load();
+    std::cout << "[Node " << id_ << "] " << resources_[0].protocol->name() << ": " << entries << " CS entries, "
+              << stats_.total() << " messages sent (REQUEST=" << stats_.requests.load()
+              << ", ACK=" << stats_.acks.load() << ", RELEASE=" << stats_.releases.load()
+              << ", CONTROL=" << stats_.control.load() << "), " << stats_.free_entries.load() << " entries without messages, "
+              << stats_.timeouts.load() << " timeouts" << std::endl;
+    if (entries > 0) {
+        std::cout << "[Node " << id_ << "] average critical section hold: "
+                  << stats_.hold_us.load() / entries / 1000.0 << " ms" << std::endl;
+    }
+    Logger::log_message_stats(id_, entries, stats_.total(), stats_.free_entries.load());
+
+    // Riepilogo delle deadline: p99 del ritardo rispetto alla deadline
+    std::vector<int> lateness;
     {
-        std::lock_guard<std::mutex> lk(clock_mtx_);
-        clock_++;
-        my_request_ts_ = clock_;  // 🔥 fondamentale
+        std::lock_guard<std::mutex> lock(deadline_mtx_);
+        lateness = lateness_ms_;
+    }
+    if (!lateness.empty()) {
+        size_t p99_index = (lateness.size() * 99 + 99) / 100 - 1;
+        std::nth_element(lateness.begin(), lateness.begin() + p99_index, lateness.end());
+        int p99 = lateness[p99_index];
+        std::cout << "[Node " << id_ << "] deadlines (" << options_.priority << "): " << stats_.deadline_misses.load()
+                  << "/" << stats_.deadline_entries.load() << " missed, p99 lateness " << p99 << " ms" << std::endl;
+        Logger::log_deadline_stats(id_, stats_.deadline_entries.load(), stats_.deadline_misses.load(), p99);
+    }
+}
+
+void Node::request_critical_section(int resource_id, int deadline_ms) {
+    request_critical_section(std::vector<int>{resource_id}, deadline_ms);
+}
+
+void Node::request_critical_section(std::vector<int> resource_ids, int deadline_ms) {
+    // Input, sintesi e DSP avvengono prima della richiesta: gli altri nodi
+    // non attendono mai il lavoro lento, solo la pubblicazione della traccia
+    normalize_resources(resource_ids);
+    PreparedTrack track = prepare_track(resource_ids);
+    if (!track.ok) return;
+    if (acquire_resources(resource_ids, deadline_ms, LockMode::EXCLUSIVE)) {
+        enter_critical_section(resource_ids, track);
     }
+}
+
+bool Node::try_request_critical_section(int resource_id, std::chrono::milliseconds timeout, int deadline_ms) {
+    return try_request_critical_section(std::vector<int>{resource_id}, timeout, deadline_ms);
+}
+
+bool Node::try_request_critical_section(std::vector<int> resource_ids, std::chrono::milliseconds timeout,
+                                        int deadline_ms) {
+    normalize_resources(resource_ids);
+    PreparedTrack track = prepare_track(resource_ids);
+    if (!track.ok) return false;
+
+    auto give_up_at = std::chrono::steady_clock::now() + timeout;
+    if (!acquire_resources(resource_ids, deadline_ms, LockMode::EXCLUSIVE, give_up_at)) return false;
+    enter_critical_section(resource_ids, track);
+    return true;
+}
+
+void Node::request_shared_critical_section(int resource_id, int deadline_ms) {
+    request_shared_critical_section(std::vector<int>{resource_id}, deadline_ms);
+}
+
+void Node::request_shared_critical_section(std::vector<int> resource_ids, int deadline_ms) {
+    if (acquire_resources(resource_ids, deadline_ms, LockMode::SHARED)) {
+        enter_shared_critical_section(resource_ids);
+    }
+}
+
+void Node::normalize_resources(std::vector<int>& resource_ids) {
+    std::sort(resource_ids.begin(), resource_ids.end());
+    resource_ids.erase(std::unique(resource_ids.begin(), resource_ids.end()), resource_ids.end());
+}
+
+std::string Node::track_name(const std::vector<int>& resource_ids) {
+    std::string name = "track";
+    for (int resource_id : resource_ids) name += "_" + std::to_string(resource_id);
+    return name;
+}
 
-    Logger::log_request(id_, my_request_ts_);  // Logga la richiesta
+bool Node::acquire_resources(std::vector<int>& resource_ids, int deadline_ms, LockMode mode,
+                             std::chrono::steady_clock::time_point give_up_at) {
+    // Ordine globale fisso (id crescente): nessuna attesa circolare tra i nodi
+    normalize_resources(resource_ids);
+    for (int resource_id : resource_ids) {
+        if (!resource(resource_id)) {
+            std::cerr << "[Node " << id_ << "] Unknown track " << resource_id << std::endl;
+            return false;
+        }
+    }
+    if (resource_ids.empty()) return false;
 
-    // Serializza il messaggio REQUEST
-    std::string message = serialize_message(Message(MessageType::REQUEST, id_, my_request_ts_, 0));
-    
-    // Invia il messaggio serializzato a tutti gli altri nodi
-    for (int i = 0; i < num_nodes_; ++i) {
-        if (i != id_) {
-            network_->send_message(i, message);
+    // Blocca finché il protocollo di ogni traccia non concede la sezione critica
+    for (size_t i = 0; i < resource_ids.size(); ++i) {
+        if (!resource(resource_ids[i])->protocol->acquire(deadline_ms, mode, give_up_at)) {
+            // Timeout: si rilasciano in ordine inverso le tracce già acquisite
+            stats_.timeouts.fetch_add(1);
+            for (size_t j = i; j-- > 0;) resource(resource_ids[j])->protocol->release();
+            return false;
         }
     }
+    long entries = stats_.entries.fetch_add(1) + 1;
+    if (deadline_ms != 0) record_deadline(resource_ids, deadline_ms);
+
+    // Fault injection con la sezione critica in mano: il nodo muore senza rilasciarla
+    if (options_.crash_while_holding && id_ == options_.crash_node && entries > options_.crash_after_entries) {
+        crash();
+        return false;
+    }
+    return true;
+}
+
+void Node::record_deadline(const std::vector<int>& resource_ids, int deadline_ms) {
+    int late_ms = -deadline_slack(deadline_ms);
+    stats_.deadline_entries.fetch_add(1);
+    if (late_ms > 0) {
+        // Deadline mancata: il nodo viene segnalato
+        stats_.deadline_misses.fetch_add(1);
+        std::cout << "[Node " << id_ << "] Deadline missed by " << late_ms << " ms" << std::endl;
+        Logger::log_deadline_miss(id_, resource_ids.front(), late_ms);
+    }
+    std::lock_guard<std::mutex> lock(deadline_mtx_);
+    lateness_ms_.push_back(late_ms);
+}
+
+void Node::record_hold(std::chrono::steady_clock::time_point entered_at) {
+    auto held = std::chrono::steady_clock::now() - entered_at;
+    stats_.hold_us.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(held).count());
+}
 
-    // Aspetta che tutti gli ACK siano ricevuti
-    std::unique_lock<std::mutex> lock(*mtx_);
-    cv_->wait(lock, [this] { return ack_count_->load() == num_nodes_ -1; }); // Aspetta di ricevere num_nodes - 1 ACK
-    enter_critical_section();
+void Node::crash() {
+    std::cout << "[Node " << id_ << "] Fault injection: crashing now" << std::endl;
+    crashed_.store(true);
+    if (detector_) detector_->stop();
 }
 
 void Node::simulateNodeCommunication() {
@@ -68,106 +232,123 @@ void Node::simulateNodeCommunication() {
     std::cout << "[Node " << id_ << "] Communication completed with other nodes." << std::endl;
 }
 
-void Node::enter_critical_section() {
-    Logger::log_critical_section_entry(id_);
-    std::cout << "[Node " << id_ << "] Entering critical section..." << std::endl;
-
-    std::vector<float> audio_buffer;
-    int sampleRate, channels;
+Node::PreparedTrack Node::prepare_track(const std::vector<int>& resource_ids) {
+    PreparedTrack track;
+    std::string name = track_name(resource_ids);
 
     simulateNodeCommunication();
 
-    // Leggi il testo da sintetizzare da riga di comando
+    // Leggi il testo da sintetizzare da riga di comando (più nodi possono
+    // preparare insieme: la console resta comunque una sola)
     std::string input_text;
-    std::cout << "Node " << id_ << " says: ";
-    std::getline(std::cin, input_text);  // Legge l'intera riga di testo
-
-    // Sintetizza il testo in audio
-    if (AudioManager::synthesizeTextToAudio(input_text, audio_buffer, sampleRate, channels, id_)) {
-        AudioManager::processAudio(audio_buffer, sampleRate, channels);
-        AudioManager::saveAudio("output_audio/final_output.wav", audio_buffer, sampleRate, channels);
-        AudioManager::playAudio("output_audio/final_output.wav");
-    } else {
+    {
+        static std::mutex console_mtx;
+        std::lock_guard<std::mutex> lock(console_mtx);
+        std::cout << "Node " << id_ << " says (" << name << "): ";
+        std::getline(std::cin, input_text);  // Legge l'intera riga di testo
+    }
+
+    // Sintetizza e processa il testo (o lo ritrova in cache); il risultato
+    // resta privato del nodo fino al commit
+    std::vector<float> audio_buffer;
+    int sampleRate, channels;
+    if (!AudioManager::synthesizeProcessedAudio(input_text, audio_buffer, sampleRate, channels)) {
         std::cerr << "[Node " << id_ << "] Failed to synthesize audio!" << std::endl;
+        return track;
     }
+    track.path = "output_audio/prepared_" + std::to_string(id_) + ".wav";
+    track.ok = AudioManager::saveAudio(track.path, audio_buffer, sampleRate, channels);
+    return track;
+}
 
-    release_critical_section();
+void Node::enter_critical_section(const std::vector<int>& resource_ids, const PreparedTrack& track) {
+    auto entered_at = std::chrono::steady_clock::now();
+    for (int resource_id : resource_ids) Logger::log_critical_section_entry(id_, resource_id);
+    std::string output_path = "output_audio/" + track_name(resource_ids) + ".wav";
+    std::cout << "[Node " << id_ << "] Entering critical section (" << output_path << ")..." << std::endl;
+
+    // Commit: l'audio è già pronto, basta copiarlo sulla traccia condivisa
+    std::error_code ec;
+    fs::copy_file(track.path, output_path, fs::copy_options::overwrite_existing, ec);
+    if (ec) std::cerr << "[Node " << id_ << "] Failed to write " << output_path << ": " << ec.message() << std::endl;
+
+    record_hold(entered_at);
+    release_critical_section(resource_ids);
+
+    // La riproduzione usa il file privato: non serve trattenere la traccia
+    if (!ec) AudioManager::playAudio(track.path);
 }
 
-void Node::release_critical_section() {
-    requesting_->store(false);
-    clock_++;
-    
-    Logger::log_critical_section_exit(id_);  // Logga l'uscita dalla sezione critica
-    std::cout << "[Node " << id_ << "] Sending RELEASE with clock: " << clock_ << std::endl;
+void Node::enter_shared_critical_section(const std::vector<int>& resource_ids) {
+    auto entered_at = std::chrono::steady_clock::now();
 
-    // Serializza il messaggio RELEASE e lo invia a tutti gli altri nodi
-    std::string release_message = serialize_message(Message(MessageType::RELEASE, id_, clock_, 0));
-    for (int i = 0; i < num_nodes_; ++i) {
-        if (i != id_) {
-            network_->send_message(i, release_message);
+    // In lettura si fotografano solo le tracce: VLC parte dopo il rilascio,
+    // così uno scrittore non attende la fine della riproduzione
+    std::vector<std::string> snapshots;
+    for (int resource_id : resource_ids) {
+        Logger::log_critical_section_entry(id_, resource_id);
+        std::string track_path = "output_audio/track_" + std::to_string(resource_id) + ".wav";
+        std::string snapshot = "output_audio/playback_" + std::to_string(id_) + "_" + std::to_string(resource_id) + ".wav";
+        std::error_code ec;
+        fs::copy_file(track_path, snapshot, fs::copy_options::overwrite_existing, ec);
+        if (ec) {
+            std::cerr << "[Node " << id_ << "] Cannot read " << track_path << ": " << ec.message() << std::endl;
+        } else {
+            snapshots.push_back(snapshot);
         }
     }
 
-    // Invia gli ACK differiti
-    for (int deferred_id : deferred_acks_) {
-        std::string ack_message = serialize_message(Message(MessageType::ACK, id_, clock_, 0));
-        network_->send_message(deferred_id, ack_message);
+    record_hold(entered_at);
+    release_critical_section(resource_ids);
+
+    for (const std::string& snapshot : snapshots) {
+        std::cout << "[Node " << id_ << "] Playing " << snapshot << " (shared)..." << std::endl;
+        AudioManager::playAudio(snapshot);
+    }
+}
+
+void Node::release_critical_section(const std::vector<int>& resource_ids) {
+    for (auto it = resource_ids.rbegin(); it != resource_ids.rend(); ++it) {
+        resource(*it)->protocol->release();
+        Logger::log_critical_section_exit(id_, *it);  // Logga l'uscita dalla sezione critica
     }
-    deferred_acks_.clear();
-    ack_count_->store(0);
 }
 
-void Node::send_message(int target_node, const std::string& message) {
+void Node::send_message(int target_node, const Message& message) {
     // Funzione per inviare un messaggio (implementa la logica di invio)
     network_->send_message(target_node, message);
 }
 
-void Node::receive_message(const std::string& message) {
-    // Deserializza il messaggio ricevuto
-    Message received_msg = deserialize_message(message);
+void Node::receive_message(std::string_view frame) {
+    // Decodifica il frame ricevuto (testo o binario, secondo la configurazione)
+    Message received_msg;
+    if (!network_->decode_frame(frame, received_msg)) {
+        std::cerr << "[Node " << id_ << "] Dropping malformed frame" << std::endl;
+        return;
+    }
+    handle_message(received_msg);
+}
 
-    // Logga il messaggio ricevuto
-    std::cout << "[Node " << id_ << "] Received message: " << message << std::endl;
+void Node::handle_message(const Message& received_msg) {
+    // Un nodo guasto (simulato) non risponde più a nessuno
+    if (crashed_.load()) return;
 
-    // Elabora la logica per ciascun tipo di messaggio
-    if (received_msg.type == MessageType::REQUEST) {
-        // Aggiorna clock
-        {
-            std::lock_guard<std::mutex> clock_lock(clock_mtx_);
-            clock_ = std::max(clock_, received_msg.logical_clock) + 1;
-        }
-    
-        bool defer_ack = false;
-    
-        {
-            std::lock_guard<std::mutex> lock(*mtx_);
-            // Decide se deferire l'ACK
-            if (requesting_->load()) {
-                if (received_msg.logical_clock < my_request_ts_ ||
-                    (received_msg.logical_clock == my_request_ts_ && received_msg.sender_id < id_)) {
-                    // Il messaggio ha priorità: non deferire
-                    defer_ack = false;
-                } else {
-                    defer_ack = true;
-                }
-            }
-        }
-    
-        if (defer_ack) {
-            deferred_acks_.push_back(received_msg.sender_id);
-        } else {
-            std::string ack_message = serialize_message(Message(MessageType::ACK, id_, clock_, 0));
-            network_->send_message(received_msg.sender_id, ack_message);
-        }
-    }else if (received_msg.type == MessageType::ACK) {
-        {
-            std::lock_guard<std::mutex> clock_lock(clock_mtx_);
-            clock_ = std::max(clock_, received_msg.logical_clock) + 1;
-        }
+    // I protocolli (e il detector) indicizzano per mittente senza ulteriori
+    // controlli: un ID fuori dal cluster, o il proprio, si scarta qui
+    if (received_msg.sender_id < 0 || received_msg.sender_id >= num_nodes_ || received_msg.sender_id == id_) {
+        std::cerr << "[Node " << id_ << "] Dropping message from invalid sender " << received_msg.sender_id << std::endl;
+        return;
+    }
 
-        ack_count_->fetch_add(1);
-        cv_->notify_all();
+    // Ogni messaggio è un segno di vita del mittente
+    if (detector_) detector_->heard_from(received_msg.sender_id);
+    if (received_msg.type == MessageType::HEARTBEAT) return;
+
+    // La logica (clock, permessi, code) è del protocollo della traccia indicata
+    ResourceLock* lock = resource(received_msg.resource_id);
+    if (!lock) {
+        std::cerr << "[Node " << id_ << "] Dropping message for unknown track " << received_msg.resource_id << std::endl;
+        return;
     }
+    lock->protocol->on_message(received_msg);
 }
-
@@ -10,47 +10,128 @@
 #include <condition_variable>
 #include <memory> // per gestire gli oggetti non copiabili
 #include <thread>
+#include <string_view>
+#include <vector>
 #include "network.h"
+#include "peer_directory.h"
+#include "message_structs.h"
+#include "mutex_protocol.h"
+#include "failure_detector.h"
 
 class Node{
 public:
-    // Costruttore del nodo
-    Node(int id, const std::string& host, int port, int num_nodes);
+    // Costruttore del nodo (la directory dei peer è condivisa da tutti i nodi)
+    Node(int id, const std::string& host, int port, int num_nodes,
+         std::shared_ptr<const PeerDirectory> directory,
+         const NodeOptions& options = NodeOptions());
+
+    // Ferma heartbeat e ricezione prima di distruggere le tracce che usano
+    ~Node();
 
     // Funzione per avviare il nodo
     void start();
 
-    // Funzione per richiedere l'accesso alla sezione critica
-    void request_critical_section();
+    // Funzione per richiedere l'accesso alla sezione critica di una traccia.
+    // deadline_ms è una deadline assoluta (make_deadline), 0 = nessuna.
+    void request_critical_section(int resource_id, int deadline_ms = 0);
+
+    // Richiede più tracce insieme: acquisite in ordine crescente di id,
+    // così due richieste sovrapposte non possono andare in stallo
+    void request_critical_section(std::vector<int> resource_ids, int deadline_ms = 0);
+
+    // Accesso condiviso (riproduzione della traccia): più lettori possono essere
+    // dentro insieme, uno scrittore resta esclusivo
+    void request_shared_critical_section(int resource_id, int deadline_ms = 0);
+    void request_shared_critical_section(std::vector<int> resource_ids, int deadline_ms = 0);
+
+    // Come request_critical_section, ma rinuncia dopo timeout: restituisce false
+    // (richiesta ritirata, nessuna traccia trattenuta) se l'audio non è stato preparato
+    // o se l'accesso non arriva in tempo. Il timeout conta solo l'attesa della sezione critica.
+    bool try_request_critical_section(int resource_id, std::chrono::milliseconds timeout, int deadline_ms = 0);
+    bool try_request_critical_section(std::vector<int> resource_ids, std::chrono::milliseconds timeout,
+                                      int deadline_ms = 0);
+
+    // Audio già sintetizzato e processato, pronto da pubblicare su una traccia
+    struct PreparedTrack {
+        bool ok = false;
+        std::string path;   // File privato del nodo, scritto fuori dalla sezione critica
+    };
 
-    // Funzione per entrare nella sezione critica 
-    void enter_critical_section();
+    // Fase di preparazione, senza alcun lock: legge il testo, lo sintetizza,
+    // lo processa e lo salva nel file privato del nodo
+    PreparedTrack prepare_track(const std::vector<int>& resource_ids);
+
+    // Fase di commit (tracce già acquisite, ordinate): pubblica l'audio preparato.
+    // È l'unica parte che richiede la mutua esclusione e dura pochi millisecondi.
+    void enter_critical_section(const std::vector<int>& resource_ids, const PreparedTrack& track);
+
+    // Sezione critica condivisa: copia le tracce già scritte, che vengono
+    // riprodotte dopo il rilascio
+    void enter_shared_critical_section(const std::vector<int>& resource_ids);
     
     void simulateNodeCommunication();
 
-    // Funzione per uscire dalla sezione critica
-    void release_critical_section();
+    // Funzione per uscire dalla sezione critica (rilascio in ordine inverso)
+    void release_critical_section(const std::vector<int>& resource_ids);
 
     // Funzione per inviare i messaggi
-    void send_message(int target_node, const std::string& message);
+    void send_message(int target_node, const Message& message);
 
     // Funzione per ricevere i messaggi
-    void receive_message(const std::string& message);
+    void receive_message(std::string_view frame);
+
+    // Funzione per elaborare un messaggio già decodificato (TCP o in-process)
+    void handle_message(const Message& message);
+
+    // Statistiche sui messaggi inviati
+    const MessageStats& stats() const { return stats_; }
 
 private:
+    // Stato di mutua esclusione di una traccia
+    struct ResourceLock {
+        std::vector<int> rn;                       // Suzuki-Kasami: numero di richiesta più alto visto per ogni nodo
+        std::unique_ptr<MutexProtocol> protocol;   // Istanza del protocollo dedicata alla traccia
+    };
+
+    // Ordina le tracce per id e rimuove i duplicati
+    static void normalize_resources(std::vector<int>& resource_ids);
+
+    // Nome del file di una richiesta, es. "track_0_2" (tracce ordinate)
+    static std::string track_name(const std::vector<int>& resource_ids);
+
+    // Ordina le tracce e le acquisisce tutte nella modalità richiesta entro give_up_at;
+    // false se una traccia non esiste o scade il timeout (le tracce già prese vengono rilasciate)
+    bool acquire_resources(std::vector<int>& resource_ids, int deadline_ms, LockMode mode,
+                           std::chrono::steady_clock::time_point give_up_at = NO_TIMEOUT);
+
+    // Fault injection: il nodo smette di inviare heartbeat e ignora ogni messaggio
+    void crash();
+
+    // Registra il ritardo dell'ingresso rispetto alla deadline della richiesta
+    void record_deadline(const std::vector<int>& resource_ids, int deadline_ms);
+
+    // Registra la durata di una sezione critica (dall'ingresso al rilascio)
+    void record_hold(std::chrono::steady_clock::time_point entered_at);
+
+    // Stato della traccia; nullptr se l'id non è valido
+    ResourceLock* resource(int resource_id) {
+        if (resource_id < 0 || resource_id >= static_cast<int>(resources_.size())) return nullptr;
+        return &resources_[resource_id];
+    }
+
     int id_;    // ID del nodo
     std::string host_; // Host del nodo
     int port_;  // Porta di comunicazione
-    int clock_; // Clock logico per Ricart-Agrawala
     int num_nodes_; // Numero totale nodi
-    std::shared_ptr<std::atomic<bool>> requesting_; // Flag per la richiesta
-    std::shared_ptr<std::atomic<int>> ack_count_;  // Contatore degli ACK ricevuti
-    std::shared_ptr<std::mutex> mtx_;              // Mutex per la sincronizzazione
-    std::shared_ptr<std::condition_variable> cv_;  // Condizione per la sincronizzazione
+    NodeOptions options_;
+    LamportClock clock_; // Clock logico condiviso dai protocolli di tutte le tracce
+    MessageStats stats_;
     std::unique_ptr<Network> network_;  // Riferimento alla rete di comunicazione
-    std::vector<int> deferred_acks_;
-    int my_request_ts_{0};
-    std::mutex clock_mtx_;
+    std::unique_ptr<FailureDetector> detector_; // Heartbeat sopra network_ (nullptr se disattivato)
+    std::atomic<bool> crashed_{false};  // Guasto simulato (fault_injection in config.json)
+    std::vector<ResourceLock> resources_; // Una sezione critica per traccia (dimensione fissa)
+    std::mutex deadline_mtx_;
+    std::vector<int> lateness_ms_;        // Ritardo di ogni ingresso rispetto alla deadline (negativo = in anticipo)
 };
 
 #endif // NODE_H
\ No newline at end of file
@@ -0,0 +1,182 @@
+// Convoluzione partizionata a livelli: testa diretta e overlap-save in frequenza
+
+#include "partitioned_convolver.h"
+#include "dsp_kernels.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t LANES = 8;
+// Allineato a 32 byte anche senza -mavx, perché la variante AVX2 lo carica come tale
+typedef float Lane __attribute__((vector_size(LANES * sizeof(float)), aligned(32)));
+
+constexpr size_t HEAD = ConvolutionIr::HEAD;
+
+size_t round_up(size_t n, size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+// Prese dirette: wet[i] = somma_m h[m] x[i - m], otto uscite per volta
+// (x punta al primo campione del tratto, preceduto da HEAD - 1 campioni)
+__attribute__((always_inline)) inline void head_lanes(const float* h, const float* x, float* wet, size_t n) {
+    for (size_t i = 0; i < n; i += LANES) {
+        Lane acc{};
+        for (size_t m = 0; m < HEAD; ++m) {
+            Lane v;
+            std::memcpy(&v, x + i - m, sizeof(v));
+            acc += h[m] * v;
+        }
+        std::memcpy(wet + i, &acc, sizeof(acc));
+    }
+}
+
+// sum += X * H su stride bin, spettri separati re[stride] im[stride]
+__attribute__((always_inline)) inline void multiply_add_lanes(float* sum, const float* x, const float* h, size_t stride) {
+    for (size_t k = 0; k < stride; k += LANES) {
+        Lane sr, si, xr, xi, hr, hi;
+        std::memcpy(&sr, sum + k, sizeof(Lane));
+        std::memcpy(&si, sum + stride + k, sizeof(Lane));
+        std::memcpy(&xr, x + k, sizeof(Lane));
+        std::memcpy(&xi, x + stride + k, sizeof(Lane));
+        std::memcpy(&hr, h + k, sizeof(Lane));
+        std::memcpy(&hi, h + stride + k, sizeof(Lane));
+        sr += xr * hr - xi * hi;
+        si += xr * hi + xi * hr;
+        std::memcpy(sum + k, &sr, sizeof(Lane));
+        std::memcpy(sum + stride + k, &si, sizeof(Lane));
+    }
+}
+
+void head_generic(const float* h, const float* x, float* wet, size_t n) { head_lanes(h, x, wet, n); }
+void multiply_add_generic(float* sum, const float* x, const float* h, size_t stride) {
+    multiply_add_lanes(sum, x, h, stride);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) void head_avx2(const float* h, const float* x, float* wet, size_t n) {
+    head_lanes(h, x, wet, n);
+}
+__attribute__((target("avx2"))) void multiply_add_avx2(float* sum, const float* x, const float* h, size_t stride) {
+    multiply_add_lanes(sum, x, h, stride);
+}
+#endif
+
+void head(const float* h, const float* x, float* wet, size_t n) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (dsp_kernels().isa >= DspIsa::AVX2) return head_avx2(h, x, wet, n);
+#endif
+    head_generic(h, x, wet, n);
+}
+
+void multiply_add(float* sum, const float* x, const float* h, size_t stride) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (dsp_kernels().isa >= DspIsa::AVX2) return multiply_add_avx2(sum, x, h, stride);
+#endif
+    multiply_add_generic(sum, x, h, stride);
+}
+
+}  // namespace
+
+ConvolutionIr::ConvolutionIr(const AudioBuffer& ir) : channels_(ir.channels()), length_(ir.frames()) {
+    // Livelli: il blocco B copre le prese [B, 4B), l'ultimo (MAX_BLOCK) tutte le rimanenti
+    for (size_t block = HEAD; block < length_; block *= 4) {
+        size_t end = block == MAX_BLOCK ? length_ : std::min(length_, 4 * block);
+        Tier tier;
+        tier.block = block;
+        tier.partitions = (end - block + block - 1) / block;
+        tier.stride = round_up(block + 1, LANES);
+        tiers_.push_back(std::move(tier));
+        if (block == MAX_BLOCK) break;
+    }
+
+    head_.assign(channels_, std::vector<float>(HEAD, 0.0f));
+    for (int c = 0; c < channels_; ++c) {
+        const float* h = ir.channel(c);
+        std::copy(h, h + std::min(HEAD, length_), head_[c].begin());
+
+        for (Tier& tier : tiers_) {
+            // Partizione p: prese [B + pB, B + (p + 1)B) seguite da B zeri
+            RealFft fft(2 * tier.block);
+            std::vector<float> padded(2 * tier.block);
+            std::vector<float> spectra(tier.partitions * 2 * tier.stride, 0.0f);
+            for (size_t p = 0; p < tier.partitions; ++p) {
+                size_t first = tier.block + p * tier.block;
+                size_t count = std::min(tier.block, length_ - first);
+                std::fill(padded.begin(), padded.end(), 0.0f);
+                std::copy(h + first, h + first + count, padded.begin());
+                float* spectrum = spectra.data() + p * 2 * tier.stride;
+                fft.forward(padded.data(), spectrum, spectrum + tier.stride);
+            }
+            tier.spectra.push_back(std::move(spectra));
+        }
+    }
+}
+
+void PartitionedConvolver::prepare(std::shared_ptr<const ConvolutionIr> ir, int ir_channel) {
+    ir_ = std::move(ir);
+    ir_channel_ = ir_channel;
+    position_ = 0;
+    history_.assign(2 * HEAD, 0.0f);
+    tiers_.clear();
+    for (const ConvolutionIr::Tier& tier : ir_->tiers_) {
+        TierState state(tier.block);
+        state.window.assign(2 * tier.block, 0.0f);
+        state.spectra.assign(tier.partitions * 2 * tier.stride, 0.0f);
+        state.sum.assign(2 * tier.stride, 0.0f);
+        state.output.assign(2 * tier.block, 0.0f);
+        tiers_.push_back(std::move(state));
+    }
+}
+
+void PartitionedConvolver::finish_block(size_t t) {
+    const ConvolutionIr::Tier& tier = ir_->tiers_[t];
+    TierState& state = tiers_[t];
+    size_t stride = tier.stride;
+
+    // Spettro degli ultimi due blocchi nell'anello, al posto del più vecchio
+    state.newest = (state.newest + 1) % tier.partitions;
+    float* spectrum = state.spectra.data() + state.newest * 2 * stride;
+    state.fft.forward(state.window.data(), spectrum, spectrum + stride);
+
+    // Y = somma_p X(blocco k - p) * H(partizione p)
+    std::fill(state.sum.begin(), state.sum.end(), 0.0f);
+    const float* h = tier.spectra[ir_channel_].data();
+    for (size_t p = 0; p < tier.partitions; ++p) {
+        size_t slot = (state.newest + tier.partitions - p) % tier.partitions;
+        multiply_add(state.sum.data(), state.spectra.data() + slot * 2 * stride, h + p * 2 * stride, stride);
+    }
+    state.fft.inverse(state.sum.data(), state.sum.data() + stride, state.output.data());
+
+    // Il blocco appena finito diventa la prima metà della finestra
+    std::copy(state.window.begin() + tier.block, state.window.end(), state.window.begin());
+}
+
+void PartitionedConvolver::process(float* samples, size_t frames, float mix) {
+    const float* h = ir_->head_[ir_channel_].data();
+    alignas(32) float wet[HEAD];
+    float* current = history_.data() + HEAD - 1;
+    while (frames > 0) {
+        // Tratti entro un blocco di HEAD: nessun livello finisce un blocco a metà tratto
+        size_t n = std::min(frames, HEAD - position_ % HEAD);
+        std::copy(samples, samples + n, current);
+
+        head(h, current, wet, n);
+        for (size_t t = 0; t < tiers_.size(); ++t) {
+            TierState& state = tiers_[t];
+            size_t block = ir_->tiers_[t].block;
+            size_t offset = position_ % block;
+            const float* out = state.output.data() + block + offset;
+            for (size_t i = 0; i < n; ++i) wet[i] += out[i];
+            std::copy(samples, samples + n, state.window.begin() + block + offset);
+            if (offset + n == block) finish_block(t);
+        }
+        for (size_t i = 0; i < n; ++i) samples[i] += mix * wet[i];
+
+        // Restano gli ultimi HEAD - 1 campioni asciutti
+        std::copy(history_.begin() + n, history_.begin() + n + HEAD - 1, history_.begin());
+        position_ += n;
+        samples += n;
+        frames -= n;
+    }
+}
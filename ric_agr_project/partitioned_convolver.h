@@ -0,0 +1,81 @@
+// Convoluzione con risposte all'impulso lunghe (riverbero a convoluzione),
+// senza latenza e a costo quasi costante per campione: le prime HEAD prese
+// sono una convoluzione diretta, il resto è diviso in livelli di partizioni
+// uniformi con blocchi sempre più grandi (64, 256, 1024, ... MAX_BLOCK),
+// ognuno calcolato in frequenza con overlap-save e una linea di ritardo di
+// spettri. Un livello con blocco B inizia alla presa B: il suo blocco di
+// ritardo è coperto dalle prese precedenti.
+//
+// ConvolutionIr contiene gli spettri delle partizioni, calcolati una volta
+// per risposta e mai modificati: più convolutori (canali, grafi, nodi) la
+// condividono tramite shared_ptr.
+
+#ifndef PARTITIONED_CONVOLVER_H
+#define PARTITIONED_CONVOLVER_H
+
+#include "audio_buffer.h"
+#include "fft.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class ConvolutionIr {
+public:
+    static constexpr size_t HEAD = 64;          // Prese in convoluzione diretta (= primo blocco)
+    static constexpr size_t MAX_BLOCK = 16384;  // Blocco dell'ultimo livello
+
+    // Un canale di risposta per canale di ir, alla frequenza del segnale
+    explicit ConvolutionIr(const AudioBuffer& ir);
+
+    int channels() const { return channels_; }
+    size_t length() const { return length_; }
+
+private:
+    friend class PartitionedConvolver;
+
+    struct Tier {
+        size_t block;        // Prese per partizione; FFT di 2 * block punti
+        size_t partitions;
+        size_t stride;       // Float per metà spettro (bin arrotondati a 8)
+        // Per canale: partitions spettri, ognuno re[stride] seguito da im[stride]
+        std::vector<std::vector<float>> spectra;
+    };
+
+    std::vector<std::vector<float>> head_;   // Per canale, HEAD prese
+    std::vector<Tier> tiers_;
+    int channels_;
+    size_t length_;
+};
+
+// Convoluzione di un canale con un canale di ConvolutionIr
+class PartitionedConvolver {
+public:
+    // Inizio del flusso: usa il canale ir_channel della risposta, stato azzerato
+    void prepare(std::shared_ptr<const ConvolutionIr> ir, int ir_channel);
+
+    // Elabora in place frames campioni consecutivi: a ogni campione si somma
+    // mix volte la sua convoluzione con la risposta
+    void process(float* samples, size_t frames, float mix);
+
+private:
+    struct TierState {
+        explicit TierState(size_t block) : fft(2 * block) {}
+        RealFft fft;
+        std::vector<float> window;     // Ultimi due blocchi di ingresso (overlap-save)
+        std::vector<float> spectra;    // Spettri degli ultimi blocchi di ingresso, in anello
+        size_t newest = 0;             // Partizione più recente nell'anello
+        std::vector<float> sum;        // Somma dei prodotti, re[stride] e im[stride]
+        std::vector<float> output;     // Uscita dell'IFFT: la seconda metà va al blocco corrente
+    };
+
+    // Fine di un blocco di ingresso del livello t: uscita per il blocco successivo
+    void finish_block(size_t t);
+
+    std::shared_ptr<const ConvolutionIr> ir_;
+    int ir_channel_ = 0;
+    std::vector<TierState> tiers_;
+    std::vector<float> history_;   // HEAD - 1 campioni precedenti, poi il tratto corrente
+    size_t position_ = 0;          // Campioni già elaborati
+};
+
+#endif // PARTITIONED_CONVOLVER_H
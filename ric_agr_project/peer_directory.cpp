@@ -0,0 +1,94 @@
+// Caricamento della directory dei peer e risoluzione degli indirizzi
+
+#include "peer_directory.h"
+#include "local_transport.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <stdexcept>
+#include <netdb.h>                // getaddrinfo per gli hostname
+#include <arpa/inet.h>            // inet_pton per gli IP numerici
+
+using json = nlohmann::json;
+
+// Risolve host (IP puntato o hostname) in un indirizzo IPv4
+static sockaddr_in resolve(const std::string& host, int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+
+    // Caso comune: IP numerico, nessuna query DNS
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1) {
+        return addr;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    int rc = getaddrinfo(host.c_str(), nullptr, &hints, &res);
+    if (rc != 0 || res == nullptr) {
+        throw std::runtime_error("Cannot resolve host " + host + ": " + gai_strerror(rc));
+    }
+    addr.sin_addr = reinterpret_cast<sockaddr_in*>(res->ai_addr)->sin_addr;
+    freeaddrinfo(res);
+    return addr;
+}
+
+PeerDirectory::PeerDirectory() : local_registry_(std::make_shared<LocalRegistry>()) {}
+
+// Legge il file e costruisce la directory
+std::shared_ptr<const PeerDirectory> PeerDirectory::load(const std::string& config_path) {
+    std::ifstream in(config_path);
+    if (!in.is_open()) {
+        throw std::runtime_error("Cannot open config file: " + config_path);
+    }
+    json j;
+    in >> j;
+    return from_json(j);
+}
+
+// Analizza la configurazione una volta sola per tutto il processo
+std::shared_ptr<const PeerDirectory> PeerDirectory::from_json(const json& config) {
+    std::shared_ptr<PeerDirectory> dir(new PeerDirectory());
+
+    // Formato dei messaggi: binario di default, testo per il debug
+    std::string format = config.value("wire_format", "binary");
+    if (format == "text") {
+        dir->wire_format_ = WireFormat::TEXT;
+    } else if (format == "binary") {
+        dir->wire_format_ = WireFormat::BINARY;
+    } else {
+        throw std::runtime_error("Unknown wire_format: " + format);
+    }
+
+    for (const auto& node : config.at("nodes")) {
+        PeerInfo info;
+        info.id = node.at("id");
+        info.host = node.at("host");
+        info.port = node.at("port");
+        info.present = true;
+
+        if (info.id < 0) {
+            throw std::runtime_error("Invalid node id: " + std::to_string(info.id));
+        }
+
+        std::string transport = node.value("transport", "tcp");
+        if (transport == "tcp") {
+            info.transport = PeerTransport::TCP;
+            info.addr = resolve(info.host, info.port);
+        } else if (transport == "local") {
+            info.transport = PeerTransport::LOCAL;
+        } else {
+            throw std::runtime_error("Unknown transport for node " + std::to_string(info.id) + ": " + transport);
+        }
+
+        if (info.id >= static_cast<int>(dir->peers_.size())) dir->peers_.resize(info.id + 1);
+        if (dir->peers_[info.id].present) {
+            throw std::runtime_error("Duplicate node id: " + std::to_string(info.id));
+        }
+        dir->peers_[info.id] = std::move(info);
+        dir->num_nodes_++;
+    }
+
+    return dir;
+}
@@ -0,0 +1,68 @@
+// Directory dei nodi del cluster: letta una sola volta da config.json,
+// immutabile e condivisa da tutti i Node del processo, che ne ricevono anche
+// il registro delle inbox per il trasporto locale
+
+#ifndef PEER_DIRECTORY_H
+#define PEER_DIRECTORY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include <nlohmann/json_fwd.hpp>
+#include "message_structs.h"
+
+class LocalRegistry;
+
+// Trasporto con cui un nodo è raggiungibile
+enum class PeerTransport {
+    TCP,     // Connessione TCP persistente
+    LOCAL    // Nodo nello stesso processo (inbox in-memory)
+};
+
+// Voce della directory: indirizzo già risolto, pronto per connect()
+struct PeerInfo {
+    int id = -1;
+    std::string host;
+    int port = 0;
+    PeerTransport transport = PeerTransport::TCP;
+    sockaddr_in addr{};
+    bool present = false;    // false per gli id non presenti in configurazione
+};
+
+class PeerDirectory {
+public:
+    // Legge e analizza il file di configurazione
+    static std::shared_ptr<const PeerDirectory> load(const std::string& config_path);
+
+    // Costruisce la directory da un JSON già analizzato
+    static std::shared_ptr<const PeerDirectory> from_json(const nlohmann::json& config);
+
+    // Accesso O(1) per id; nullptr se il nodo non esiste
+    const PeerInfo* find(int id) const {
+        if (id < 0 || id >= static_cast<int>(peers_.size()) || !peers_[id].present) return nullptr;
+        return &peers_[id];
+    }
+
+    // Tutte le voci, indicizzate per id (con eventuali buchi non presenti)
+    const std::vector<PeerInfo>& entries() const { return peers_; }
+
+    // Numero di nodi configurati
+    int num_nodes() const { return num_nodes_; }
+
+    // Formato dei messaggi sul filo
+    WireFormat wire_format() const { return wire_format_; }
+
+    // Inbox dei nodi locali di questo cluster (una directory, un registro)
+    LocalRegistry& local_registry() const { return *local_registry_; }
+
+private:
+    PeerDirectory();
+
+    std::vector<PeerInfo> peers_;   // Indicizzato direttamente per node id
+    int num_nodes_ = 0;
+    WireFormat wire_format_ = WireFormat::BINARY;
+    std::shared_ptr<LocalRegistry> local_registry_;
+};
+
+#endif // PEER_DIRECTORY_H
@@ -0,0 +1,209 @@
+#include "ricart_agrawala.h"
+#include "logger.h"
+#include "network.h"
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+using Phase = RicartAgrawalaBase::Phase;
+
+// Campi della parola di stato
+constexpr uint64_t PERMS_MASK = 0xFFFFFFFFull;
+constexpr int PHASE_SHIFT = 32;
+constexpr uint64_t PHASE_MASK = 3ull << PHASE_SHIFT;
+constexpr uint64_t SHARED_BIT = 1ull << 34;
+constexpr int DEFERRED_SHIFT = 35;
+constexpr uint64_t DEFERRED_MASK = 0xFFull << DEFERRED_SHIFT;
+constexpr int GEN_SHIFT = 43;
+
+Phase phase_of(uint64_t core) { return static_cast<Phase>((core & PHASE_MASK) >> PHASE_SHIFT); }
+uint64_t with_phase(uint64_t core, Phase phase) { return (core & ~PHASE_MASK) | (static_cast<uint64_t>(phase) << PHASE_SHIFT); }
+int deferred_of(uint64_t core) { return static_cast<int>((core & DEFERRED_MASK) >> DEFERRED_SHIFT); }
+uint64_t next_generation(uint64_t core) { return ((core >> GEN_SHIFT) + 1) << GEN_SHIFT; }
+LockMode mode_of(uint64_t core) { return (core & SHARED_BIT) ? LockMode::SHARED : LockMode::EXCLUSIVE; }
+uint64_t bit(int node) { return 1ull << node; }
+
+uint64_t pack_request(int ts, int deadline) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(deadline)) << 32) | static_cast<uint32_t>(ts);
+}
+int ts_of(uint64_t request) { return static_cast<int32_t>(static_cast<uint32_t>(request)); }
+int deadline_of(uint64_t request) { return static_cast<int32_t>(static_cast<uint32_t>(request >> 32)); }
+
+}  // namespace
+
+RicartAgrawala::RicartAgrawala(const ProtocolContext& ctx)
+    : RicartAgrawalaBase(ctx) {
+    if (ctx_.num_nodes > MAX_NODES) {
+        throw std::invalid_argument("ricart_agrawala supports at most " + std::to_string(MAX_NODES) + " nodes");
+    }
+    peers_mask_ = (bit(ctx_.num_nodes) - 1) & ~bit(ctx_.id);
+}
+
+bool RicartAgrawala::acquire(int deadline_ms, LockMode mode, std::chrono::steady_clock::time_point give_up_at) {
+    mode = effective_mode(mode);
+
+    int request_ts = ctx_.clock->tick();  // 🔥 fondamentale
+    uint64_t my_request = pack_request(request_ts, deadline_ms);
+    request_.store(my_request);
+
+    // Pubblica la richiesta: nuova generazione, i permessi già ottenuti restano
+    uint64_t old = core_.load();
+    uint64_t next;
+    do {
+        next = (old & PERMS_MASK) | with_phase(0, REQUESTING) |
+               (mode == LockMode::SHARED ? SHARED_BIT : 0) | next_generation(old);
+    } while (!core_.compare_exchange_weak(old, next));
+
+    Logger::log_request(ctx_.id, request_ts, ctx_.resource_id);  // Logga la richiesta
+
+    // Serve una REQUEST solo verso i peer di cui non abbiamo già il permesso
+    // (in Ricart-Agrawala puro i permessi vengono azzerati a ogni rilascio)
+    uint64_t missing = peers_mask_ & ~old;
+    if (missing == 0) {
+        // Roucairol-Carvalho: tutti i permessi sono ancora validi, nessun messaggio
+        ctx_.stats->free_entries.fetch_add(1);
+    } else if (missing == peers_mask_) {
+        // Invia il messaggio a tutti gli altri nodi in parallelo
+        ctx_.network->broadcast(request_message(own_request(next)));
+        ctx_.stats->requests.fetch_add(ctx_.num_nodes - 1);
+    } else {
+        OwnRequest own = own_request(next);
+        for (int i = 0; i < ctx_.num_nodes; ++i) {
+            if (missing & bit(i)) send_request(i, own);
+        }
+    }
+
+    // Aspetta il permesso di tutti gli altri nodi (o il timeout): l'ingresso è
+    // una CAS REQUESTING -> IN_CS, che fallisce se nel frattempo un permesso è stato ceduto
+    while (true) {
+        uint32_t key = permissions_changed_.prepare_wait();
+        uint64_t core = core_.load();
+        if (holds_all_permissions(core)) {
+            permissions_changed_.cancel_wait();
+            if (core_.compare_exchange_strong(core, with_phase(core, IN_CS))) return true;
+            continue;
+        }
+        if (!permissions_changed_.wait(key, give_up_at)) {
+            // Richiesta ritirata: chi abbiamo fatto attendere riceve subito l'ACK
+            leave(false);
+            return false;
+        }
+    }
+}
+
+void RicartAgrawala::release() {
+    leave(true);
+}
+
+void RicartAgrawala::leave(bool entered) {
+    int release_clock = ctx_.clock->tick();
+
+    // Torna IDLE; in Ricart-Agrawala puro i permessi valgono per un solo ingresso
+    uint64_t old = core_.load();
+    uint64_t next;
+    do {
+        uint64_t perms = ctx_.options.permission_reuse ? (old & PERMS_MASK) : 0;
+        next = perms | with_phase(0, IDLE) | next_generation(old);
+    } while (!core_.compare_exchange_weak(old, next));
+
+    // I peer differiti sono esattamente quelli prenotati nella parola di stato:
+    // il thread di ricezione può essere ancora tra la CAS e il bit, lo si attende
+    int reserved = deferred_of(old);
+    while (__builtin_popcountll(deferred_.load()) != reserved) std::this_thread::yield();
+    uint64_t granted = deferred_.exchange(0);
+
+    // Chi riceve un ACK differito ottiene il nostro permesso: lo perdiamo
+    if (granted) core_.fetch_and(~granted);
+
+    // Con il riuso dei permessi il RELEASE non serve: basta l'ACK differito
+    if (entered && !ctx_.options.permission_reuse) broadcast_release(release_clock);
+
+    // Invia gli ACK differiti
+    for (int peer = 0; peer < ctx_.num_nodes; ++peer) {
+        if (granted & bit(peer)) send_ack(peer, release_clock, deferred_ts_[peer].load());
+    }
+}
+
+RicartAgrawala::OwnRequest RicartAgrawala::own_request(uint64_t core) const {
+    uint64_t request = request_.load();
+    OwnRequest own;
+    own.phase = phase_of(core);
+    own.ts = ts_of(request);
+    own.deadline = deadline_of(request);
+    own.mode = mode_of(core);
+    return own;
+}
+
+bool RicartAgrawala::holds_all_permissions(uint64_t core) const {
+    if (phase_of(core) != REQUESTING) return false;
+    return ((core | suspected_.load()) & peers_mask_) == peers_mask_;
+}
+
+void RicartAgrawala::on_message(const Message& received_msg) {
+    // Aggiorna clock
+    int ack_clock = ctx_.clock->update(received_msg.logical_clock);
+
+    // Elabora la logica per ciascun tipo di messaggio
+    if (received_msg.type == MessageType::REQUEST) {
+        handle_request(received_msg, ack_clock);
+    } else if (received_msg.type == MessageType::ACK) {
+        // La CAS lega la validità dell'ACK alla richiesta su cui è stata decisa
+        uint64_t sender_bit = bit(received_msg.sender_id);
+        uint64_t core = core_.load();
+        do {
+            if (!accepts_ack(received_msg, own_request(core))) return;
+        } while (!core_.compare_exchange_weak(core, core | sender_bit));
+        Logger::log_ack_received(ctx_.id);
+        permissions_changed_.notify_all();
+    }
+}
+
+void RicartAgrawala::handle_request(const Message& request, int ack_clock) {
+    int sender = request.sender_id;
+    uint64_t sender_bit = bit(sender);
+
+    while (true) {
+        uint64_t core = core_.load();
+        OwnRequest own = own_request(core);
+        Reply reply = reply_to(request, own);
+
+        if (reply == Reply::DEFER) {
+            // Un bit per peer: una REQUEST ripetuta (peer riammesso, o che richiede
+            // di nuovo) aggiorna solo il timestamp da riportare nell'ACK, quindi le
+            // prenotazioni non superano mai i peer del cluster. La CAS convalida la
+            // decisione: se nel frattempo la richiesta è stata rilasciata fallisce e
+            // la decisione viene ripetuta (al più un ACK doppio, innocuo).
+            deferred_ts_[sender].store(request.logical_clock);
+            bool reserved = deferred_.load() & sender_bit;
+            uint64_t next = reserved ? core : core + (1ull << DEFERRED_SHIFT);
+            if (!core_.compare_exchange_weak(core, next)) continue;
+            if (!reserved) deferred_.fetch_or(sender_bit);
+            return;
+        }
+
+        // GRANT: il permesso passa al mittente, con una CAS sulla stessa parola
+        // su cui è stata presa la decisione
+        if (reply == Reply::GRANT && !core_.compare_exchange_weak(core, core & ~sender_bit)) continue;
+
+        send_ack(sender, ack_clock, request.logical_clock);
+        if (must_request_again(reply, own, core & sender_bit)) send_request(sender, own);
+        return;
+    }
+}
+
+void RicartAgrawala::on_peer_down(int peer) {
+    suspected_.fetch_or(bit(peer));
+    // L'insieme dei permessi richiesti si è ridotto: l'attesa può essere finita
+    permissions_changed_.notify_all();
+}
+
+void RicartAgrawala::on_peer_up(int peer) {
+    suspected_.fetch_and(~bit(peer));
+
+    // Un peer riavviato non ricorda i permessi concessi: si richiedono di nuovo
+    uint64_t core = ctx_.options.permission_reuse ? core_.fetch_and(~bit(peer)) & ~bit(peer) : core_.load();
+
+    // La nostra REQUEST può essere andata persa mentre era sospettato
+    if (phase_of(core) == REQUESTING && !(core & bit(peer))) send_request(peer, own_request(core));
+}
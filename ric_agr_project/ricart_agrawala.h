@@ -0,0 +1,60 @@
+// Ricart-Agrawala, con la variante opzionale di Roucairol-Carvalho (riuso dei permessi)
+// e la variante lettori-scrittori: due richieste SHARED si concedono l'ACK a vicenda.
+//
+// Lo stato è lock-free: permessi per peer, fase della richiesta e numero di ACK
+// differiti stanno in un'unica parola atomica, così l'ingresso in sezione critica
+// e le decisioni del thread di ricezione (concedere o differire) si serializzano
+// con una CAS. Gli ACK differiti sono un bit per peer (con il timestamp della sua
+// ultima richiesta), raccolti al rilascio. Le regole del protocollo sono in
+// RicartAgrawalaBase, condivise con la versione con mutex.
+
+#ifndef RICART_AGRAWALA_H
+#define RICART_AGRAWALA_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "event_count.h"
+#include "ricart_agrawala_base.h"
+
+class RicartAgrawala : public RicartAgrawalaBase {
+public:
+    // Massimo numero di nodi: un bit di permesso per nodo nella parola di stato
+    // (make_mutex_protocol usa RicartAgrawalaLocked per i cluster più grandi)
+    static constexpr int MAX_NODES = 32;
+
+    explicit RicartAgrawala(const ProtocolContext& ctx);
+
+    bool acquire(int deadline_ms, LockMode mode, std::chrono::steady_clock::time_point give_up_at) override;
+    void release() override;
+    void on_message(const Message& message) override;
+    void on_peer_down(int peer) override;
+    void on_peer_up(int peer) override;
+
+private:
+    // Richiesta del nodo secondo la parola di stato core e la richiesta corrente
+    OwnRequest own_request(uint64_t core) const;
+
+    // true se lo stato contiene il permesso di tutti i peer non sospettati
+    bool holds_all_permissions(uint64_t core) const;
+
+    // Gestisce una REQUEST: concede l'ACK o lo differisce (senza lock)
+    void handle_request(const Message& request, int ack_clock);
+
+    // Chiude la richiesta corrente e invia gli ACK differiti; il RELEASE
+    // solo se la sezione critica era stata davvero concessa
+    void leave(bool entered);
+
+    uint64_t peers_mask_;                       // Bit di permesso di tutti i peer (escluso se stesso)
+
+    // Parola di stato: [0..31] permessi per peer, [32..33] fase, [34] SHARED,
+    // [35..42] peer con ACK differito prenotati, [43..63] generazione (cambia a ogni richiesta)
+    std::atomic<uint64_t> core_{0};
+    std::atomic<uint64_t> request_{0};          // Richiesta corrente: (deadline << 32) | timestamp
+    std::atomic<uint64_t> suspected_{0};        // Peer sospettati guasti: il loro permesso non si attende
+    std::atomic<uint64_t> deferred_{0};         // Peer con ACK differito (scritto dal thread di ricezione)
+    std::array<std::atomic<int>, MAX_NODES> deferred_ts_{}; // Timestamp da riportare nell'ACK differito
+    EventCount permissions_changed_;            // Risveglia acquire() all'arrivo degli ACK
+};
+
+#endif // RICART_AGRAWALA_H
@@ -0,0 +1,70 @@
+#include "ricart_agrawala_base.h"
+#include "network.h"
+#include <iostream>
+
+LockMode RicartAgrawalaBase::effective_mode(LockMode mode) const {
+    return ctx_.options.permission_reuse ? LockMode::EXCLUSIVE : mode;
+}
+
+// Ordinamento totale delle richieste: con priority "edf" prima la deadline più
+// vicina (una richiesta con deadline precede una senza), poi timestamp di Lamport
+// e ID del nodo. Entrambi i nodi confrontano le stesse chiavi: l'ordine è coerente.
+bool RicartAgrawalaBase::has_priority(const Message& request, const OwnRequest& own) const {
+    if (ctx_.options.priority == "edf" && request.deadline_ms != own.deadline) {
+        if (request.deadline_ms == 0) return false;
+        if (own.deadline == 0) return true;
+        return deadline_before(request.deadline_ms, own.deadline);
+    }
+    int ts = request.logical_clock, sender = request.sender_id;
+    return ts < own.ts || (ts == own.ts && sender < ctx_.id);
+}
+
+// L'ACK si differisce dentro la sezione critica, o in attesa con una richiesta
+// che ha priorità su quella ricevuta. Due letture sono compatibili e non si
+// differiscono mai; una lettura arrivata dopo uno scrittore in attesa resta
+// invece differita da lui (niente starvation). L'ACK di un lettore a un altro
+// lettore non toglie nulla: i due possono entrare insieme e il permesso
+// ricevuto resta valido (cederlo e richiederlo farebbe rimbalzare le REQUEST
+// tra due lettori in attesa).
+RicartAgrawalaBase::Reply RicartAgrawalaBase::reply_to(const Message& request, const OwnRequest& own) const {
+    if (own.phase == IDLE) return Reply::GRANT;
+    if (own.mode == LockMode::SHARED && request.mode == LockMode::SHARED) return Reply::SHARE;
+    if (own.phase == IN_CS || !has_priority(request, own)) return Reply::DEFER;
+    return Reply::GRANT;
+}
+
+// Ricart-Agrawala puro: un ACK vale solo per la richiesta a cui risponde.
+// Quello di una richiesta ritirata per timeout arriva in ritardo e va scartato.
+// Con il riuso dei permessi ogni ACK concede il permesso fino a nuova REQUEST.
+bool RicartAgrawalaBase::accepts_ack(const Message& ack, const OwnRequest& own) const {
+    if (ctx_.options.permission_reuse) return true;
+    return own.phase == REQUESTING && ack.request_ts == own.ts;
+}
+
+Message RicartAgrawalaBase::request_message(const OwnRequest& own) const {
+    Message request(MessageType::REQUEST, ctx_.id, own.ts, own.deadline, ctx_.resource_id);
+    request.mode = own.mode;
+    return request;
+}
+
+void RicartAgrawalaBase::send_request(int target, const OwnRequest& own) {
+    ctx_.network->send_message(target, request_message(own));
+    ctx_.stats->requests.fetch_add(1);
+}
+
+// L'ACK riporta il timestamp della richiesta a cui risponde
+void RicartAgrawalaBase::send_ack(int target, int clock, int request_ts) {
+    Message ack_message(MessageType::ACK, ctx_.id, clock, 0, ctx_.resource_id);
+    ack_message.request_ts = request_ts;
+    ctx_.network->send_message(target, ack_message);
+    ctx_.stats->acks.fetch_add(1);
+}
+
+void RicartAgrawalaBase::broadcast_release(int clock) {
+    std::cout << "[Node " << ctx_.id << "] Sending RELEASE with clock: " << clock << std::endl;
+
+    // Prepara il messaggio RELEASE e lo invia a tutti gli altri nodi
+    Message release_message(MessageType::RELEASE, ctx_.id, clock, 0, ctx_.resource_id);
+    ctx_.network->broadcast(release_message);
+    ctx_.stats->releases.fetch_add(ctx_.num_nodes - 1);
+}
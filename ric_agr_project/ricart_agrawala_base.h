@@ -0,0 +1,72 @@
+// Regole di Ricart-Agrawala comuni alla versione lock-free (RicartAgrawala) e a
+// quella con mutex (RicartAgrawalaLocked): ordine delle richieste, risposta a
+// una REQUEST, validità di un ACK e messaggi inviati. Le due sottoclassi
+// differiscono solo per come conservano lo stato della richiesta.
+
+#ifndef RICART_AGRAWALA_BASE_H
+#define RICART_AGRAWALA_BASE_H
+
+#include <cstdint>
+#include "mutex_protocol.h"
+
+class RicartAgrawalaBase : public MutexProtocol {
+public:
+    const char* name() const override { return "ricart_agrawala"; }
+
+    // Fase della richiesta del nodo (i valori entrano nella parola di stato lock-free)
+    enum Phase : uint64_t { IDLE = 0, REQUESTING = 1, IN_CS = 2 };
+
+    // Istantanea della richiesta del nodo, letta dallo stato della sottoclasse
+    struct OwnRequest {
+        Phase phase = IDLE;
+        int ts = 0;                            // Timestamp di Lamport
+        int deadline = 0;                      // 0 = nessuna deadline
+        LockMode mode = LockMode::EXCLUSIVE;
+    };
+
+    // Risposta a una REQUEST ricevuta
+    enum class Reply {
+        DEFER,   // ACK al rilascio: siamo dentro, o la nostra richiesta ha priorità
+        GRANT,   // ACK subito: il nostro permesso passa al mittente
+        SHARE    // ACK subito tra due letture: il permesso resta valido anche per noi
+    };
+
+protected:
+    explicit RicartAgrawalaBase(const ProtocolContext& ctx) : ctx_(ctx) {}
+
+    // Modalità effettiva di una richiesta: con il riuso dei permessi ogni lettura
+    // è esclusiva (un permesso passato a un altro lettore gli consentirebbe poi
+    // di scrivere senza chiedere a chi sta ancora leggendo)
+    LockMode effective_mode(LockMode mode) const;
+
+    // true se la richiesta ricevuta precede la nostra richiesta own
+    bool has_priority(const Message& request, const OwnRequest& own) const;
+
+    // Risposta a request dato lo stato own
+    Reply reply_to(const Message& request, const OwnRequest& own) const;
+
+    // Dopo un GRANT la nostra REQUEST va rimandata al mittente se eravamo in
+    // attesa e avevamo già il suo permesso
+    static bool must_request_again(Reply reply, const OwnRequest& own, bool had_permission) {
+        return reply == Reply::GRANT && own.phase == REQUESTING && had_permission;
+    }
+
+    // true se l'ACK ricevuto concede il permesso per la richiesta own
+    bool accepts_ack(const Message& ack, const OwnRequest& own) const;
+
+    // REQUEST della richiesta own
+    Message request_message(const OwnRequest& own) const;
+
+    // Invia la REQUEST della richiesta own a un solo peer
+    void send_request(int target, const OwnRequest& own);
+
+    // Invia l'ACK alla richiesta con timestamp request_ts
+    void send_ack(int target, int clock, int request_ts);
+
+    // Invia il RELEASE a tutti i peer (non serve con il riuso dei permessi)
+    void broadcast_release(int clock);
+
+    ProtocolContext ctx_;
+};
+
+#endif // RICART_AGRAWALA_BASE_H
@@ -0,0 +1,153 @@
+#include "ricart_agrawala_locked.h"
+#include "logger.h"
+#include "network.h"
+#include <algorithm>
+
+RicartAgrawalaLocked::RicartAgrawalaLocked(const ProtocolContext& ctx)
+    : RicartAgrawalaBase(ctx), permissions_(ctx.num_nodes, false), suspected_(ctx.num_nodes, false),
+      deferred_(ctx.num_nodes, false), deferred_ts_(ctx.num_nodes, 0) {}
+
+bool RicartAgrawalaLocked::acquire(int deadline_ms, LockMode mode, std::chrono::steady_clock::time_point give_up_at) {
+    std::vector<int> targets;
+    OwnRequest own;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        own_.phase = REQUESTING;
+        own_.ts = ctx_.clock->tick();  // 🔥 fondamentale
+        own_.deadline = deadline_ms;
+        own_.mode = effective_mode(mode);
+        own = own_;
+
+        // Serve una REQUEST solo verso i peer di cui non abbiamo già il permesso
+        // (in Ricart-Agrawala puro i permessi vengono azzerati a ogni rilascio)
+        for (int i = 0; i < ctx_.num_nodes; ++i) {
+            if (i != ctx_.id && !permissions_[i]) targets.push_back(i);
+        }
+    }
+
+    Logger::log_request(ctx_.id, own.ts, ctx_.resource_id);  // Logga la richiesta
+
+    if (targets.empty()) {
+        // Roucairol-Carvalho: tutti i permessi sono ancora validi, nessun messaggio
+        ctx_.stats->free_entries.fetch_add(1);
+    } else if (static_cast<int>(targets.size()) == ctx_.num_nodes - 1) {
+        // Invia il messaggio a tutti gli altri nodi in parallelo
+        ctx_.network->broadcast(request_message(own));
+        ctx_.stats->requests.fetch_add(static_cast<long>(targets.size()));
+    } else {
+        for (int target : targets) send_request(target, own);
+    }
+
+    // Aspetta il permesso di tutti gli altri nodi (o il timeout)
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (!wait_or_give_up(cv_, lock, give_up_at, [this] { return holds_all_permissions(); })) {
+        // Richiesta ritirata: chi abbiamo fatto attendere riceve subito l'ACK
+        lock.unlock();
+        leave(false);
+        return false;
+    }
+    own_.phase = IN_CS;
+    return true;
+}
+
+void RicartAgrawalaLocked::release() {
+    leave(true);
+}
+
+void RicartAgrawalaLocked::leave(bool entered) {
+    int release_clock;
+    std::vector<std::pair<int, int>> deferred;   // (peer, timestamp della sua richiesta)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        own_.phase = IDLE;
+        release_clock = ctx_.clock->tick();
+
+        // Chi riceve un ACK differito ottiene il nostro permesso: lo perdiamo
+        for (int peer = 0; peer < ctx_.num_nodes; ++peer) {
+            if (!deferred_[peer]) continue;
+            deferred.emplace_back(peer, deferred_ts_[peer]);
+            deferred_[peer] = false;
+            permissions_[peer] = false;
+        }
+
+        // Ricart-Agrawala puro: i permessi valgono per un solo ingresso
+        if (!ctx_.options.permission_reuse) {
+            std::fill(permissions_.begin(), permissions_.end(), false);
+        }
+    }
+
+    // Con il riuso dei permessi il RELEASE non serve: basta l'ACK differito
+    if (entered && !ctx_.options.permission_reuse) broadcast_release(release_clock);
+
+    // Invia gli ACK differiti
+    for (const auto& [peer, ts] : deferred) send_ack(peer, release_clock, ts);
+}
+
+bool RicartAgrawalaLocked::holds_all_permissions() const {
+    if (own_.phase != REQUESTING) return false;
+    for (int i = 0; i < ctx_.num_nodes; ++i) {
+        if (i != ctx_.id && !permissions_[i] && !suspected_[i]) return false;
+    }
+    return true;
+}
+
+void RicartAgrawalaLocked::on_message(const Message& received_msg) {
+    // Aggiorna clock
+    int ack_clock = ctx_.clock->update(received_msg.logical_clock);
+
+    // Elabora la logica per ciascun tipo di messaggio
+    if (received_msg.type == MessageType::REQUEST) {
+        int sender = received_msg.sender_id;
+        OwnRequest own;
+        bool request_again;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            own = own_;
+            Reply reply = reply_to(received_msg, own);
+            if (reply == Reply::DEFER) {
+                // Una REQUEST ripetuta (peer riammesso) aggiorna solo il timestamp
+                deferred_[sender] = true;
+                deferred_ts_[sender] = received_msg.logical_clock;
+                return;
+            }
+            request_again = must_request_again(reply, own, permissions_[sender]);
+            if (reply == Reply::GRANT) permissions_[sender] = false;
+        }
+
+        send_ack(sender, ack_clock, received_msg.logical_clock);
+        if (request_again) send_request(sender, own);
+    } else if (received_msg.type == MessageType::ACK) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!accepts_ack(received_msg, own_)) return;
+            permissions_[received_msg.sender_id] = true;
+        }
+        Logger::log_ack_received(ctx_.id);
+        cv_.notify_all();
+    }
+}
+
+void RicartAgrawalaLocked::on_peer_down(int peer) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        suspected_[peer] = true;
+    }
+    // L'insieme dei permessi richiesti si è ridotto: l'attesa può essere finita
+    cv_.notify_all();
+}
+
+void RicartAgrawalaLocked::on_peer_up(int peer) {
+    bool request_again = false;
+    OwnRequest own;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        suspected_[peer] = false;
+        // Un peer riavviato non ricorda i permessi concessi: si richiedono di nuovo
+        if (ctx_.options.permission_reuse) permissions_[peer] = false;
+
+        // La nostra REQUEST può essere andata persa mentre era sospettato
+        request_again = own_.phase == REQUESTING && !permissions_[peer];
+        own = own_;
+    }
+    if (request_again) send_request(peer, own);
+}
@@ -0,0 +1,42 @@
+// Ricart-Agrawala con lo stato protetto da un mutex, per i cluster con più di
+// RicartAgrawala::MAX_NODES nodi (i permessi non stanno in una parola atomica).
+// Stesso protocollo e stesse varianti della versione lock-free: riuso dei
+// permessi (Roucairol-Carvalho), priorità EDF e accesso condiviso in lettura,
+// con le regole condivise di RicartAgrawalaBase.
+
+#ifndef RICART_AGRAWALA_LOCKED_H
+#define RICART_AGRAWALA_LOCKED_H
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "ricart_agrawala_base.h"
+
+class RicartAgrawalaLocked : public RicartAgrawalaBase {
+public:
+    explicit RicartAgrawalaLocked(const ProtocolContext& ctx);
+
+    bool acquire(int deadline_ms, LockMode mode, std::chrono::steady_clock::time_point give_up_at) override;
+    void release() override;
+    void on_message(const Message& message) override;
+    void on_peer_down(int peer) override;
+    void on_peer_up(int peer) override;
+
+private:
+    // true se abbiamo il permesso di tutti i peer non sospettati (chiamata con mtx_ acquisito)
+    bool holds_all_permissions() const;
+
+    // Chiude la richiesta corrente e invia gli ACK differiti; il RELEASE
+    // solo se la sezione critica era stata davvero concessa
+    void leave(bool entered);
+
+    std::mutex mtx_;                    // Protegge tutto lo stato sottostante
+    std::condition_variable cv_;        // Risveglia acquire() all'arrivo degli ACK
+    OwnRequest own_;                    // Richiesta corrente (fase, timestamp, deadline, modalità)
+    std::vector<bool> permissions_;     // Permesso ottenuto da ciascun peer
+    std::vector<bool> suspected_;       // Peer sospettati guasti: il loro permesso non si attende
+    std::vector<bool> deferred_;        // Peer con ACK differito (uno per peer)
+    std::vector<int> deferred_ts_;      // Timestamp da riportare nell'ACK differito
+};
+
+#endif // RICART_AGRAWALA_LOCKED_H
@@ -0,0 +1,136 @@
+#include "suzuki_kasami.h"
+#include "logger.h"
+#include "network.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Il token deve descrivere esattamente questo cluster: LN con una voce per
+// nodo e una coda di richiedenti validi, distinti e diversi dal destinatario
+bool valid_token(const Message& token, int num_nodes, int self) {
+    if (static_cast<int>(token.token_ln.size()) != num_nodes) return false;
+    std::vector<bool> queued(num_nodes, false);
+    for (int node : token.token_queue) {
+        if (node < 0 || node >= num_nodes || node == self || queued[node]) return false;
+        queued[node] = true;
+    }
+    return true;
+}
+
+}  // namespace
+
+SuzukiKasami::SuzukiKasami(const ProtocolContext& ctx)
+    : ctx_(ctx), has_token_(ctx.id == 0), rn_(*ctx.rn), ln_(ctx.num_nodes, 0),
+      suspected_(ctx.num_nodes, false) {}
+
+bool SuzukiKasami::acquire(int deadline_ms, LockMode /*mode*/, std::chrono::steady_clock::time_point give_up_at) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    requesting_ = true;
+    if (has_token_) {
+        // Il token è già qui: nessun messaggio
+        in_cs_ = true;
+        ctx_.stats->free_entries.fetch_add(1);
+        return true;
+    }
+
+    // Il numero di sequenza della richiesta viaggia nel campo del clock
+    int sn = ++rn_[ctx_.id];
+    ctx_.clock->tick();
+    Logger::log_request(ctx_.id, sn, ctx_.resource_id);
+
+    ctx_.network->broadcast(Message(MessageType::REQUEST, ctx_.id, sn, deadline_ms, ctx_.resource_id));
+    ctx_.stats->requests.fetch_add(ctx_.num_nodes - 1);
+
+    if (!wait_or_give_up(cv_, lock, give_up_at, [this] { return has_token_; })) {
+        // Richiesta ritirata: se il token arriva più tardi viene subito ceduto
+        requesting_ = false;
+        return false;
+    }
+    in_cs_ = true;
+    return true;
+}
+
+void SuzukiKasami::release() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    requesting_ = false;
+    in_cs_ = false;
+    ctx_.clock->tick();
+    pass_token();
+}
+
+void SuzukiKasami::pass_token() {
+    // La nostra richiesta è servita; si accodano i nodi con una richiesta pendente
+    ln_[ctx_.id] = rn_[ctx_.id];
+    for (int i = 0; i < ctx_.num_nodes; ++i) {
+        if (i != ctx_.id && rn_[i] == ln_[i] + 1 &&
+            std::find(queue_.begin(), queue_.end(), i) == queue_.end()) {
+            queue_.push_back(i);
+        }
+    }
+
+    // I nodi sospettati guasti perderebbero il token: si saltano
+    while (!queue_.empty() && suspected_[queue_.front()]) queue_.pop_front();
+    if (!queue_.empty()) {
+        int next = queue_.front();
+        queue_.pop_front();
+        send_token(next);
+    }
+}
+
+void SuzukiKasami::on_message(const Message& message) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (message.type == MessageType::REQUEST) {
+        int sender = message.sender_id;
+        rn_[sender] = std::max(rn_[sender], message.logical_clock);
+
+        // Token inattivo e richiesta non ancora servita: passa subito al richiedente
+        if (has_token_ && !in_cs_ && !requesting_ && rn_[sender] == ln_[sender] + 1) {
+            send_token(sender);
+        }
+    } else if (message.type == MessageType::TOKEN) {
+        if (!valid_token(message, ctx_.num_nodes, ctx_.id)) {
+            std::cerr << "[Node " << ctx_.id << "] Dropping malformed token from " << message.sender_id << std::endl;
+            return;
+        }
+        ctx_.clock->update(message.logical_clock);
+        ln_ = message.token_ln;
+        queue_.assign(message.token_queue.begin(), message.token_queue.end());
+        has_token_ = true;
+        Logger::log_ack_received(ctx_.id);
+        if (!requesting_) {
+            // Token di una richiesta ritirata per timeout: passa al prossimo
+            pass_token();
+        }
+        cv_.notify_all();
+    }
+}
+
+void SuzukiKasami::send_token(int target) {
+    Message token(MessageType::TOKEN, ctx_.id, ctx_.clock->now(), 0, ctx_.resource_id);
+    token.token_ln = ln_;
+    token.token_queue.assign(queue_.begin(), queue_.end());
+    has_token_ = false;
+    queue_.clear();
+
+    // Inviato con mtx_ acquisito: send_message non blocca
+    ctx_.network->send_message(target, token);
+    ctx_.stats->control.fetch_add(1);
+}
+
+void SuzukiKasami::on_peer_down(int peer) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    suspected_[peer] = true;
+}
+
+void SuzukiKasami::on_peer_up(int peer) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    suspected_[peer] = false;
+
+    // La nostra REQUEST può essere andata persa mentre era sospettato (RN usa il massimo: è idempotente)
+    if (requesting_ && !has_token_) {
+        ctx_.network->send_message(peer, Message(MessageType::REQUEST, ctx_.id, rn_[ctx_.id], 0, ctx_.resource_id));
+        ctx_.stats->requests.fetch_add(1);
+    }
+}
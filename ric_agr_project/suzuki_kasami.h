@@ -0,0 +1,45 @@
+// Algoritmo di Suzuki-Kasami: un unico token circola tra i nodi. Chi lo possiede
+// rientra in sezione critica senza messaggi, altrimenti servono N messaggi
+// (N-1 REQUEST in broadcast e il TOKEN). Se muore il nodo che possiede il
+// token, il token è perso: solo il timeout di acquire() limita l'attesa.
+
+#ifndef SUZUKI_KASAMI_H
+#define SUZUKI_KASAMI_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "mutex_protocol.h"
+
+class SuzukiKasami : public MutexProtocol {
+public:
+    explicit SuzukiKasami(const ProtocolContext& ctx);
+
+    bool acquire(int deadline_ms, LockMode mode, std::chrono::steady_clock::time_point give_up_at) override;
+    void release() override;
+    void on_message(const Message& message) override;
+    void on_peer_down(int peer) override;
+    void on_peer_up(int peer) override;
+    const char* name() const override { return "suzuki_kasami"; }
+
+private:
+    // Cede il token a target (con mtx_ acquisito)
+    void send_token(int target);
+
+    // Segna servita la nostra richiesta e cede il token al primo in coda (con mtx_ acquisito)
+    void pass_token();
+
+    ProtocolContext ctx_;
+    std::mutex mtx_;                 // Protegge tutto lo stato sottostante
+    std::condition_variable cv_;     // Risveglia acquire() all'arrivo del token
+    bool requesting_ = false;        // Richiesta in corso (o dentro la sezione critica)
+    bool in_cs_ = false;
+    bool has_token_;                 // All'avvio il token è del nodo 0
+    std::vector<int>& rn_;           // RN del nodo (in Node, accanto al clock)
+    std::vector<int> ln_;            // LN del token (valido solo con has_token_)
+    std::deque<int> queue_;          // Coda del token (valida solo con has_token_)
+    std::vector<bool> suspected_;    // Peer sospettati guasti: il token non va ceduto a loro
+};
+
+#endif // SUZUKI_KASAMI_H
@@ -0,0 +1,242 @@
+// Cache delle frasi sintetizzate (LRU in memoria + blob su disco)
+
+#include "synthesis_cache.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Intestazione dei blob: [magic][sample rate][canali][lunghezza modello]
+// [lunghezza testo][campioni], poi modello e testo, allineati a 4 byte, e i
+// campioni float. Il modello è confrontato come il testo: una chiave uguale
+// prodotta da un altro modello non restituisce la sua voce.
+constexpr uint32_t BLOB_MAGIC = 0x32434152;  // "RAC2"
+
+struct BlobHeader {
+    uint32_t magic;
+    uint32_t sample_rate;
+    uint32_t channels;
+    uint32_t model_size;
+    uint32_t text_size;
+    uint32_t reserved;
+    uint64_t samples;
+};
+
+size_t samples_offset(size_t model_size, size_t text_size) {
+    return (sizeof(BlobHeader) + model_size + text_size + 3) & ~size_t(3);
+}
+
+// read() fino a len byte, ripetuto sulle letture parziali
+bool read_exact(int fd, void* data, size_t len) {
+    char* p = static_cast<char*>(data);
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// FNV-1a a 64 bit
+uint64_t fnv1a(uint64_t hash, const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+}  // namespace
+
+SynthesisCache::SynthesisCache(std::string model, int sample_rate, size_t memory_bytes, std::string directory)
+    : model_(std::move(model)), sample_rate_(sample_rate), memory_bytes_(memory_bytes),
+      directory_(std::move(directory)) {
+    if (!directory_.empty()) {
+        std::error_code ec;
+        fs::create_directories(directory_, ec);
+        if (ec) {
+            std::cerr << "SynthesisCache: cannot create " << directory_ << ": " << ec.message()
+                      << ", disk tier disabled" << std::endl;
+            directory_.clear();
+        }
+    }
+}
+
+uint64_t SynthesisCache::key_of(const std::string& text) const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = fnv1a(hash, model_.data(), model_.size() + 1);   // Incluso il terminatore come separatore
+    hash = fnv1a(hash, &sample_rate_, sizeof(sample_rate_));
+    return fnv1a(hash, text.data(), text.size());
+}
+
+std::string SynthesisCache::blob_path(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.pcm", static_cast<unsigned long long>(key));
+    return directory_ + "/" + name;
+}
+
+std::shared_ptr<const CachedAudio> SynthesisCache::get_or_render(const std::string& text, const Render& render) {
+    uint64_t key = key_of(text);
+    std::promise<AudioPtr> promise;
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (AudioPtr audio = lookup_memory(key, text)) {
+            hits_.fetch_add(1);
+            return audio;
+        }
+
+        // Stessa frase già in sintesi per un altro nodo: si attende quella
+        auto it = in_flight_.find(text);
+        if (it != in_flight_.end()) {
+            std::shared_future<AudioPtr> pending = it->second;
+            lock.unlock();
+            coalesced_.fetch_add(1);
+            return pending.get();
+        }
+        in_flight_.emplace(text, promise.get_future().share());
+    }
+
+    // Questo thread è l'unico responsabile della chiave: disco, poi sintesi
+    AudioPtr audio;
+    try {
+        audio = load_blob(key, text);
+        if (audio) {
+            disk_hits_.fetch_add(1);
+        } else {
+            misses_.fetch_add(1);
+            auto fresh = std::make_shared<CachedAudio>();
+            if (render(*fresh)) {
+                store_blob(key, text, *fresh);
+                audio = std::move(fresh);
+            }
+        }
+    } catch (...) {
+        // Chi attende non deve restare bloccato
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            in_flight_.erase(text);
+        }
+        promise.set_value(nullptr);
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (audio) insert_memory(key, text, audio);
+        in_flight_.erase(text);
+    }
+    promise.set_value(audio);
+    return audio;
+}
+
+SynthesisCacheStats SynthesisCache::stats() const {
+    SynthesisCacheStats s;
+    s.hits = hits_.load();
+    s.disk_hits = disk_hits_.load();
+    s.misses = misses_.load();
+    s.coalesced = coalesced_.load();
+    return s;
+}
+
+SynthesisCache::AudioPtr SynthesisCache::lookup_memory(uint64_t key, const std::string& text) {
+    auto it = index_.find(key);
+    if (it == index_.end() || it->second->text != text) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second);   // Diventa la più recente
+    return it->second->audio;
+}
+
+void SynthesisCache::insert_memory(uint64_t key, const std::string& text, AudioPtr audio) {
+    size_t size = audio->samples.size() * sizeof(float) + text.size();
+    if (size > memory_bytes_) return;   // Più grande dell'intera cache: resta solo su disco
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        used_bytes_ -= it->second->audio->samples.size() * sizeof(float) + it->second->text.size();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    // Elimina le meno recenti finché la nuova voce non ci sta
+    while (used_bytes_ + size > memory_bytes_ && !lru_.empty()) {
+        const Entry& victim = lru_.back();
+        used_bytes_ -= victim.audio->samples.size() * sizeof(float) + victim.text.size();
+        index_.erase(victim.key);
+        lru_.pop_back();
+    }
+
+    lru_.push_front(Entry{key, text, std::move(audio)});
+    index_[key] = lru_.begin();
+    used_bytes_ += size;
+}
+
+SynthesisCache::AudioPtr SynthesisCache::load_blob(uint64_t key, const std::string& text) const {
+    if (directory_.empty()) return nullptr;
+
+    int fd = open(blob_path(key).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+
+    // Il blob vale solo se intestazione, modello, testo e lunghezza corrispondono;
+    // i campioni vengono letti direttamente nel buffer finale
+    AudioPtr audio;
+    struct stat st;
+    BlobHeader header;
+    if (fstat(fd, &st) == 0 && read_exact(fd, &header, sizeof(header)) && header.magic == BLOB_MAGIC &&
+        header.model_size == model_.size() && header.text_size == text.size() &&
+        samples_offset(header.model_size, header.text_size) + header.samples * sizeof(float) ==
+            static_cast<uint64_t>(st.st_size)) {
+        std::string names(samples_offset(header.model_size, header.text_size) - sizeof(header), '\0');
+        if (read_exact(fd, &names[0], names.size()) && names.compare(0, model_.size(), model_) == 0 &&
+            names.compare(model_.size(), text.size(), text) == 0) {
+            auto loaded = std::make_shared<CachedAudio>();
+            loaded->sample_rate = static_cast<int>(header.sample_rate);
+            loaded->channels = static_cast<int>(header.channels);
+            loaded->samples.resize(header.samples);
+            if (read_exact(fd, loaded->samples.data(), header.samples * sizeof(float))) audio = std::move(loaded);
+        }
+    }
+    close(fd);
+    return audio;
+}
+
+void SynthesisCache::store_blob(uint64_t key, const std::string& text, const CachedAudio& audio) const {
+    if (directory_.empty()) return;
+
+    BlobHeader header{BLOB_MAGIC, static_cast<uint32_t>(audio.sample_rate), static_cast<uint32_t>(audio.channels),
+                      static_cast<uint32_t>(model_.size()), static_cast<uint32_t>(text.size()), 0,
+                      audio.samples.size()};
+    std::string padding(samples_offset(model_.size(), text.size()) - sizeof(header) - model_.size() - text.size(),
+                        '\0');
+
+    // Scrittura su un file temporaneo e rename: un lettore vede il blob intero o nessun blob
+    std::string path = blob_path(key);
+    std::string tmp_path = path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(model_.data(), model_.size());
+        out.write(text.data(), text.size());
+        out.write(padding.data(), padding.size());
+        out.write(reinterpret_cast<const char*>(audio.samples.data()), audio.samples.size() * sizeof(float));
+        if (!out) {
+            std::cerr << "SynthesisCache: cannot write " << tmp_path << std::endl;
+            out.close();
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) fs::remove(tmp_path, ec);
+}
@@ -0,0 +1,86 @@
+// Cache delle frasi sintetizzate, indirizzata per contenuto: la chiave è un
+// hash di (testo, modello, sample rate). Primo livello: LRU in memoria dei
+// buffer già processati, limitata in byte. Secondo livello: un blob float per
+// chiave su disco, con modello e testo nell'intestazione. Richieste
+// contemporanee della stessa frase attendono un'unica sintesi.
+
+#ifndef SYNTHESIS_CACHE_H
+#define SYNTHESIS_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Audio già processato, condiviso (in sola lettura) tra cache e chiamanti
+struct CachedAudio {
+    std::vector<float> samples;
+    int sample_rate = 0;
+    int channels = 0;
+};
+
+// Contatori per il monitoraggio
+struct SynthesisCacheStats {
+    long hits = 0;          // Trovate nella LRU in memoria
+    long disk_hits = 0;     // Trovate su disco
+    long misses = 0;        // Sintetizzate
+    long coalesced = 0;     // Hanno atteso la sintesi già in corso di un altro nodo
+};
+
+class SynthesisCache {
+public:
+    using Render = std::function<bool(CachedAudio&)>;
+
+    // memory_bytes limita la LRU; directory vuota = nessun livello su disco
+    SynthesisCache(std::string model, int sample_rate, size_t memory_bytes, std::string directory);
+
+    // Restituisce l'audio della frase; se manca in entrambi i livelli lo
+    // produce con render (una sola volta per chiave). nullptr se render fallisce.
+    std::shared_ptr<const CachedAudio> get_or_render(const std::string& text, const Render& render);
+
+    SynthesisCacheStats stats() const;
+
+private:
+    using AudioPtr = std::shared_ptr<const CachedAudio>;
+
+    struct Entry {
+        uint64_t key;
+        std::string text;   // Confrontato a ogni hit: una collisione dell'hash non restituisce audio sbagliato
+        AudioPtr audio;
+    };
+
+    uint64_t key_of(const std::string& text) const;
+    std::string blob_path(uint64_t key) const;
+
+    // LRU (con mtx_ acquisito)
+    AudioPtr lookup_memory(uint64_t key, const std::string& text);
+    void insert_memory(uint64_t key, const std::string& text, AudioPtr audio);
+
+    // Livello su disco (senza lock: ogni blob viene scritto per intero e poi rinominato)
+    AudioPtr load_blob(uint64_t key, const std::string& text) const;
+    void store_blob(uint64_t key, const std::string& text, const CachedAudio& audio) const;
+
+    std::string model_;
+    int sample_rate_;
+    size_t memory_bytes_;
+    std::string directory_;
+
+    mutable std::mutex mtx_;
+    std::list<Entry> lru_;                                           // In testa la più recente
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+    size_t used_bytes_ = 0;
+    std::unordered_map<std::string, std::shared_future<AudioPtr>> in_flight_;  // Sintesi in corso per frase
+
+    std::atomic<long> hits_{0};
+    std::atomic<long> disk_hits_{0};
+    std::atomic<long> misses_{0};
+    std::atomic<long> coalesced_{0};
+};
+
+#endif // SYNTHESIS_CACHE_H
@@ -0,0 +1,455 @@
+// Trasporto TCP: connessioni persistenti per peer, un reactor epoll per invio e ricezione
+
+#include "tcp_transport.h"
+#include <iostream>               // Per output su console
+#include <sys/socket.h>           // API per socket
+#include <sys/epoll.h>            // Reactor epoll per le connessioni in ingresso
+#include <sys/eventfd.h>          // Risveglio del reactor (nuovi invii, arresto)
+#include <netinet/in.h>           // IPPROTO_TCP
+#include <netinet/tcp.h>          // TCP_NODELAY
+#include <unistd.h>               // Funzioni POSIX (close, read, etc.)
+#include <cerrno>                 // errno
+
+TcpTransport::TcpTransport(int port, WireFormat wire_format)
+    : port_(port), wire_format_(wire_format), wake_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {
+    if (wake_fd_ < 0) perror("eventfd");
+    if (epoll_fd_ < 0) perror("epoll_create1");
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    if (wake_fd_ >= 0 && epoll_fd_ >= 0 && epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+        perror("epoll_ctl");
+    }
+}
+
+// Distruttore: ferma il reactor, poi fa fallire i frame che non sono partiti
+// e chiude i socket ancora aperti
+TcpTransport::~TcpTransport() {
+    stopping_.store(true);
+    if (reactor_.joinable()) {
+        uint64_t one = 1;
+        if (write(wake_fd_, &one, sizeof(one)) < 0) perror("write(eventfd)");
+        reactor_.join();
+    }
+    for (auto& [id, conn] : connections_) {
+        finish_batch(*conn, false);
+        std::deque<OutgoingFrame> left;
+        {
+            std::lock_guard<std::mutex> lock(conn->mtx);
+            left.swap(conn->outbox);
+        }
+        for (auto& frame : left) {
+            if (frame.completion) frame.completion->complete(false);
+        }
+        if (conn->fd >= 0) close(conn->fd);
+    }
+    for (auto& [fd, buffer] : inbound_) close(fd);
+    if (server_fd_.load() >= 0) close(server_fd_.load());
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+}
+
+// Registra il peer: la connessione verrà aperta dal reactor al primo invio
+void TcpTransport::add_peer(int id, const sockaddr_in& addr) {
+    auto conn = std::make_unique<PeerConnection>();
+    conn->id = id;
+    conn->addr = addr;
+    connections_.emplace(id, std::move(conn));
+    ensure_reactor();
+}
+
+// Imposta la callback da chiamare ogni volta che viene ricevuto un frame
+void TcpTransport::set_receive_callback(std::function<void(std::string_view)> cb) {
+    recv_cb_ = std::move(cb);
+}
+
+void TcpTransport::ensure_reactor() {
+    if (!reactor_.joinable() && epoll_fd_ >= 0) reactor_ = std::thread(&TcpTransport::run_reactor, this);
+}
+
+// Avvia il server TCP per ricevere messaggi: il socket di ascolto, non
+// bloccante, viene aggiunto all'epoll del reactor che serve già gli invii
+void TcpTransport::start_server() {
+    if (server_fd_.load() >= 0) return;
+    int server_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);  // Crea un socket TCP non bloccante
+    if (server_fd == -1) {
+        perror("socket");
+        return;
+    }
+
+    int one = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;               // Accetta connessioni da qualsiasi IP
+    addr.sin_port = htons(port_);                    // Imposta la porta
+
+    if (bind(server_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(server_fd);
+        return;
+    }
+
+    if (listen(server_fd, SOMAXCONN) < 0) {           // Mette il socket in ascolto
+        perror("listen");
+        close(server_fd);
+        return;
+    }
+
+    // Prima di registrarlo: il reactor deve riconoscerlo al primo evento
+    server_fd_.store(server_fd);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = server_fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server_fd, &ev) < 0) {
+        perror("epoll_ctl");
+        server_fd_.store(-1);
+        close(server_fd);
+        return;
+    }
+
+    std::cout << "Network: server listening on port " << port_ << std::endl;
+    ensure_reactor();
+}
+
+// Event loop: un solo thread per nodo, indipendente dal numero di connessioni
+// in ingresso e di peer in uscita
+void TcpTransport::run_reactor() {
+    constexpr int MAX_EVENTS = 64;
+    epoll_event events[MAX_EVENTS];
+    std::vector<PeerConnection*> ready;
+
+    while (!stopping_.load()) {
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == wake_fd_) {
+                // Arresto (il while ricontrolla stopping_) o peer con frame nuovi
+                uint64_t count;
+                if (read(wake_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) perror("read(eventfd)");
+                {
+                    std::lock_guard<std::mutex> lock(ready_mtx_);
+                    ready.swap(ready_);
+                }
+                for (PeerConnection* conn : ready) flush_peer(*conn);
+                ready.clear();
+            } else if (fd == server_fd_.load()) {
+                accept_connections(fd);
+            } else if (auto out = outbound_.find(fd); out != outbound_.end()) {
+                handle_writable(*out->second, events[i].events);
+            } else if (inbound_.count(fd) && !handle_readable(fd)) {
+                // Connessione chiusa dal peer o errore: la rimuove dal reactor
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+                inbound_.erase(fd);
+                close(fd);
+            }
+        }
+    }
+}
+
+// Accetta tutte le connessioni pendenti e le registra sul reactor
+void TcpTransport::accept_connections(int server_fd) {
+    while (true) {
+        int client_fd = accept4(server_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept");
+            return;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = client_fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+            perror("epoll_ctl");
+            close(client_fd);
+            continue;
+        }
+        inbound_[client_fd] = std::make_unique<FrameBuffer>(wire_format_);  // Buffer di ricezione della connessione
+    }
+}
+
+// Legge tutti i dati disponibili direttamente nel buffer della connessione e
+// consegna alla callback i frame completi come view, senza copiarli.
+// Restituisce false se la connessione va chiusa.
+bool TcpTransport::handle_readable(int fd) {
+    FrameBuffer& buffer = *inbound_.at(fd);
+
+    while (true) {
+        char* dst = buffer.write_ptr();
+        ssize_t len = recv(fd, dst, buffer.writable(), 0);
+        if (len > 0) {
+            buffer.commit(static_cast<size_t>(len));
+
+            std::string_view frame;
+            while (buffer.next_frame(frame)) {
+                if (recv_cb_) recv_cb_(frame);  // Chiamata alla callback
+            }
+            if (buffer.error()) {
+                std::cerr << "TcpTransport: oversized or corrupt frame, closing connection" << std::endl;
+                return false;
+            }
+        } else if (len == 0) {
+            return false;                      // Il client ha chiuso la connessione
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            return errno == EAGAIN || errno == EWOULDBLOCK;  // Dati esauriti o errore
+        }
+    }
+}
+
+// Codifica il messaggio nel formato configurato
+std::string TcpTransport::encode(const Message& message) const {
+    if (wire_format_ == WireFormat::TEXT) {
+        // Aggiunge newline per indicare la fine del messaggio
+        return serialize_message(message) + "\n";
+    }
+    std::string frame(encoded_size(message), '\0');
+    size_t size = encode_message(message, frame.data(), frame.size());
+    if (size == 0) {
+        // Traccia oltre i 16 bit o TOKEN troppo grande: nessun frame valido
+        std::cerr << "TcpTransport: cannot encode message (type " << static_cast<int>(message.type)
+                  << ", track " << message.resource_id << ")" << std::endl;
+        return std::string();
+    }
+    frame.resize(size);
+    return frame;
+}
+
+// Codifica il messaggio e lo accoda per il nodo specificato tramite target_id
+void TcpTransport::send(int target_id, const Message& message,
+                        std::shared_ptr<SendCompletion> completion) {
+    send_frame(target_id, encode(message), std::move(completion));
+}
+
+// Decodifica un frame secondo il formato configurato
+bool TcpTransport::decode_frame(std::string_view frame, Message& out) const {
+    if (wire_format_ == WireFormat::TEXT) {
+        return parse_message(frame, out);
+    }
+    return decode_message(frame.data(), frame.size(), out);
+}
+
+// Accoda un frame nella coda di uscita del peer; il reactor viene svegliato
+// solo se non ripasserà comunque dalla coda
+void TcpTransport::send_frame(int target_id, std::string frame, std::shared_ptr<SendCompletion> completion) {
+    auto it = connections_.find(target_id);
+    if (it == connections_.end()) {
+        std::cerr << "TcpTransport: peer " << target_id << " not found\n";
+        if (completion) completion->complete(false);
+        return;
+    }
+    // Frame vuoto = codifica fallita: l'invio fallisce senza accodare nulla
+    if (frame.empty()) {
+        if (completion) completion->complete(false);
+        return;
+    }
+
+    PeerConnection& conn = *it->second;
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(conn.mtx);
+        if (conn.outbox.size() >= MAX_OUTBOX_FRAMES) {
+            // Peer lento o irraggiungibile: la memoria resta limitata
+            std::cerr << "TcpTransport: outbox for peer " << target_id << " full, dropping message\n";
+            if (completion) completion->complete(false);
+            return;
+        }
+        conn.outbox.push_back(OutgoingFrame{std::move(frame), std::move(completion)});
+        if (!conn.scheduled) {
+            conn.scheduled = true;
+            wake = true;
+        }
+    }
+    if (wake) {
+        {
+            std::lock_guard<std::mutex> lock(ready_mtx_);
+            ready_.push_back(&conn);
+        }
+        uint64_t one = 1;
+        if (write(wake_fd_, &one, sizeof(one)) < 0) perror("write(eventfd)");
+    }
+}
+
+// Un peer alla volta, senza mai bloccare: un peer lento o irraggiungibile
+// resta in attesa di EPOLLOUT e non rallenta gli altri
+void TcpTransport::flush_peer(PeerConnection& conn) {
+    while (!conn.connecting) {
+        if (conn.batch.empty() && !take_outbox(conn)) {
+            watch_writable(conn, false);
+            return;
+        }
+        if (conn.fd < 0 && !connect_peer(conn)) {
+            finish_batch(conn, false);
+            continue;
+        }
+        if (conn.connecting) return;        // Si riprende a connessione stabilita
+        if (!write_batch(conn)) return;     // Socket pieno
+    }
+}
+
+bool TcpTransport::take_outbox(PeerConnection& conn) {
+    {
+        std::lock_guard<std::mutex> lock(conn.mtx);
+        if (conn.outbox.empty()) {
+            conn.scheduled = false;         // Il prossimo invio sveglierà il reactor
+            return false;
+        }
+        conn.batch.swap(conn.outbox);
+    }
+    // Un'unica send per tutti i frame accodati
+    for (const auto& frame : conn.batch) {
+        conn.pending += frame.data;
+        conn.frame_ends.push_back(conn.pending.size());
+    }
+    return true;
+}
+
+bool TcpTransport::write_batch(PeerConnection& conn) {
+    while (conn.sent < conn.pending.size()) {
+        // MSG_NOSIGNAL evita SIGPIPE se il peer ha chiuso
+        ssize_t n = ::send(conn.fd, conn.pending.data() + conn.sent, conn.pending.size() - conn.sent, MSG_NOSIGNAL);
+        if (n >= 0) {
+            conn.sent += static_cast<size_t>(n);
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            watch_writable(conn, true);
+            return false;
+        } else {
+            perror("send");
+            connection_lost(conn);
+            return true;
+        }
+    }
+    finish_batch(conn, true);
+    return true;
+}
+
+void TcpTransport::handle_writable(PeerConnection& conn, uint32_t events) {
+    if (conn.connecting) {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if (getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0) error = errno;
+        if (error != 0) {
+            errno = error;
+            perror("connect");
+            close_connection(conn);
+            finish_batch(conn, false);
+        } else {
+            conn.connecting = false;
+        }
+    } else if (conn.batch.empty() && (events & (EPOLLERR | EPOLLHUP))) {
+        // Connessione inattiva chiusa dal peer: si riaprirà al prossimo invio
+        close_connection(conn);
+        return;
+    }
+    flush_peer(conn);
+}
+
+// Al massimo due tentativi per batch: se la connessione persistente è caduta
+// (peer riavviato, reset) la si riapre una volta e si riprende da dove si era
+// arrivati. I frame già scritti per intero non si ripetono; uno scritto a metà
+// riparte dall'inizio, perché la nuova connessione è un flusso nuovo e il peer
+// scarta il troncone rimasto sulla vecchia.
+void TcpTransport::connection_lost(PeerConnection& conn) {
+    close_connection(conn);
+    size_t done = 0;
+    while (done < conn.frame_ends.size() && conn.frame_ends[done] <= conn.sent) ++done;
+    for (size_t i = 0; i < done; ++i) {
+        if (conn.batch[i].completion) conn.batch[i].completion->complete(true);
+    }
+    size_t start = done > 0 ? conn.frame_ends[done - 1] : 0;
+    conn.batch.erase(conn.batch.begin(), conn.batch.begin() + done);
+    conn.frame_ends.erase(conn.frame_ends.begin(), conn.frame_ends.begin() + done);
+    for (size_t& end : conn.frame_ends) end -= start;
+    conn.pending.erase(0, start);
+    conn.sent = 0;
+
+    if (conn.retried) {
+        finish_batch(conn, false);
+    } else {
+        conn.retried = true;
+    }
+}
+
+void TcpTransport::finish_batch(PeerConnection& conn, bool ok) {
+    for (auto& frame : conn.batch) {
+        if (frame.completion) frame.completion->complete(ok);
+    }
+    conn.batch.clear();
+    conn.pending.clear();
+    conn.frame_ends.clear();
+    conn.sent = 0;
+    conn.retried = false;
+}
+
+// Connessione non bloccante verso il peer, con l'algoritmo di Nagle disabilitato
+bool TcpTransport::connect_peer(PeerConnection& conn) {
+    int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0); // Crea socket TCP
+    if (sock < 0) {
+        perror("socket");
+        return false;
+    }
+
+    // I messaggi sono piccoli e sensibili alla latenza: invio immediato
+    int one = 1;
+    if (setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) < 0) {
+        perror("setsockopt(TCP_NODELAY)");
+    }
+
+    // Connessione al peer (indirizzo già risolto dalla directory)
+    bool connecting = false;
+    if (connect(sock, (const struct sockaddr*)&conn.addr, sizeof(conn.addr)) < 0) {
+        if (errno != EINPROGRESS) {
+            perror("connect");
+            close(sock);
+            return false;
+        }
+        connecting = true;
+    }
+
+    // Nessun evento finché non serve EPOLLOUT: errori e chiusure arrivano comunque
+    epoll_event ev{};
+    ev.events = connecting ? uint32_t(EPOLLOUT) : 0u;
+    ev.data.fd = sock;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, sock, &ev) < 0) {
+        perror("epoll_ctl");
+        close(sock);
+        return false;
+    }
+    conn.fd = sock;
+    conn.connecting = connecting;
+    conn.polling_out = connecting;
+    outbound_[sock] = &conn;
+    return true;
+}
+
+void TcpTransport::close_connection(PeerConnection& conn) {
+    if (conn.fd < 0) return;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+    outbound_.erase(conn.fd);
+    close(conn.fd);
+    conn.fd = -1;
+    conn.connecting = false;
+    conn.polling_out = false;
+}
+
+void TcpTransport::watch_writable(PeerConnection& conn, bool on) {
+    if (conn.fd < 0 || conn.polling_out == on) return;
+    epoll_event ev{};
+    ev.events = on ? uint32_t(EPOLLOUT) : 0u;
+    ev.data.fd = conn.fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev) < 0) perror("epoll_ctl");
+    conn.polling_out = on;
+}
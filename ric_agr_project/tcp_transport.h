@@ -0,0 +1,146 @@
+// Trasporto TCP verso i peer remoti: connessioni persistenti in uscita e in
+// ingresso, servite da un unico reactor epoll per nodo (un solo thread,
+// qualunque sia il numero di peer)
+
+#ifndef TCP_TRANSPORT_H
+#define TCP_TRANSPORT_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+#include "frame_buffer.h"
+#include "transport.h"
+
+class TcpTransport : public Transport {
+public:
+    TcpTransport(int port, WireFormat wire_format);
+
+    // Ferma il reactor, fa fallire gli invii ancora in coda e chiude le connessioni
+    ~TcpTransport() override;
+
+    // Registra un peer raggiungibile via TCP (indirizzo già risolto); la
+    // connessione viene aperta dal reactor al primo invio
+    void add_peer(int id, const sockaddr_in& addr);
+
+    // Codifica il messaggio e lo accoda per il peer. Con la coda del peer piena
+    // (peer lento o irraggiungibile) il messaggio viene scartato e l'invio fallisce.
+    void send(int target_id, const Message& message,
+              std::shared_ptr<SendCompletion> completion) override;
+
+    // Accoda un frame già codificato (per il broadcast: una sola codifica).
+    // Un frame vuoto (codifica fallita) completa l'invio come fallito.
+    void send_frame(int target_id, std::string frame, std::shared_ptr<SendCompletion> completion);
+
+    // Codifica il messaggio nel formato configurato; stringa vuota (errore
+    // già segnalato) se il messaggio non è rappresentabile nel formato binario
+    std::string encode(const Message& message) const;
+
+    // Decodifica un frame ricevuto secondo il formato configurato
+    bool decode_frame(std::string_view frame, Message& out) const;
+
+    // Imposta la callback da chiamare quando arriva un frame completo
+    // (la view punta nel buffer di ricezione ed è valida solo durante la chiamata)
+    void set_receive_callback(std::function<void(std::string_view)> cb);
+
+    // Apre il socket di ascolto e lo affida al reactor (avviato se non lo è
+    // già), fermato e atteso dal distruttore; non bloccante
+    void start_server();
+
+    // Frame accodabili per un peer prima di scartare i nuovi invii
+    static constexpr size_t MAX_OUTBOX_FRAMES = 4096;
+
+private:
+    // Frame in attesa di invio nella coda di un peer
+    struct OutgoingFrame {
+        std::string data;
+        std::shared_ptr<SendCompletion> completion;
+    };
+
+    // Connessione TCP persistente verso un peer, aperta in modo lazy, con la
+    // propria coda di uscita. La coda è condivisa con i thread che inviano;
+    // il resto appartiene al thread del reactor.
+    struct PeerConnection {
+        int id = -1;
+        sockaddr_in addr{};                   // Indirizzo risolto una volta dalla directory
+        std::mutex mtx;                       // Protegge outbox e scheduled
+        std::deque<OutgoingFrame> outbox;     // Frame in attesa di invio
+        bool scheduled = false;               // Il reactor ripasserà dalla coda senza essere svegliato
+
+        int fd = -1;                          // Socket non bloccante (-1 se non aperto o caduto)
+        bool connecting = false;              // connect in corso: si attende EPOLLOUT
+        bool polling_out = false;             // EPOLLOUT registrato sull'epoll
+        bool retried = false;                 // Il batch corrente ha già riaperto la connessione
+        std::deque<OutgoingFrame> batch;      // Frame in scrittura, tolti dalla coda in blocco
+        std::string pending;                  // Frame del batch concatenati
+        std::vector<size_t> frame_ends;       // Fine di ciascun frame in pending
+        size_t sent = 0;                      // Byte di pending già accettati dal socket
+    };
+
+    // Avvia il thread del reactor, se non è già partito
+    void ensure_reactor();
+
+    // Event loop: socket di ascolto, connessioni in ingresso e in uscita
+    void run_reactor();
+
+    // Accetta le connessioni pendenti e le registra sull'epoll
+    void accept_connections(int server_fd);
+
+    // Legge i dati disponibili su una connessione in ingresso; false se va chiusa
+    bool handle_readable(int fd);
+
+    // Evento su una connessione in uscita: fine della connect o socket di nuovo scrivibile
+    void handle_writable(PeerConnection& conn, uint32_t events);
+
+    // Scrive i frame del peer finché ce ne sono e il socket li accetta (solo reactor)
+    void flush_peer(PeerConnection& conn);
+
+    // Sposta la coda del peer nel batch; false (e scheduled azzerato) se è vuota
+    static bool take_outbox(PeerConnection& conn);
+
+    // Scrive il batch; false se il socket è pieno (si riprende a EPOLLOUT)
+    bool write_batch(PeerConnection& conn);
+
+    // Apre la connessione verso il peer in modo non bloccante (con TCP_NODELAY)
+    // e la registra sull'epoll; false se fallisce subito
+    bool connect_peer(PeerConnection& conn);
+
+    // Connessione caduta durante la scrittura: i frame già scritti per intero
+    // sono consegnati, gli altri si riprovano una volta su una connessione nuova
+    void connection_lost(PeerConnection& conn);
+
+    // Chiude il socket del peer e lo toglie dall'epoll
+    void close_connection(PeerConnection& conn);
+
+    // Completa tutti i frame del batch con l'esito indicato
+    static void finish_batch(PeerConnection& conn, bool ok);
+
+    // Registra o toglie l'interesse per EPOLLOUT sul socket del peer
+    void watch_writable(PeerConnection& conn, bool on);
+
+    int port_;
+    WireFormat wire_format_;
+    std::atomic<bool> stopping_{false};
+    int wake_fd_ = -1;                    // eventfd: nuovi frame da scrivere o arresto
+    int epoll_fd_ = -1;
+    std::atomic<int> server_fd_{-1};      // Socket di ascolto (-1 finché non c'è un server)
+    std::thread reactor_;
+    std::unordered_map<int, std::unique_ptr<PeerConnection>> connections_; // node_id -> connessione
+
+    std::mutex ready_mtx_;
+    std::vector<PeerConnection*> ready_;  // Peer con frame nuovi, da passare al reactor
+
+    // Solo thread del reactor
+    std::unordered_map<int, std::unique_ptr<FrameBuffer>> inbound_; // fd -> buffer di ricezione
+    std::unordered_map<int, PeerConnection*> outbound_;             // fd -> connessione in uscita
+    std::function<void(std::string_view)> recv_cb_;
+};
+
+#endif // TCP_TRANSPORT_H
@@ -0,0 +1,114 @@
+// Riverbero a convoluzione, mono a 48 kHz a blocchi da 1024 frame: costo per
+// campione della convoluzione diretta e di quella partizionata al crescere
+// della risposta, e tempo di partizionamento della risposta (ConvolutionIr)
+
+#include "audio_processor.h"
+#include "dsp_kernels.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr size_t BLOCK = 1024;   // Multiplo di 8
+
+// Allineato a 32 byte anche senza -mavx, come le lane del convolutore
+typedef float Lane __attribute__((vector_size(8 * sizeof(float)), aligned(32)));
+
+// samples[i] += mix * somma_k h[k] x[i + k], con h rovesciata
+__attribute__((always_inline)) inline void convolve_lanes(const float* h, size_t length, const float* x, float* samples,
+                                                    size_t frames, float mix) {
+    for (size_t i = 0; i < frames; i += 8) {
+        Lane acc{};
+        for (size_t k = 0; k < length; ++k) {
+            Lane v;
+            std::memcpy(&v, x + i + k, sizeof(v));
+            acc += h[k] * v;
+        }
+        for (size_t j = 0; j < 8; ++j) samples[i + j] += mix * acc[j];
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Stesso loop per AVX2, scelto a runtime come negli altri kernel
+__attribute__((target("avx2"))) void convolve_avx2(const float* h, size_t length, const float* x, float* samples,
+                                                   size_t frames, float mix) {
+    convolve_lanes(h, length, x, samples, frames, mix);
+}
+#endif
+
+void convolve(const float* h, size_t length, const float* x, float* samples, size_t frames, float mix) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (dsp_kernels().isa >= DspIsa::AVX2) return convolve_avx2(h, length, x, samples, frames, mix);
+#endif
+    convolve_lanes(h, length, x, samples, frames, mix);
+}
+
+// Convoluzione diretta di riferimento: risposta rovesciata e storia lineare,
+// otto uscite consecutive per volta (come le prese dirette del convolutore)
+class DirectConvolver {
+public:
+    explicit DirectConvolver(const float* ir, size_t length) : reversed_(ir, ir + length) {
+        std::reverse(reversed_.begin(), reversed_.end());
+        history_.assign(length - 1 + BLOCK, 0.0f);
+    }
+
+    void process(float* samples, size_t frames, float mix) {
+        size_t length = reversed_.size();
+        std::copy(samples, samples + frames, history_.begin() + length - 1);
+        convolve(reversed_.data(), length, history_.data(), samples, frames, mix);
+        std::copy(history_.begin() + frames, history_.begin() + frames + length - 1, history_.begin());
+    }
+
+private:
+    std::vector<float> reversed_;
+    std::vector<float> history_;   // length - 1 campioni precedenti, poi il blocco corrente
+};
+
+}  // namespace
+
+int main() {
+    std::printf("%-8s %12s %12s %10s %14s\n", "risposta", "diretta ns", "partiz. ns", "speedup", "partizioni ms");
+    for (double seconds : {0.1, 0.25, 0.5, 1.0, 2.0, 5.0}) {
+        size_t length = static_cast<size_t>(seconds * SAMPLE_RATE);
+        AudioBuffer ir(1, length);
+        std::vector<float> noise = test_signal::noise(length, 0.01f, 11);
+        std::copy(noise.begin(), noise.end(), ir.channel(0));
+
+        auto start = std::chrono::steady_clock::now();
+        auto partitioned = std::make_shared<const ConvolutionIr>(ir);
+        double partition_ms = test_util::seconds_since(start) * 1e3;
+
+        std::vector<float> input = test_signal::voice(BLOCK, 1);
+        std::vector<float> block(BLOCK);
+
+        // La diretta costa O(risposta) per campione: pochi blocchi bastano
+        DirectConvolver direct(ir.channel(0), length);
+        long direct_blocks = std::max<long>(2, static_cast<long>(200000000 / (length * BLOCK)));
+        double direct_ns = test_util::best_ns_per_iteration(direct_blocks, 3, [&](long) {
+            std::copy(input.begin(), input.end(), block.begin());
+            direct.process(block.data(), BLOCK, 0.3f);
+        }) / BLOCK;
+
+        // Abbastanza blocchi da attraversare il più grande livello di partizioni più volte
+        ConvolutionReverb reverb(partitioned, 0.3f);
+        StreamInfo info;
+        info.sample_rate = SAMPLE_RATE;
+        info.channels = 1;
+        reverb.prepare(info);
+        long partitioned_blocks = 4 * ConvolutionIr::MAX_BLOCK / BLOCK;
+        double partitioned_ns = test_util::best_ns_per_iteration(partitioned_blocks, 3, [&](long) {
+            std::copy(input.begin(), input.end(), block.begin());
+            reverb.process(block.data(), BLOCK, 0);
+        }) / BLOCK;
+
+        std::printf("%6.2f s %12.0f %12.0f %9.0fx %14.1f\n", seconds, direct_ns, partitioned_ns,
+                    direct_ns / partitioned_ns, partition_ms);
+    }
+    return 0;
+}
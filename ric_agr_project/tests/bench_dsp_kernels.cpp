@@ -0,0 +1,39 @@
+// Throughput dei kernel SIMD su blocchi da 64k campioni (in cache L2), in
+// milioni di campioni al secondo, per ogni variante supportata dalla CPU
+
+#include "dsp_kernels.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <cstdio>
+#include <vector>
+
+int main() {
+    constexpr size_t BLOCK = 65536;
+    constexpr long ITERATIONS = 200;
+    const std::vector<float> input = test_signal::noise(BLOCK, 1.0f, 5);
+    std::vector<float> x = input;
+    volatile float sink = 0.0f;
+
+    // Msample/s del corpo f, che elabora il blocco una volta
+    auto throughput = [&](auto f) {
+        double ns = test_util::best_ns_per_iteration(ITERATIONS, 5, f);
+        return BLOCK / ns * 1e3;
+    };
+
+    std::printf("%-8s %10s %10s %10s %10s %10s\n", "isa", "max_abs", "scale", "noise_gate", "compress", "ramp");
+    for (DspIsa isa : {DspIsa::SCALAR, DspIsa::SSE2, DspIsa::AVX2, DspIsa::AVX512}) {
+        const DspKernels* k = dsp_kernels_for(isa);
+        if (!k) continue;
+        x = input;
+        double max_abs = throughput([&](long) { sink = sink + k->max_abs(x.data(), BLOCK); });
+        // Guadagni alternati con il loro inverso e rampe appena sotto 1: nelle
+        // migliaia di passate i campioni non diventano denormali né infiniti
+        double scale = throughput([&](long i) { k->scale(x.data(), BLOCK, (i & 1) ? 0.5f : 2.0f); });
+        x = input;
+        double gate = throughput([&](long) { k->noise_gate(x.data(), BLOCK, 0.01f); });
+        double compress = throughput([&](long) { k->compress(x.data(), BLOCK, 0.5f, 4.0f); });
+        double ramp = throughput([&](long) { k->ramp(x.data(), BLOCK, 1000 * BLOCK, 1001 * BLOCK); });
+        std::printf("%-8s %10.0f %10.0f %10.0f %10.0f %10.0f\n", k->name, max_abs, scale, gate, compress, ramp);
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Gate, compressore, fade e normalizzazione su un solo core: passate separate
+// dei kernel sull'intero buffer, i cinque effetti in un ProcessingGraph e
+// l'effetto "voice" (VoiceChain), su una frase da 3 s e su un minuto di audio
+
+#include "audio_processor.h"
+#include "dsp_kernels.h"
+#include "effect_chain.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 48000;
+
+ProcessingGraph separate_graph() {
+    ProcessingGraph graph;
+    graph.add(make_audio_processor({"noise_gate", {}}));
+    graph.add(make_audio_processor({"compressor", {}}));
+    graph.add(make_audio_processor({"fade_in", {}}));
+    graph.add(make_audio_processor({"fade_out", {}}));
+    graph.add(make_audio_processor({"normalize", {}}));
+    return graph;
+}
+
+ProcessingGraph voice_graph() {
+    ProcessingGraph graph;
+    graph.add(make_audio_processor({"voice", {}}));
+    return graph;
+}
+
+// Gli stessi effetti come passate intere sul buffer planare, un kernel alla volta
+void separate_passes(AudioBuffer& buffer) {
+    const DspKernels& k = dsp_kernels();
+    size_t frames = buffer.frames();
+    size_t fade = static_cast<size_t>(0.05f * SAMPLE_RATE);
+    float peak = 0.0f;
+    for (int c = 0; c < buffer.channels(); ++c) {
+        float* x = buffer.channel(c);
+        k.noise_gate(x, frames, 0.01f);
+        k.compress(x, frames, 0.5f, 4.0f);
+        k.ramp(x, std::min(fade, frames), 0, fade);
+        size_t start = frames > fade ? frames - fade : 0;
+        k.ramp(x + start, frames - start, start + 1 + fade - frames, fade);
+        peak = std::max(peak, k.max_abs(x, frames));
+    }
+    for (int c = 0; c < buffer.channels(); ++c) {
+        if (peak > 0.0f) k.scale(buffer.channel(c), frames, 1.0f / peak);
+    }
+}
+
+void bench(const char* label, size_t frames, long iterations) {
+    const AudioBuffer input = test_signal::voice_planar(frames, 2);
+    AudioBuffer buffer(2, frames);
+    auto reset = [&] {
+        for (int c = 0; c < 2; ++c) std::copy(input.channel(c), input.channel(c) + frames, buffer.channel(c));
+    };
+
+    double passes = test_util::best_ns_per_iteration(iterations, 5, [&](long) {
+        reset();
+        separate_passes(buffer);
+    });
+    double graph = test_util::best_ns_per_iteration(iterations, 5, [&](long) {
+        reset();
+        ProcessingGraph g = separate_graph();
+        g.process(buffer, SAMPLE_RATE);
+    });
+    double chain = test_util::best_ns_per_iteration(iterations, 5, [&](long) {
+        reset();
+        ProcessingGraph g = voice_graph();
+        g.process(buffer, SAMPLE_RATE);
+    });
+    double copy = test_util::best_ns_per_iteration(iterations, 5, [&](long) { reset(); });
+
+    // Il tempo della copia iniziale è sottratto da tutte le misure
+    std::printf("%-22s %12.1f %12.1f %12.1f\n", label, (passes - copy) / 1e3, (graph - copy) / 1e3,
+                (chain - copy) / 1e3);
+}
+
+}  // namespace
+
+int main() {
+    std::printf("stereo 48 kHz, us      %12s %12s %12s\n", "passate", "graph", "voice");
+    bench("frase da 3 s", 3 * SAMPLE_RATE, 200);
+    bench("1 minuto", 60 * SAMPLE_RATE, 5);
+    return 0;
+}
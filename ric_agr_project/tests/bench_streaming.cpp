@@ -0,0 +1,116 @@
+// Memoria di picco dell'elaborazione di un file lungo (10, 20 e 30 minuti di
+// audio stereo): AudioManager::processFile in streaming contro loadAudio +
+// processAudio + saveAudio con tutto il segnale in memoria. Ogni misura gira
+// in un processo figlio, così ru_maxrss (da wait4) riguarda solo quella prova.
+// Richiede libsndfile.
+
+#include "audio_manager.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 22050;
+constexpr int CHANNELS = 2;
+constexpr int MINUTES[] = {10, 20, 30};
+
+// Esito di una prova eseguita in un processo figlio
+struct ChildRun {
+    bool ok = false;
+    double seconds = 0.0;
+    double max_rss_mb = 0.0;
+};
+
+// Esegue fn in un processo figlio; il figlio esce con 0 se fn riesce
+ChildRun run_in_child(const std::function<bool()>& fn) {
+    ChildRun result;
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) return result;
+    if (pid == 0) _exit(fn() ? 0 : 1);
+
+    int status = 0;
+    struct rusage usage {};
+    if (wait4(pid, &status, 0, &usage) != pid) return result;
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    result.seconds = test_util::seconds_since(start);
+    result.max_rss_mb = usage.ru_maxrss / 1024.0;   // ru_maxrss è in KiB
+    return result;
+}
+
+// La catena di una frase tipica, con la normalizzazione che richiede la passata di analisi
+void configure_chain() {
+    AudioManager::configureEffects({{"voice", {}}, {"equalizer", {}}, {"reverb", {}}, {"normalize", {}}});
+}
+
+bool write_input(const std::string& path, int minutes) {
+    size_t frames = static_cast<size_t>(minutes) * 60 * SAMPLE_RATE;
+    return AudioManager::saveAudio(path, test_signal::voice(frames, CHANNELS), SAMPLE_RATE, CHANNELS);
+}
+
+bool streaming(const std::string& input, const std::string& output) {
+    configure_chain();
+    return AudioManager::processFile(input, output);
+}
+
+bool in_memory(const std::string& input, const std::string& output) {
+    configure_chain();
+    std::vector<float> buffer;
+    int sample_rate = 0, channels = 0;
+    if (!AudioManager::loadAudio(input, buffer, sample_rate, channels)) return false;
+    AudioManager::processAudio(buffer, sample_rate, channels);
+    return AudioManager::saveAudio(output, buffer, sample_rate, channels);
+}
+
+void print_run(const ChildRun& run) {
+    if (run.ok) {
+        std::printf(" %10.1f %8.2f", run.max_rss_mb, run.seconds);
+    } else {
+        std::printf(" %10s %8s", "errore", "-");
+    }
+}
+
+}  // namespace
+
+int main() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string input = (dir / "bench_streaming_in.wav").string();
+    const std::string output = (dir / "bench_streaming_out.wav").string();
+
+    // Processo vuoto: la base comune a tutte le misure
+    ChildRun baseline = run_in_child([] { return true; });
+    std::printf("stereo 22,05 kHz, base %.1f MB\n", baseline.max_rss_mb);
+    std::printf("%-8s %10s %8s %10s %8s\n", "", "stream MB", "s", "memoria MB", "s");
+
+    int status = 0;
+    for (int minutes : MINUTES) {
+        // Anche il file di ingresso si genera in un figlio: il padre resta piccolo
+        if (!run_in_child([&] { return write_input(input, minutes); }).ok) {
+            std::printf("impossibile scrivere %s\n", input.c_str());
+            status = 1;
+            break;
+        }
+        ChildRun stream = run_in_child([&] { return streaming(input, output); });
+        ChildRun memory = run_in_child([&] { return in_memory(input, output); });
+
+        std::printf("%2d minuti", minutes);
+        print_run(stream);
+        print_run(memory);
+        std::printf("\n");
+        if (!stream.ok || !memory.ok) status = 1;
+    }
+
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+    return status;
+}
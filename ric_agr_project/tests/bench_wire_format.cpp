@@ -0,0 +1,42 @@
+// Costo di codifica e decodifica di un messaggio: frame binario contro
+// formato testo (una riga per messaggio)
+
+#include "message_structs.h"
+#include "test_util.h"
+#include <cstdio>
+#include <string>
+
+int main() {
+    constexpr long ITERATIONS = 2000000;
+    Message msg(MessageType::REQUEST, 12, 1234567, 890123456, 3);
+    msg.mode = LockMode::SHARED;
+
+    char buf[64];
+    size_t size = encode_message(msg, buf, sizeof(buf));
+    std::string text = serialize_message(msg);
+    volatile long sink = 0;
+
+    double encode_binary = test_util::best_ns_per_iteration(ITERATIONS, 5, [&](long i) {
+        msg.logical_clock = static_cast<int>(i);
+        sink = sink + static_cast<long>(encode_message(msg, buf, sizeof(buf)));
+    });
+    double decode_binary = test_util::best_ns_per_iteration(ITERATIONS, 5, [&](long) {
+        Message out;
+        decode_message(buf, size, out);
+        sink = sink + out.logical_clock;
+    });
+    double encode_text = test_util::best_ns_per_iteration(ITERATIONS / 10, 5, [&](long i) {
+        msg.logical_clock = static_cast<int>(i);
+        sink = sink + static_cast<long>(serialize_message(msg).size());
+    });
+    double decode_text = test_util::best_ns_per_iteration(ITERATIONS, 5, [&](long) {
+        Message out;
+        parse_message(text, out);
+        sink = sink + out.logical_clock;
+    });
+
+    std::printf("%-8s %8s %12s %12s\n", "formato", "byte", "codifica ns", "decodifica ns");
+    std::printf("%-8s %8zu %12.1f %12.1f\n", "binario", size, encode_binary, decode_binary);
+    std::printf("%-8s %8zu %12.1f %12.1f\n", "testo", text.size() + 1, encode_text, decode_text);
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Equalizzatore a biquad: la risposta in ampiezza di ogni tipo di banda
+// (misurata con la DFT della risposta all'impulso) coincide con quella
+// dell'Audio EQ Cookbook nei punti noti — guadagno pieno del peaking al
+// centro, metà guadagno degli shelf alla loro frequenza e guadagno pieno
+// all'estremo dello shelf, -3 dB di passa-basso e passa-alto Butterworth al
+// taglio — e le bande in cascata sommano i dB. Un cambio di guadagno con
+// set_band durante il flusso non produce gradini (zipper): la derivata
+// seconda di una sinusoide resta entro quella a regime, e alla fine del
+// transitorio l'uscita è quella del filtro preparato con i nuovi parametri.
+
+#include "biquad_cascade.h"
+#include "test_util.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr size_t IMPULSE_LENGTH = 1 << 15;   // Basta perché ogni risposta si spenga
+constexpr double TOLERANCE_DB = 0.02;
+
+// Risposta in dB della cascata alla frequenza (Hz), dalla risposta all'impulso
+double response_db(const std::vector<EqBand>& bands, double frequency) {
+    BiquadCascade eq;
+    eq.prepare(SAMPLE_RATE, bands);
+    std::vector<float> h(IMPULSE_LENGTH, 0.0f);
+    h[0] = 1.0f;
+    eq.process(h.data(), h.size());
+
+    double w = 2.0 * M_PI * frequency / SAMPLE_RATE;
+    std::complex<double> sum = 0.0;
+    for (size_t n = 0; n < h.size(); ++n) sum += static_cast<double>(h[n]) * std::polar(1.0, -w * n);
+    return 20.0 * std::log10(std::abs(sum));
+}
+
+bool near_db(double actual, double expected) {
+    if (std::fabs(actual - expected) <= TOLERANCE_DB) return true;
+    std::printf("  risposta %.4f dB, attesa %.4f dB\n", actual, expected);
+    return false;
+}
+
+EqBand band(EqBandType type, float frequency, float gain_db = 0.0f, float q = 0.7071f) {
+    EqBand b;
+    b.type = type;
+    b.frequency = frequency;
+    b.gain_db = gain_db;
+    b.q = q;
+    return b;
+}
+
+void test_magnitude_responses() {
+    const double nyquist = SAMPLE_RATE / 2.0;
+
+    // Peaking: guadagno pieno al centro, nessun effetto lontano dalla banda
+    for (float gain : {-12.0f, 6.0f, 12.0f}) {
+        std::vector<EqBand> peak = {band(EqBandType::Peaking, 1000.0f, gain, 2.0f)};
+        CHECK(near_db(response_db(peak, 1000.0), gain));
+        CHECK(near_db(response_db(peak, 0.0), 0.0));
+        CHECK(near_db(response_db(peak, nyquist), 0.0));
+    }
+
+    // Shelf: metà guadagno alla frequenza dello shelf, pieno all'estremo
+    for (float gain : {-9.0f, 6.0f}) {
+        std::vector<EqBand> low = {band(EqBandType::LowShelf, 200.0f, gain)};
+        CHECK(near_db(response_db(low, 0.0), gain));
+        CHECK(near_db(response_db(low, 200.0), gain / 2.0));
+        CHECK(near_db(response_db(low, nyquist), 0.0));
+
+        std::vector<EqBand> high = {band(EqBandType::HighShelf, 6000.0f, gain)};
+        CHECK(near_db(response_db(high, 0.0), 0.0));
+        CHECK(near_db(response_db(high, 6000.0), gain / 2.0));
+        CHECK(near_db(response_db(high, nyquist), gain));
+    }
+
+    // Passa-basso e passa-alto Butterworth: -3 dB al taglio (|H| = Q)
+    const double cutoff_db = 20.0 * std::log10(0.7071);
+    std::vector<EqBand> lowpass = {band(EqBandType::LowPass, 3000.0f)};
+    CHECK(near_db(response_db(lowpass, 3000.0), cutoff_db));
+    CHECK(near_db(response_db(lowpass, 0.0), 0.0));
+    CHECK(response_db(lowpass, 12000.0) < -20.0);
+
+    std::vector<EqBand> highpass = {band(EqBandType::HighPass, 120.0f)};
+    CHECK(near_db(response_db(highpass, 120.0), cutoff_db));
+    CHECK(near_db(response_db(highpass, nyquist), 0.0));
+    CHECK(response_db(highpass, 30.0) < -20.0);
+
+    // In cascata le risposte si moltiplicano: i dB si sommano
+    std::vector<EqBand> chain = {band(EqBandType::HighPass, 80.0f), band(EqBandType::LowShelf, 250.0f, 4.0f),
+                                 band(EqBandType::Peaking, 2500.0f, -5.0f, 1.5f),
+                                 band(EqBandType::HighShelf, 8000.0f, 3.0f)};
+    for (double frequency : {100.0, 250.0, 1000.0, 2500.0, 8000.0, 15000.0}) {
+        double sum = 0.0;
+        for (const EqBand& b : chain) sum += response_db({b}, frequency);
+        CHECK(near_db(response_db(chain, frequency), sum));
+    }
+}
+
+// Sinusoide a bassa frequenza attraverso un peaking centrato su di lei: il
+// guadagno passa da 0 a +12 dB a metà flusso. Un cambio istantaneo dei
+// coefficienti sposta l'uscita di un gradino molte volte più grande della
+// derivata seconda della sinusoide, che invece con lo smoothing resta a regime.
+void test_set_band_without_zipper() {
+    constexpr double FREQUENCY = 200.0;
+    constexpr float AMPLITUDE = 0.25f;
+    constexpr float GAIN_DB = 12.0f;
+    constexpr size_t BLOCK = 256;
+    constexpr size_t FRAMES = SAMPLE_RATE;            // Un secondo
+    constexpr size_t SWITCH = 40 * BLOCK;             // Cambio dopo circa 200 ms, a inizio blocco
+    constexpr size_t SETTLED = SAMPLE_RATE * 4 / 5;   // Transitorio finito dopo 600 ms
+
+    double w = 2.0 * M_PI * FREQUENCY / SAMPLE_RATE;
+    std::vector<float> input(FRAMES);
+    for (size_t n = 0; n < FRAMES; ++n) input[n] = AMPLITUDE * static_cast<float>(std::sin(w * n));
+
+    EqBand flat = band(EqBandType::Peaking, FREQUENCY, 0.0f, 1.0f);
+    EqBand boost = flat;
+    boost.gain_db = GAIN_DB;
+
+    BiquadCascade smoothed;
+    smoothed.prepare(SAMPLE_RATE, {flat});
+    std::vector<float> output = input;
+    for (size_t start = 0; start < FRAMES; start += BLOCK) {
+        if (start == SWITCH) smoothed.set_band(0, boost);
+        smoothed.process(output.data() + start, std::min(BLOCK, FRAMES - start));
+    }
+
+    // Derivata seconda di una sinusoide di ampiezza a: a * 4 sin^2(w / 2)
+    double steady = AMPLITUDE * std::pow(10.0, GAIN_DB / 20.0) * 4.0 * std::pow(std::sin(w / 2.0), 2);
+    double worst = 0.0;
+    for (size_t n = 2; n < FRAMES; ++n) {
+        worst = std::max(worst, std::fabs(static_cast<double>(output[n]) - 2.0 * output[n - 1] + output[n - 2]));
+    }
+    CHECK(worst < 1.5 * steady);
+
+    // A transitorio finito l'uscita è quella del filtro preparato a +12 dB
+    BiquadCascade reference;
+    reference.prepare(SAMPLE_RATE, {boost});
+    std::vector<float> expected = input;
+    reference.process(expected.data(), FRAMES);
+    double difference = 0.0;
+    for (size_t n = SETTLED; n < FRAMES; ++n) {
+        difference = std::max(difference, std::fabs(static_cast<double>(output[n]) - expected[n]));
+    }
+    CHECK(difference < 1e-3);
+}
+
+}  // namespace
+
+int main() {
+    test_magnitude_responses();
+    test_set_band_without_zipper();
+    return test_util::test_exit_code("test_biquad_cascade");
+}
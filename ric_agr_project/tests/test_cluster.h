@@ -0,0 +1,133 @@
+// Cluster in-process per i test dei protocolli: N nodi nello stesso processo
+// collegati dal trasporto locale, ognuno con il proprio protocollo per una
+// traccia e, se heartbeat_ms > 0, il rilevatore di guasti. I messaggi seguono
+// lo stesso percorso di Node::handle_message, senza la parte audio.
+//
+// Ogni cluster ha la propria PeerDirectory e quindi il proprio registro delle
+// inbox locali: più cluster possono convivere nello stesso processo.
+
+#ifndef TEST_CLUSTER_H
+#define TEST_CLUSTER_H
+
+#include "failure_detector.h"
+#include "mutex_protocol.h"
+#include "network.h"
+#include "test_util.h"
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+class TestCluster {
+public:
+    TestCluster(int num_nodes, const NodeOptions& options) {
+        nlohmann::json config;
+        config["nodes"] = nlohmann::json::array();
+        for (int id = 0; id < num_nodes; ++id) {
+            config["nodes"].push_back({{"id", id}, {"host", "127.0.0.1"}, {"port", 0}, {"transport", "local"}});
+        }
+        auto directory = PeerDirectory::from_json(config);
+
+        for (int id = 0; id < num_nodes; ++id) nodes_.push_back(std::make_unique<Member>());
+        for (int id = 0; id < num_nodes; ++id) {
+            Member& m = *nodes_[id];
+            m.network = std::make_unique<Network>(id, directory);
+            m.rn.assign(num_nodes, 0);
+            m.protocol = make_mutex_protocol({id, num_nodes, 0, m.network.get(), &m.clock, &m.rn, &m.stats, options});
+            if (options.heartbeat_ms > 0) {
+                m.detector = std::make_unique<FailureDetector>(
+                    id, m.network.get(), m.network->peer_ids(), std::chrono::milliseconds(options.heartbeat_ms),
+                    std::chrono::milliseconds(options.suspect_timeout_ms));
+                m.detector->set_callbacks([&m](int peer) { m.protocol->on_peer_down(peer); },
+                                          [&m](int peer) { m.protocol->on_peer_up(peer); });
+            }
+            m.network->set_message_callback([this, id, num_nodes](const Message& msg) {
+                Member& self = *nodes_[id];
+                if (self.crashed.load()) return;
+                if (msg.sender_id < 0 || msg.sender_id >= num_nodes || msg.sender_id == id) return;
+                // Un processo guasto non invia più nulla
+                if (nodes_[msg.sender_id]->crashed.load()) return;
+                if (self.detector) self.detector->heard_from(msg.sender_id);
+                if (msg.type == MessageType::HEARTBEAT) return;
+                self.protocol->on_message(msg);
+            });
+        }
+        for (auto& m : nodes_) m->network->start_server();
+        for (auto& m : nodes_) {
+            if (m->detector) m->detector->start();
+        }
+    }
+
+    // Si fermano i thread dei rilevatori, poi i dispatcher (che usano ancora
+    // i rilevatori); solo allora si distrugge il resto
+    ~TestCluster() {
+        for (auto& m : nodes_) {
+            if (m->detector) m->detector->stop();
+        }
+        for (auto& m : nodes_) m->network.reset();
+    }
+
+    int size() const { return static_cast<int>(nodes_.size()); }
+
+    MutexProtocol& protocol(int id) { return *nodes_[id]->protocol; }
+
+    // Guasto simulato come Node::crash: niente più heartbeat e nessun
+    // messaggio ricevuto o inviato da qui in avanti
+    void crash(int id) {
+        nodes_[id]->crashed.store(true);
+        if (nodes_[id]->detector) nodes_[id]->detector->stop();
+    }
+
+private:
+    struct Member {
+        LamportClock clock;
+        MessageStats stats;
+        std::vector<int> rn;
+        std::unique_ptr<MutexProtocol> protocol;
+        std::unique_ptr<Network> network;          // Distrutta prima del protocollo che serve
+        std::unique_ptr<FailureDetector> detector;
+        std::atomic<bool> crashed{false};
+    };
+
+    std::vector<std::unique_ptr<Member>> nodes_;
+};
+
+// Verifica la mutua esclusione: enter()/leave() attorno a ogni sezione critica
+class ExclusionCheck {
+public:
+    void enter(LockMode mode) {
+        if (mode == LockMode::SHARED) {
+            readers_.fetch_add(1);
+            if (writers_.load() != 0) violations_.fetch_add(1);
+        } else {
+            if (writers_.fetch_add(1) != 0 || readers_.load() != 0) violations_.fetch_add(1);
+        }
+    }
+
+    void leave(LockMode mode) {
+        if (mode == LockMode::SHARED) {
+            readers_.fetch_sub(1);
+        } else {
+            writers_.fetch_sub(1);
+        }
+    }
+
+    int violations() const { return violations_.load(); }
+
+private:
+    std::atomic<int> readers_{0};
+    std::atomic<int> writers_{0};
+    std::atomic<int> violations_{0};
+};
+
+// Esegue lo scenario e ne riporta il nome se qualche CHECK è fallito
+inline void run_scenario(const char* name, const std::function<void()>& scenario) {
+    int before = test_util::failures();
+    scenario();
+    if (test_util::failures() != before) std::printf("scenario %s fallito\n", name);
+}
+
+#endif // TEST_CLUSTER_H
@@ -0,0 +1,106 @@
+// Riverbero a convoluzione: il convolutore partizionato, alimentato a blocchi
+// di dimensione casuale, deve restare entro MAX_RELATIVE_ERROR (rispetto al
+// picco dell'uscita) da una convoluzione diretta in doppia precisione, per
+// risposte da 1 a 70000 prese (solo testa, ogni livello di partizioni, più
+// partizioni nell'ultimo livello), in stereo con una risposta stereo
+//
+// Per le risposte lunghe la convoluzione diretta costa troppo su ogni
+// campione: viene calcolata su un sottoinsieme di uscite, tutte le prime e
+// poi a passo fisso, entro un budget di prodotti
+
+#include "audio_processor.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double MAX_RELATIVE_ERROR = 1e-6;  // Misurato: circa 5e-7
+constexpr int CHANNELS = 2;
+constexpr float MIX = 0.8f;
+constexpr size_t TAIL = 5000;                 // Campioni oltre la lunghezza della risposta
+constexpr double REFERENCE_BUDGET = 1e8;      // Prodotti in doppia precisione per canale
+constexpr size_t LENGTHS[] = {1, 2, 63, 64, 65, 100, 255, 256, 257, 1023, 1024, 1025, 4095,
+                              4096, 4097, 16383, 16384, 16385, 20000, 49153, 70000};
+
+// Risposta stereo: rumore con decadimento esponenziale, canali diversi
+AudioBuffer make_ir(size_t length, uint32_t seed) {
+    AudioBuffer ir(CHANNELS, length);
+    std::vector<float> noise = test_signal::noise(length * CHANNELS, 1.0f, seed);
+    for (int c = 0; c < CHANNELS; ++c) {
+        for (size_t i = 0; i < length; ++i) {
+            float decay = std::exp(-3.0f * static_cast<float>(i) / static_cast<float>(length));
+            ir.channel(c)[i] = noise[i * CHANNELS + c] * decay * 0.1f;
+        }
+    }
+    return ir;
+}
+
+// Errore massimo rispetto al picco del riferimento, sulle uscite calcolate
+double relative_error(const float* x, const float* h, const float* out, size_t frames, size_t length) {
+    size_t dense = std::min(frames, size_t(2048));
+    size_t stride = std::max<size_t>(1, static_cast<size_t>(frames * static_cast<double>(length) / REFERENCE_BUDGET));
+    double peak = 0.0;
+    double error = 0.0;
+    for (size_t n = 0; n < frames; n += n < dense ? 1 : stride) {
+        double acc = 0.0;
+        for (size_t k = 0; k < length && k <= n; ++k) acc += static_cast<double>(h[k]) * x[n - k];
+        double expected = x[n] + static_cast<double>(MIX) * acc;
+        peak = std::max(peak, std::fabs(expected));
+        error = std::max(error, std::fabs(out[n] - expected));
+    }
+    return peak > 0.0 ? error / peak : error;
+}
+
+double test_length(size_t length, std::mt19937& gen) {
+    const size_t frames = length + TAIL;
+    AudioBuffer ir = make_ir(length, static_cast<uint32_t>(length));
+    auto partitioned = std::make_shared<const ConvolutionIr>(ir);
+    CHECK(partitioned->length() == length);
+
+    AudioBuffer input = test_signal::voice_planar(frames, CHANNELS);
+    AudioBuffer output(CHANNELS, frames);
+    for (int c = 0; c < CHANNELS; ++c) std::copy(input.channel(c), input.channel(c) + frames, output.channel(c));
+
+    ConvolutionReverb reverb(partitioned, MIX);
+    StreamInfo info;
+    info.sample_rate = 48000;
+    info.channels = CHANNELS;
+    info.total_frames = frames;
+    reverb.prepare(info);
+
+    // Ogni canale a blocchi casuali diversi: da un campione a più blocchi di livello
+    std::uniform_int_distribution<size_t> block_size(1, 3000);
+    for (int c = 0; c < CHANNELS; ++c) {
+        for (size_t frame = 0; frame < frames;) {
+            size_t n = std::min(block_size(gen), frames - frame);
+            reverb.process(output.channel(c) + frame, n, c);
+            frame += n;
+        }
+    }
+
+    double worst = 0.0;
+    for (int c = 0; c < CHANNELS; ++c) {
+        worst = std::max(worst, relative_error(input.channel(c), ir.channel(c), output.channel(c), frames, length));
+    }
+    return worst;
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 gen(25);
+    double worst = 0.0;
+    for (size_t length : LENGTHS) {
+        double error = test_length(length, gen);
+        CHECK(error < MAX_RELATIVE_ERROR);
+        if (error >= MAX_RELATIVE_ERROR) std::printf("risposta da %zu prese: errore relativo %.2g\n", length, error);
+        worst = std::max(worst, error);
+    }
+    std::printf("errore relativo massimo: %.2g\n", worst);
+    return test_util::test_exit_code("test_convolver");
+}
@@ -0,0 +1,69 @@
+// Linea di ritardo circolare: le letture intere e frazionarie restituiscono
+// esattamente il campione (o l'interpolazione lineare) atteso per ogni
+// ritardo fino al massimo dichiarato, anche dopo molti giri del buffer e per
+// massimi appena sotto, uguali o appena sopra una potenza di due; prima del
+// riempimento e dopo clear() la linea vale zero.
+
+#include "delay_line.h"
+#include "test_util.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr size_t MAX_DELAYS[] = {1, 2, 63, 64, 65, 127, 128, 1000};
+constexpr float FRACTIONS[] = {0.0f, 0.25f, 0.5f, 0.75f};
+
+// Una rampa x[n] = n: l'interpolazione lineare tra due campioni è esatta,
+// quindi il ritardo d dopo pushes inserimenti vale pushes - d
+void check_ramp(const DelayLine& line, size_t pushes, size_t max_delay) {
+    for (size_t whole = 1; whole <= max_delay; ++whole) {
+        CHECK(line.read(whole) == static_cast<float>(pushes - whole));
+        for (float frac : FRACTIONS) {
+            float expected = static_cast<float>(pushes - whole) - frac;
+            CHECK(line.read(whole, frac) == expected);
+            CHECK(line.read_frac(static_cast<float>(whole) + frac) == expected);
+        }
+    }
+}
+
+void test_ramp_wraparound() {
+    for (size_t max_delay : MAX_DELAYS) {
+        DelayLine line;
+        line.resize(max_delay);
+        // Abbastanza inserimenti da fare più giri di qualunque buffer usato qui
+        size_t pushes = 0;
+        for (int round = 0; round < 3; ++round) {
+            for (size_t i = 0; i < 2 * max_delay + 37; ++i) line.push(static_cast<float>(pushes++));
+            check_ramp(line, pushes, max_delay);
+        }
+    }
+}
+
+// Un impulso compare solo al ritardo pari ai push successivi, compreso il
+// massimo; interpolando a metà strada ne restano due metà
+void test_impulse() {
+    constexpr size_t MAX_DELAY = 100;
+    DelayLine line;
+    line.resize(MAX_DELAY);
+    for (size_t d = 1; d <= MAX_DELAY; ++d) CHECK(line.read(d) == 0.0f);
+
+    line.push(1.0f);
+    for (size_t age = 1; age <= MAX_DELAY; ++age) {
+        for (size_t d = 1; d <= MAX_DELAY; ++d) CHECK(line.read(d) == (d == age ? 1.0f : 0.0f));
+        CHECK(line.read(age, 0.5f) == 0.5f);
+        if (age > 1) CHECK(line.read(age - 1, 0.5f) == 0.5f);
+        line.push(0.0f);
+    }
+
+    line.clear();
+    for (size_t d = 1; d <= MAX_DELAY; ++d) CHECK(line.read(d) == 0.0f);
+}
+
+}  // namespace
+
+int main() {
+    test_ramp_wraparound();
+    test_impulse();
+    return test_util::test_exit_code("test_delay_line");
+}
@@ -0,0 +1,84 @@
+// Kernel SIMD: ogni variante supportata dalla CPU (SSE2, AVX2, AVX-512) deve
+// dare gli stessi bit della versione scalare per ogni lunghezza da 0 a 69
+// (code dei vettori e maschere comprese) e a ogni disallineamento, con
+// campioni nulli, valori esattamente sulla soglia e rampe che partono a
+// passi diversi
+
+#include "dsp_kernels.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t MAX_LENGTH = 69;
+constexpr size_t MAX_OFFSET = 16;   // Float: copre ogni disallineamento rispetto a 64 byte
+
+// Rumore con zeri (anche negativi) e campioni uguali alle soglie usate sotto
+std::vector<float> test_input() {
+    std::vector<float> x = test_signal::noise(MAX_OFFSET + MAX_LENGTH, 1.0f, 3);
+    for (size_t i = 0; i < x.size(); i += 5) x[i] = 0.0f;
+    for (size_t i = 2; i < x.size(); i += 11) x[i] = -0.0f;
+    for (size_t i = 3; i < x.size(); i += 13) x[i] = (i & 1) ? 0.5f : -0.5f;
+    for (size_t i = 4; i < x.size(); i += 17) x[i] = (i & 1) ? 0.01f : -0.01f;
+    return x;
+}
+
+bool same_bits(const float* a, const float* b, size_t n) {
+    return std::memcmp(a, b, n * sizeof(float)) == 0;
+}
+
+// Applica op(kernel, x) a una copia dell'ingresso con la variante scalare e
+// con kernels: anche i campioni fuori dal tratto elaborato devono coincidere
+template <class Op>
+void check_in_place(const DspKernels& kernels, const std::vector<float>& input, Op op) {
+    std::vector<float> expected = input;
+    std::vector<float> actual = input;
+    op(*dsp_kernels_for(DspIsa::SCALAR), expected.data());
+    op(kernels, actual.data());
+    CHECK(same_bits(expected.data(), actual.data(), expected.size()));
+}
+
+void test_isa(const DspKernels& kernels) {
+    const DspKernels& scalar = *dsp_kernels_for(DspIsa::SCALAR);
+    const std::vector<float> input = test_input();
+    int failures_before = test_util::failures();
+
+    for (size_t offset = 0; offset < MAX_OFFSET; ++offset) {
+        for (size_t n = 0; n <= MAX_LENGTH; ++n) {
+            auto run = [&](auto body) {
+                check_in_place(kernels, input, [&](const DspKernels& k, float* x) { body(k, x + offset); });
+            };
+
+            float peak_scalar = scalar.max_abs(input.data() + offset, n);
+            float peak = kernels.max_abs(input.data() + offset, n);
+            CHECK(same_bits(&peak_scalar, &peak, 1));
+
+            run([&](const DspKernels& k, float* x) { k.scale(x, n, 0.7f); });
+            run([&](const DspKernels& k, float* x) { k.noise_gate(x, n, 0.01f); });
+            run([&](const DspKernels& k, float* x) { k.noise_gate(x, n, 0.0f); });
+            run([&](const DspKernels& k, float* x) { k.compress(x, n, 0.5f, 4.0f); });
+            run([&](const DspKernels& k, float* x) { k.compress(x, n, 0.0f, 3.0f); });
+            for (size_t first_step : {size_t(0), size_t(1), size_t(5), size_t(997)}) {
+                run([&](const DspKernels& k, float* x) { k.ramp(x, n, first_step, 1000); });
+            }
+        }
+    }
+    std::printf("%s: %s\n", kernels.name, test_util::failures() == failures_before ? "identico" : "DIVERSO");
+}
+
+}  // namespace
+
+int main() {
+    for (DspIsa isa : {DspIsa::SSE2, DspIsa::AVX2, DspIsa::AVX512}) {
+        const DspKernels* kernels = dsp_kernels_for(isa);
+        if (!kernels) {
+            std::printf("variante %d non supportata dalla CPU, saltata\n", static_cast<int>(isa));
+            continue;
+        }
+        test_isa(*kernels);
+    }
+    return test_util::test_exit_code("test_dsp_kernels");
+}
@@ -0,0 +1,88 @@
+// Catena fusa: l'effetto "voice" (VoiceChain) deve dare bit per bit lo stesso
+// risultato dei cinque effetti separati in un ProcessingGraph (gate,
+// compressore, fade-in, fade-out, normalizzazione), in mono e in stereo, a
+// ogni dimensione di blocco: lane intere, code parziali e blocchi più lunghi
+// del segnale
+
+#include "audio_processor.h"
+#include "effect_chain.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 22050;
+constexpr size_t FRAMES = 50000;
+constexpr size_t BLOCK_SIZES[] = {1, 2, 3, 7, 8, 9, 63, 64, 65, 1000, 4097, 49999, 100000};
+
+struct VoiceParams {
+    float gate_threshold;
+    float threshold;
+    float ratio;
+    float fade_in_ms;
+    float fade_out_ms;
+};
+
+ProcessingGraph separate(const VoiceParams& p) {
+    ProcessingGraph graph;
+    graph.add(make_audio_processor({"noise_gate", {{"threshold", p.gate_threshold}}}));
+    graph.add(make_audio_processor({"compressor", {{"threshold", p.threshold}, {"ratio", p.ratio}}}));
+    graph.add(make_audio_processor({"fade_in", {{"duration_ms", p.fade_in_ms}}}));
+    graph.add(make_audio_processor({"fade_out", {{"duration_ms", p.fade_out_ms}}}));
+    graph.add(make_audio_processor({"normalize", {}}));
+    return graph;
+}
+
+ProcessingGraph fused(const VoiceParams& p) {
+    ProcessingGraph graph;
+    graph.add(make_audio_processor({"voice",
+                                    {{"gate_threshold", p.gate_threshold},
+                                     {"threshold", p.threshold},
+                                     {"ratio", p.ratio},
+                                     {"fade_in_ms", p.fade_in_ms},
+                                     {"fade_out_ms", p.fade_out_ms}}}));
+    return graph;
+}
+
+std::vector<float> process(ProcessingGraph graph, const std::vector<float>& input, int channels, size_t block) {
+    std::vector<float> output = input;
+    CHECK(graph.process(output, SAMPLE_RATE, channels, block));
+    return output;
+}
+
+// Anche in streaming (sorgente e destinazione, passata di analisi con riavvolgimento)
+std::vector<float> stream(ProcessingGraph graph, const std::vector<float>& input, int channels, size_t block) {
+    std::vector<float> output;
+    BufferSource source(input, SAMPLE_RATE, channels);
+    BufferSink sink(output, channels);
+    CHECK(graph.run(source, sink, block));
+    return output;
+}
+
+bool identical(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+void test_voice(const VoiceParams& params, int channels) {
+    std::vector<float> input = test_signal::voice(FRAMES, channels);
+    for (size_t block : BLOCK_SIZES) {
+        std::vector<float> expected = process(separate(params), input, channels, block);
+        CHECK(identical(process(fused(params), input, channels, block), expected));
+        CHECK(identical(stream(fused(params), input, channels, block), expected));
+    }
+}
+
+}  // namespace
+
+int main() {
+    const VoiceParams defaults{0.01f, 0.5f, 4.0f, 50, 50};
+    // Fade più lunghi del segnale e compressione marcata
+    const VoiceParams extreme{0.05f, 0.2f, 10.0f, 3000, 5000};
+    for (int channels : {1, 2}) {
+        test_voice(defaults, channels);
+        test_voice(extreme, channels);
+    }
+    return test_util::test_exit_code("test_effect_chain");
+}
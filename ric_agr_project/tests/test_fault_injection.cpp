@@ -0,0 +1,103 @@
+// Guasti a metà richiesta: un nodo cade con la sezione critica in mano o
+// mentre la sta aspettando; con il rilevatore di guasti attivo gli altri
+// nodi devono continuare a entrare, uno alla volta. Un peer che ripete la
+// propria REQUEST molte volte (come a ogni riammissione) non deve bloccare il
+// thread di ricezione di chi la differisce.
+
+#include "test_cluster.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int NUM_NODES = 4;
+constexpr int ROUNDS = 5;
+constexpr auto PATIENCE = std::chrono::seconds(10);   // Limite per ogni acquire dei sopravvissuti
+
+NodeOptions detector_options(const char* protocol) {
+    NodeOptions options;
+    options.protocol = protocol;
+    options.heartbeat_ms = 20;
+    options.suspect_timeout_ms = 300;
+    return options;
+}
+
+// I nodi da first in poi entrano ROUNDS volte ciascuno, in concorrenza
+void survivors_make_progress(TestCluster& cluster, int first) {
+    ExclusionCheck check;
+    std::atomic<int> entries{0};
+    std::vector<std::thread> threads;
+    for (int id = first; id < cluster.size(); ++id) {
+        threads.emplace_back([&, id] {
+            for (int r = 0; r < ROUNDS; ++r) {
+                if (!cluster.protocol(id).acquire(0, LockMode::EXCLUSIVE, std::chrono::steady_clock::now() + PATIENCE)) {
+                    return;
+                }
+                check.enter(LockMode::EXCLUSIVE);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                check.leave(LockMode::EXCLUSIVE);
+                entries.fetch_add(1);
+                cluster.protocol(id).release();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(entries.load() == (cluster.size() - first) * ROUNDS);
+    CHECK(check.violations() == 0);
+}
+
+// Il nodo 0 entra e cade senza rilasciare
+void crash_while_holding(const char* protocol) {
+    TestCluster cluster(NUM_NODES, detector_options(protocol));
+    CHECK(cluster.protocol(0).acquire(0, LockMode::EXCLUSIVE, NO_TIMEOUT));
+    cluster.crash(0);
+    survivors_make_progress(cluster, 1);
+}
+
+// Il nodo 0 chiede la sezione critica mentre il nodo 1 la tiene e cade in attesa:
+// la sua richiesta (più vecchia di quelle successive) non deve bloccare gli altri
+void crash_while_waiting(const char* protocol) {
+    TestCluster cluster(NUM_NODES, detector_options(protocol));
+    CHECK(cluster.protocol(1).acquire(0, LockMode::EXCLUSIVE, NO_TIMEOUT));
+
+    std::atomic<bool> crashed_entered{false};
+    std::thread waiter([&] {
+        // Il nodo guasto non riceve più nulla: la sua attesa può solo scadere
+        crashed_entered.store(cluster.protocol(0).acquire(0, LockMode::EXCLUSIVE,
+                                                          std::chrono::steady_clock::now() + std::chrono::seconds(2)));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));   // La REQUEST del nodo 0 è arrivata
+    cluster.crash(0);
+    cluster.protocol(1).release();
+
+    survivors_make_progress(cluster, 1);
+    waiter.join();
+    CHECK(!crashed_entered.load());
+}
+
+// Mille REQUEST dello stesso peer mentre il nodo 0 è in sezione critica:
+// vengono tutte differite in un solo posto, poi il cluster riparte. Oltre
+// RicartAgrawala::MAX_NODES nodi si usa la versione con mutex.
+void repeated_requests(int num_nodes) {
+    TestCluster cluster(num_nodes, NodeOptions());
+    CHECK(cluster.protocol(0).acquire(0, LockMode::EXCLUSIVE, NO_TIMEOUT));
+    for (int ts = 1; ts <= 1000; ++ts) {
+        cluster.protocol(0).on_message(Message(MessageType::REQUEST, 2, ts, 0));
+    }
+    cluster.protocol(0).release();
+    survivors_make_progress(cluster, 0);
+}
+
+}  // namespace
+
+int main() {
+    for (const char* protocol : {"ricart_agrawala", "maekawa"}) {
+        run_scenario((std::string("crash_while_holding/") + protocol).c_str(), [&] { crash_while_holding(protocol); });
+        run_scenario((std::string("crash_while_waiting/") + protocol).c_str(), [&] { crash_while_waiting(protocol); });
+    }
+    run_scenario("repeated_requests/ricart_agrawala", [] { repeated_requests(NUM_NODES); });
+    run_scenario("repeated_requests/ricart_agrawala_locked", [] { repeated_requests(40); });
+    return test_util::test_exit_code("test_fault_injection");
+}
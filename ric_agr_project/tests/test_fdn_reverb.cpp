@@ -0,0 +1,140 @@
+// Riverbero FDN contro la sua risposta all'impulso analitica: il segnale
+// diretto passa intatto, la prima eco arriva dopo la linea più corta (circa
+// 29.7 ms) con ampiezza 1/8 (1/sqrt(8) in ingresso per 1/sqrt(8) in uscita),
+// e senza smorzamento l'energia della coda scende di 30 dB ogni metà del
+// tempo di riverbero. Con lo smorzamento la coda si spegne almeno altrettanto
+// in fretta e resta limitata anche con tempi di riverbero lunghi. Ogni canale
+// ha la propria rete: un canale muto resta muto, l'altro esce identico alla
+// rete mono dello stesso canale, e le code dei due canali non sono correlate.
+
+#include "audio_processor.h"
+#include "fdn_reverb.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr float DAMPINGS[] = {0.0f, 0.3f, 0.7f, 0.99f};
+
+// Energia di x[from, to) in unità arbitrarie
+double energy(const std::vector<float>& x, size_t from, size_t to) {
+    double sum = 0.0;
+    for (size_t i = from; i < to; ++i) sum += static_cast<double>(x[i]) * x[i];
+    return sum;
+}
+
+// Uscita (diretto più riverbero) per un impulso unitario, frames campioni
+std::vector<float> impulse_response(float reverb_time, float damping, int channel, size_t frames) {
+    FdnReverb reverb;
+    reverb.prepare(SAMPLE_RATE, reverb_time, damping, channel);
+    std::vector<float> h(frames, 0.0f);
+    h[0] = 1.0f;
+    reverb.process(h.data(), frames, 1.0f);
+    return h;
+}
+
+size_t first_echo(const std::vector<float>& h) {
+    size_t n = 1;
+    while (n < h.size() && h[n] == 0.0f) ++n;
+    return n;
+}
+
+void test_first_echo() {
+    // La linea più corta è il primo primo non inferiore a 29.7 ms di campioni
+    const size_t shortest = static_cast<size_t>(0.0297 * SAMPLE_RATE);
+    for (float damping : DAMPINGS) {
+        std::vector<float> h = impulse_response(1.0f, damping, 0, SAMPLE_RATE / 10);
+        CHECK(h[0] == 1.0f);
+        size_t echo = first_echo(h);
+        CHECK(echo >= shortest && echo < shortest + 20);
+        CHECK(std::fabs(h[echo] - 0.125f) < 1e-6f);
+    }
+}
+
+// Senza smorzamento ogni anello perde 60 dB in reverb_time secondi
+void test_decay() {
+    for (float reverb_time : {0.5f, 1.0f, 2.0f}) {
+        size_t half = static_cast<size_t>(reverb_time * SAMPLE_RATE / 2);
+        size_t window = half / 5;
+        size_t start = half / 2;   // Coda già densa
+        std::vector<float> h = impulse_response(reverb_time, 0.0f, 0, start + 2 * half + window);
+
+        double first = energy(h, start, start + window);
+        double second = energy(h, start + half, start + half + window);
+        double third = energy(h, start + 2 * half, start + 2 * half + window);
+        CHECK(std::fabs(10.0 * std::log10(second / first) + 30.0) < 0.5);
+        CHECK(std::fabs(10.0 * std::log10(third / second) + 30.0) < 0.5);
+    }
+}
+
+// Un secondo di rumore, poi silenzio: con qualunque smorzamento la coda resta
+// finita e limitata e si spegne almeno alla velocità della rete non smorzata
+void test_damping_stability() {
+    constexpr float REVERB_TIME = 20.0f;
+    constexpr size_t FRAMES = 3 * SAMPLE_RATE;
+    std::vector<float> noise = test_signal::noise(SAMPLE_RATE, 0.5f, 11);
+
+    // Perdita in dB da un secondo al successivo della rete non smorzata
+    const double undamped_db = -60.0 / REVERB_TIME;
+    for (float damping : DAMPINGS) {
+        FdnReverb reverb;
+        reverb.prepare(SAMPLE_RATE, REVERB_TIME, damping, 0);
+        std::vector<float> x(FRAMES, 0.0f);
+        std::copy(noise.begin(), noise.end(), x.begin());
+        for (size_t start = 0; start < FRAMES; start += 1000) {
+            reverb.process(x.data() + start, std::min<size_t>(1000, FRAMES - start), 1.0f);
+        }
+
+        bool finite = std::all_of(x.begin(), x.end(), [](float v) { return std::isfinite(v); });
+        CHECK(finite);
+        float peak = 0.0f;
+        for (float v : x) peak = std::max(peak, std::fabs(v));
+        CHECK(peak < 10.0f);
+
+        double later = energy(x, 2 * SAMPLE_RATE, 3 * SAMPLE_RATE);
+        double earlier = energy(x, SAMPLE_RATE, 2 * SAMPLE_RATE);
+        CHECK(10.0 * std::log10(later / earlier) < undamped_db + 0.5);
+    }
+}
+
+// Impulso sul canale sinistro, silenzio sul destro, attraverso l'effetto reverb
+void test_channel_independence() {
+    constexpr size_t FRAMES = SAMPLE_RATE;
+    AudioBuffer buffer(2, FRAMES);
+    std::fill(buffer.channel(0), buffer.channel(0) + FRAMES, 0.0f);
+    std::fill(buffer.channel(1), buffer.channel(1) + FRAMES, 0.0f);
+    buffer.channel(0)[0] = 1.0f;
+
+    ProcessingGraph graph;
+    graph.add(make_audio_processor({"reverb", {{"reverb_time", 1.0f}, {"damping", 0.3f}, {"mix", 1.0f}}}));
+    graph.process(buffer, SAMPLE_RATE);
+
+    std::vector<float> mono = impulse_response(1.0f, 0.3f, 0, FRAMES);
+    CHECK(std::memcmp(buffer.channel(0), mono.data(), FRAMES * sizeof(float)) == 0);
+    CHECK(std::all_of(buffer.channel(1), buffer.channel(1) + FRAMES, [](float v) { return v == 0.0f; }));
+
+    // Le reti dei due canali hanno linee diverse: eco in punti diversi, code scorrelate
+    std::vector<float> left = mono;
+    std::vector<float> right = impulse_response(1.0f, 0.3f, 1, FRAMES);
+    CHECK(first_echo(left) != first_echo(right));
+    double cross = 0.0;
+    for (size_t i = 1; i < FRAMES; ++i) cross += static_cast<double>(left[i]) * right[i];
+    double correlation = cross / std::sqrt(energy(left, 1, FRAMES) * energy(right, 1, FRAMES));
+    CHECK(std::fabs(correlation) < 0.1);
+}
+
+}  // namespace
+
+int main() {
+    test_first_echo();
+    test_decay();
+    test_damping_stability();
+    test_channel_independence();
+    return test_util::test_exit_code("test_fdn_reverb");
+}
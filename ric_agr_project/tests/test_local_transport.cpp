@@ -0,0 +1,134 @@
+// Trasporto in-process: consegna completa con più mittenti concorrenti,
+// risveglio del dispatcher sospeso senza attendere alcun timeout, registri
+// separati per cluster diversi nello stesso processo e invio verso una inbox
+// piena che fallisce entro il limite invece di bloccare il mittente
+
+#include "local_transport.h"
+#include "test_util.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int RECEIVER = 100;
+constexpr int SENDERS = 4;
+
+void wait_until(const std::function<bool()>& done, double seconds) {
+    auto start = std::chrono::steady_clock::now();
+    while (!done() && test_util::seconds_since(start) < seconds) std::this_thread::yield();
+}
+
+void test_concurrent_senders_and_wakeup() {
+    constexpr int PER_SENDER = 50000;
+    std::atomic<int> received{0};
+    std::vector<int> last(SENDERS, -1);
+    std::atomic<bool> out_of_order{false};
+
+    LocalRegistry registry;
+    LocalTransport receiver(RECEIVER, registry);
+    receiver.set_message_callback([&](const Message& msg) {
+        // Un solo dispatcher: l'ordine per mittente è quello di invio
+        if (msg.logical_clock != last[msg.sender_id - 1] + 1) out_of_order.store(true);
+        last[msg.sender_id - 1] = msg.logical_clock;
+        received.fetch_add(1);
+    });
+    receiver.start();
+
+    std::vector<std::unique_ptr<LocalTransport>> senders;
+    for (int s = 1; s <= SENDERS; ++s) {
+        senders.push_back(std::make_unique<LocalTransport>(s, registry));
+        senders.back()->add_peer(RECEIVER);
+    }
+
+    std::vector<std::thread> threads;
+    for (int s = 1; s <= SENDERS; ++s) {
+        threads.emplace_back([&, s] {
+            for (int i = 0; i < PER_SENDER; ++i) {
+                senders[s - 1]->send(RECEIVER, Message(MessageType::REQUEST, s, i, 0, 0), nullptr);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    wait_until([&] { return received.load() == SENDERS * PER_SENDER; }, 10);
+    CHECK(received.load() == SENDERS * PER_SENDER);
+    CHECK(!out_of_order.load());
+
+    // Dispatcher sospeso: ogni messaggio isolato deve arrivare ben prima
+    // di qualunque timeout di ripiego
+    double worst = 0;
+    for (int round = 0; round < 20; ++round) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        int before = received.load();
+        auto start = std::chrono::steady_clock::now();
+        senders[0]->send(RECEIVER, Message(MessageType::REQUEST, 1, PER_SENDER + round, 0, 0), nullptr);
+        wait_until([&] { return received.load() > before; }, 5);
+        double elapsed = test_util::seconds_since(start);
+        if (elapsed > worst) worst = elapsed;
+    }
+    CHECK(received.load() == SENDERS * PER_SENDER + 20);
+    CHECK(worst < 0.02);
+}
+
+// Due cluster con gli stessi node id: ognuno riceve solo i propri messaggi
+void test_separate_registries() {
+    LocalRegistry first_registry;
+    LocalRegistry second_registry;
+    std::atomic<int> first{0};
+    std::atomic<int> second{0};
+
+    LocalTransport first_receiver(RECEIVER, first_registry);
+    LocalTransport second_receiver(RECEIVER, second_registry);
+    first_receiver.set_message_callback([&](const Message&) { first.fetch_add(1); });
+    second_receiver.set_message_callback([&](const Message&) { second.fetch_add(1); });
+    first_receiver.start();
+    second_receiver.start();
+
+    LocalTransport first_sender(1, first_registry);
+    LocalTransport second_sender(1, second_registry);
+    first_sender.add_peer(RECEIVER);
+    second_sender.add_peer(RECEIVER);
+    for (int i = 0; i < 3; ++i) first_sender.send(RECEIVER, Message(MessageType::REQUEST, 1, i, 0, 0), nullptr);
+    second_sender.send(RECEIVER, Message(MessageType::REQUEST, 1, 0, 0, 0), nullptr);
+
+    wait_until([&] { return first.load() == 3 && second.load() == 1; }, 5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(first.load() == 3);
+    CHECK(second.load() == 1);
+}
+
+// Dispatcher mai avviato: le prime CAPACITY consegne riescono, la successiva
+// fallisce dopo FULL_INBOX_TIMEOUT
+void test_full_inbox_fails() {
+    LocalRegistry registry;
+    LocalTransport receiver(RECEIVER, registry);
+    LocalTransport sender(1, registry);
+    sender.add_peer(RECEIVER);
+
+    auto accepted = std::make_shared<SendCompletion>(static_cast<int>(LocalInbox::CAPACITY));
+    for (size_t i = 0; i < LocalInbox::CAPACITY; ++i) {
+        sender.send(RECEIVER, Message(MessageType::REQUEST, 1, static_cast<int>(i), 0, 0), accepted);
+    }
+    CHECK(accepted->done());
+    CHECK(accepted->failures() == 0);
+
+    auto start = std::chrono::steady_clock::now();
+    auto dropped = std::make_shared<SendCompletion>(1);
+    sender.send(RECEIVER, Message(MessageType::REQUEST, 1, -1, 0, 0), dropped);
+    double elapsed = test_util::seconds_since(start);
+    CHECK(dropped->done());
+    CHECK(dropped->failures() == 1);
+    CHECK(elapsed >= 0.09 && elapsed < 1.0);
+}
+
+}  // namespace
+
+int main() {
+    test_concurrent_senders_and_wakeup();
+    test_separate_registries();
+    test_full_inbox_fails();
+    return test_util::test_exit_code("test_local_transport");
+}
@@ -0,0 +1,96 @@
+// Stress dei protocolli di mutua esclusione: molti nodi in un processo, tutti
+// in concorrenza sulla stessa traccia, con letture e scritture mescolate e
+// richieste ritirate per timeout. Verifica che due scrittori (o uno scrittore
+// e un lettore) non siano mai dentro insieme e che ogni richiesta senza
+// timeout venga servita. Pensato anche per make test SANITIZE=thread.
+
+#include "ricart_agrawala.h"
+#include "test_cluster.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int ROUNDS = 100;
+constexpr auto PATIENCE = std::chrono::seconds(60);   // Una richiesta senza timeout deve arrivare prima
+
+struct Scenario {
+    const char* name;
+    const char* protocol;
+    int num_nodes;
+    bool permission_reuse = false;
+    const char* priority = "lamport";
+    double read_ratio = 0.0;      // Richieste in lettura (condivise)
+    double timeout_ratio = 0.0;   // Richieste con un timeout breve, che possono essere ritirate
+};
+
+void run(const Scenario& scenario) {
+    NodeOptions options;
+    options.protocol = scenario.protocol;
+    options.permission_reuse = scenario.permission_reuse;
+    options.priority = scenario.priority;
+    TestCluster cluster(scenario.num_nodes, options);
+
+    ExclusionCheck check;
+    std::atomic<int> starved{0};
+    std::atomic<int> entries{0};
+    std::atomic<int> timeouts{0};
+    std::vector<std::thread> threads;
+    for (int id = 0; id < cluster.size(); ++id) {
+        threads.emplace_back([&, id] {
+            std::mt19937 gen(id + 1);
+            std::bernoulli_distribution read(scenario.read_ratio);
+            std::bernoulli_distribution timed(scenario.timeout_ratio);
+            std::uniform_int_distribution<int> short_timeout_ms(1, 20);
+            std::uniform_int_distribution<int> deadline_ms(0, 50);
+
+            for (int r = 0; r < ROUNDS; ++r) {
+                LockMode mode = read(gen) ? LockMode::SHARED : LockMode::EXCLUSIVE;
+                bool with_timeout = timed(gen);
+                auto now = std::chrono::steady_clock::now();
+                auto give_up_at = now + (with_timeout ? std::chrono::milliseconds(short_timeout_ms(gen))
+                                                      : std::chrono::milliseconds(PATIENCE));
+                int deadline = deadline_ms(gen);
+
+                if (!cluster.protocol(id).acquire(deadline, mode, give_up_at)) {
+                    (with_timeout ? timeouts : starved).fetch_add(1);
+                    continue;
+                }
+                check.enter(mode);
+                std::this_thread::yield();
+                check.leave(mode);
+                entries.fetch_add(1);
+                cluster.protocol(id).release();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::printf("%s: %d ingressi, %d ritirati per timeout\n", scenario.name, entries.load(), timeouts.load());
+    CHECK(check.violations() == 0);
+    CHECK(starved.load() == 0);
+    CHECK(entries.load() + timeouts.load() == cluster.size() * ROUNDS);
+}
+
+}  // namespace
+
+int main() {
+    // Oltre RicartAgrawala::MAX_NODES il factory passa alla versione con mutex
+    const int large = RicartAgrawala::MAX_NODES + 8;
+    const Scenario scenarios[] = {
+        {"ra_lockfree", "ricart_agrawala", RicartAgrawala::MAX_NODES, false, "lamport", 0.3, 0.2},
+        {"ra_lockfree_reuse", "ricart_agrawala", 16, true, "lamport", 0.3, 0.2},
+        {"ra_lockfree_edf", "ricart_agrawala", 16, false, "edf", 0.0, 0.2},
+        {"ra_locked", "ricart_agrawala", large, false, "lamport", 0.3, 0.2},
+        {"ra_locked_reuse", "ricart_agrawala", large, true, "edf", 0.3, 0.2},
+        {"maekawa", "maekawa", 16, false, "lamport", 0.0, 0.2},
+        {"suzuki_kasami", "suzuki_kasami", 16, false, "lamport", 0.0, 0.0},
+    };
+    for (const Scenario& scenario : scenarios) {
+        run_scenario(scenario.name, [&] { run(scenario); });
+    }
+    return test_util::test_exit_code("test_protocol_stress");
+}
@@ -0,0 +1,63 @@
+// Segnali di prova deterministici per i test e i benchmark DSP: una voce
+// sintetica (due sinusoidi modulate più rumore) interrotta da tratti di
+// silenzio e di rumore di fondo, così gate, compressore e fade lavorano
+// tutti, con picchi oltre la soglia del compressore
+
+#ifndef TEST_SIGNAL_H
+#define TEST_SIGNAL_H
+
+#include "audio_buffer.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace test_signal {
+
+// frames frame interleaved di channels canali; ogni canale ha la propria fase
+inline std::vector<float> voice(size_t frames, int channels, uint32_t seed = 1) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> out(frames * channels);
+    for (size_t f = 0; f < frames; ++f) {
+        // Ogni 4096 frame: tre quarti di voce, poi un ottavo di silenzio e un ottavo di fruscio
+        size_t phase = f % 4096;
+        for (int c = 0; c < channels; ++c) {
+            float t = static_cast<float>(f) + 37.0f * c;
+            float sample;
+            if (phase < 3072) {
+                float envelope = 0.4f + 0.6f * std::fabs(std::sin(t * 0.0007f));
+                sample = envelope * (0.7f * std::sin(t * 0.031f) + 0.25f * std::sin(t * 0.113f)) +
+                         0.05f * noise(gen);
+            } else if (phase < 3584) {
+                sample = 0.0f;
+            } else {
+                sample = 0.004f * noise(gen);
+            }
+            out[f * channels + c] = sample;
+        }
+    }
+    return out;
+}
+
+// Come voice, in un buffer planare
+inline AudioBuffer voice_planar(size_t frames, int channels, uint32_t seed = 1) {
+    std::vector<float> interleaved = voice(frames, channels, seed);
+    AudioBuffer buffer(channels, frames);
+    buffer.deinterleave(interleaved.data(), frames);
+    return buffer;
+}
+
+// Rumore bianco uniforme in [-amplitude, amplitude]
+inline std::vector<float> noise(size_t n, float amplitude = 1.0f, uint32_t seed = 1) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-amplitude, amplitude);
+    std::vector<float> out(n);
+    for (float& x : out) x = dist(gen);
+    return out;
+}
+
+}  // namespace test_signal
+
+#endif // TEST_SIGNAL_H
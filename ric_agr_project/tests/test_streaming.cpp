@@ -0,0 +1,124 @@
+// Elaborazione a blocchi: la catena completa di effetti, in streaming
+// (ProcessingGraph::run) e in memoria (ProcessingGraph::process), dà a ogni
+// dimensione di blocco lo stesso risultato bit per bit di un unico blocco
+// grande quanto tutto il segnale, in mono e in stereo. Fa eccezione
+// l'equalizzatore, che calcola i biquad a gruppi di otto campioni: tra una
+// dimensione di blocco e l'altra cambia solo l'arrotondamento.
+
+#include "audio_processor.h"
+#include "effect_chain.h"
+#include "test_signal.h"
+#include "test_util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 22050;
+constexpr size_t FRAMES = 30000;
+constexpr size_t BLOCK_SIZES[] = {1, 7, 64, 1000, 4096};
+
+using GraphFactory = std::function<ProcessingGraph()>;
+
+EffectSpec spec(const char* type, std::map<std::string, float> params = {}) {
+    return EffectSpec{type, std::move(params)};
+}
+
+// Risposta all'impulso sintetica abbastanza lunga da usare tre livelli di partizioni
+std::shared_ptr<const ConvolutionIr> test_ir(int channels) {
+    constexpr size_t LENGTH = 3000;
+    AudioBuffer ir(channels, LENGTH);
+    std::vector<float> noise = test_signal::noise(LENGTH * channels, 1.0f, 7);
+    for (int c = 0; c < channels; ++c) {
+        for (size_t i = 0; i < LENGTH; ++i) {
+            ir.channel(c)[i] = noise[i * channels + c] * std::exp(-static_cast<float>(i) / 600.0f) * 0.05f;
+        }
+    }
+    return std::make_shared<const ConvolutionIr>(ir);
+}
+
+// Tutti gli effetti senza perdita di esattezza tra blocchi, in un ordine in
+// cui ognuno vede il segnale già trasformato dai precedenti
+ProcessingGraph full_chain() {
+    ProcessingGraph graph;
+    graph.add(make_audio_processor(spec("noise_gate", {{"threshold", 0.01f}})));
+    graph.add(make_audio_processor(spec("compressor", {{"threshold", 0.4f}, {"ratio", 3.0f}})));
+    graph.add(make_audio_processor(spec("fade_in", {{"duration_ms", 30}})));
+    graph.add(make_audio_processor(spec("reverb", {{"reverb_time", 0.8f}})));
+    graph.add(make_audio_processor(spec("delay", {{"delay_ms", 40.25f}, {"feedback", 0.4f}})));
+    graph.add(std::make_unique<ConvolutionReverb>(test_ir(2), 0.3f));
+    graph.add(make_audio_processor(spec("normalize")));
+    graph.add(make_audio_processor(spec("fade_out", {{"duration_ms", 200}})));
+    graph.add(make_audio_processor(spec("voice")));
+    return graph;
+}
+
+ProcessingGraph equalizer_chain() {
+    ProcessingGraph graph;
+    graph.add(make_audio_processor(spec("equalizer", {{"peak1_freq", 1500.0f}, {"peak1_gain_db", 6.0f},
+                                                       {"low_shelf_freq", 200.0f}, {"low_shelf_gain_db", -3.0f}})));
+    return graph;
+}
+
+std::vector<float> run_streaming(const GraphFactory& make, const std::vector<float>& input, int channels,
+                                 size_t block_frames) {
+    ProcessingGraph graph = make();
+    std::vector<float> output;
+    BufferSource source(input, SAMPLE_RATE, channels);
+    BufferSink sink(output, channels);
+    CHECK(graph.run(source, sink, block_frames));
+    return output;
+}
+
+std::vector<float> run_in_memory(const GraphFactory& make, const std::vector<float>& input, int channels,
+                                 size_t block_frames) {
+    ProcessingGraph graph = make();
+    std::vector<float> output = input;
+    CHECK(graph.process(output, SAMPLE_RATE, channels, block_frames));
+    return output;
+}
+
+bool identical(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+float max_difference(const std::vector<float>& a, const std::vector<float>& b) {
+    if (a.size() != b.size()) return INFINITY;
+    float diff = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) diff = std::max(diff, std::fabs(a[i] - b[i]));
+    return diff;
+}
+
+void test_full_chain(int channels) {
+    std::vector<float> input = test_signal::voice(FRAMES, channels);
+    std::vector<float> whole = run_streaming(full_chain, input, channels, FRAMES);
+    CHECK(whole.size() == input.size());
+    CHECK(!identical(whole, input));
+    CHECK(identical(run_in_memory(full_chain, input, channels, FRAMES), whole));
+    for (size_t block : BLOCK_SIZES) {
+        CHECK(identical(run_streaming(full_chain, input, channels, block), whole));
+        CHECK(identical(run_in_memory(full_chain, input, channels, block), whole));
+    }
+}
+
+void test_equalizer(int channels) {
+    std::vector<float> input = test_signal::voice(FRAMES, channels);
+    std::vector<float> whole = run_streaming(equalizer_chain, input, channels, FRAMES);
+    for (size_t block : BLOCK_SIZES) {
+        CHECK(max_difference(run_streaming(equalizer_chain, input, channels, block), whole) < 1e-4f);
+        CHECK(max_difference(run_in_memory(equalizer_chain, input, channels, block), whole) < 1e-4f);
+    }
+}
+
+}  // namespace
+
+int main() {
+    for (int channels : {1, 2}) {
+        test_full_chain(channels);
+        test_equalizer(channels);
+    }
+    return test_util::test_exit_code("test_streaming");
+}
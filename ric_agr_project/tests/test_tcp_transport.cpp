@@ -0,0 +1,148 @@
+// Trasporto TCP su loopback: consegna in ordine dei frame, invii verso un
+// peer irraggiungibile che falliscono, arresto del reactor nel distruttore,
+// un solo thread per trasporto qualunque sia il numero di peer
+
+#include "message_structs.h"
+#include "tcp_transport.h"
+#include "test_util.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int PORT = 47311;
+
+sockaddr_in loopback(int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    return addr;
+}
+
+void test_delivery_in_order() {
+    constexpr int COUNT = static_cast<int>(TcpTransport::MAX_OUTBOX_FRAMES);  // Mai oltre il limite della coda
+    std::mutex mtx;
+    std::vector<int> clocks;
+
+    {
+        TcpTransport receiver(PORT, WireFormat::BINARY);
+        receiver.set_receive_callback([&](std::string_view frame) {
+            Message msg;
+            if (!decode_message(frame.data(), frame.size(), msg)) return;
+            std::lock_guard<std::mutex> lock(mtx);
+            clocks.push_back(msg.logical_clock);
+        });
+        receiver.start_server();                       // Non bloccante
+
+        TcpTransport sender(0, WireFormat::BINARY);
+        sender.add_peer(1, loopback(PORT));
+        auto completion = std::make_shared<SendCompletion>(COUNT);
+        for (int i = 0; i < COUNT; ++i) {
+            sender.send(1, Message(MessageType::REQUEST, 0, i, 0, 0), completion);
+        }
+        CHECK(completion->wait_for(std::chrono::seconds(10)));
+        CHECK(completion->failures() == 0);
+
+        auto start = std::chrono::steady_clock::now();
+        while (test_util::seconds_since(start) < 10) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (clocks.size() == COUNT) break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }   // Il distruttore del receiver ferma e attende il reactor
+
+    CHECK(clocks.size() == COUNT);
+    for (size_t i = 0; i < clocks.size(); ++i) {
+        if (clocks[i] != static_cast<int>(i)) {
+            CHECK(clocks[i] == static_cast<int>(i));
+            break;
+        }
+    }
+}
+
+void test_unreachable_peer_fails() {
+    TcpTransport sender(0, WireFormat::BINARY);
+    sender.add_peer(1, loopback(PORT + 1));            // Nessuno in ascolto
+    auto completion = std::make_shared<SendCompletion>(3);
+    for (int i = 0; i < 3; ++i) sender.send(1, Message(MessageType::ACK, 0, i, 0, 0), completion);
+    CHECK(completion->wait_for(std::chrono::seconds(10)));
+    CHECK(completion->failures() == 3);
+}
+
+void test_restart_on_same_port() {
+    // Il distruttore chiude il socket di ascolto: la porta torna libera
+    // e un nuovo server può riaprirla subito
+    for (int round = 0; round < 3; ++round) {
+        std::atomic<int> received{0};
+        TcpTransport receiver(PORT, WireFormat::BINARY);
+        receiver.set_receive_callback([&](std::string_view) { received.fetch_add(1); });
+        receiver.start_server();
+
+        TcpTransport sender(0, WireFormat::BINARY);
+        sender.add_peer(1, loopback(PORT));
+        auto completion = std::make_shared<SendCompletion>(1);
+        sender.send(1, Message(MessageType::RELEASE, 0, round, 0, 0), completion);
+        CHECK(completion->wait_for(std::chrono::seconds(10)));
+        CHECK(completion->failures() == 0);
+
+        auto start = std::chrono::steady_clock::now();
+        while (received.load() == 0 && test_util::seconds_since(start) < 10) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(received.load() == 1);
+    }
+}
+
+// Thread del processo
+size_t thread_count() {
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task")) {
+        (void)entry;
+        ++count;
+    }
+    return count;
+}
+
+void test_many_peers_one_thread() {
+    constexpr int PEERS = 64;
+    std::atomic<int> received{0};
+    TcpTransport receiver(PORT, WireFormat::BINARY);
+    receiver.set_receive_callback([&](std::string_view) { received.fetch_add(1); });
+    receiver.start_server();
+
+    // Tutti i peer puntano allo stesso server: PEERS connessioni in uscita
+    size_t before = thread_count();
+    TcpTransport sender(0, WireFormat::BINARY);
+    for (int id = 1; id <= PEERS; ++id) sender.add_peer(id, loopback(PORT));
+    CHECK(thread_count() == before + 1);     // Solo il reactor
+
+    auto completion = std::make_shared<SendCompletion>(PEERS);
+    for (int id = 1; id <= PEERS; ++id) sender.send(id, Message(MessageType::ACK, 0, id, 0, 0), completion);
+    CHECK(completion->wait_for(std::chrono::seconds(10)));
+    CHECK(completion->failures() == 0);
+    CHECK(thread_count() == before + 1);
+
+    auto start = std::chrono::steady_clock::now();
+    while (received.load() < PEERS && test_util::seconds_since(start) < 10) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(received.load() == PEERS);
+}
+
+}  // namespace
+
+int main() {
+    test_delivery_in_order();
+    test_unreachable_peer_fails();
+    test_restart_on_same_port();
+    test_many_peers_one_thread();
+    return test_util::test_exit_code("test_tcp_transport");
+}
@@ -0,0 +1,55 @@
+// Supporto minimo per test e benchmark, senza dipendenze esterne:
+// CHECK registra il fallimento e prosegue, test_exit_code() stampa l'esito
+// e restituisce il codice di uscita del processo
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <chrono>
+#include <cstdio>
+
+namespace test_util {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline int test_exit_code(const char* name) {
+    if (failures() == 0) {
+        std::printf("%s: OK\n", name);
+        return 0;
+    }
+    std::printf("%s: %d check falliti\n", name, failures());
+    return 1;
+}
+
+// Secondi trascorsi da start
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nanosecondi per iterazione del corpo f (il migliore di runs ripetizioni)
+template <class F>
+double best_ns_per_iteration(long iterations, int runs, F f) {
+    double best = 1e300;
+    for (int r = 0; r < runs; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; ++i) f(i);
+        double ns = seconds_since(start) * 1e9 / iterations;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+}  // namespace test_util
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::printf("%s:%d: CHECK fallito: %s\n", __FILE__, __LINE__, #cond);     \
+            ++test_util::failures();                                                  \
+        }                                                                             \
+    } while (0)
+
+#endif // TEST_UTIL_H
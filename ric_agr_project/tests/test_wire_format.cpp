@@ -0,0 +1,111 @@
+// Formato dei messaggi sul filo: andata e ritorno binario e testo, frame
+// malformati rifiutati, messaggi non rappresentabili che non partono
+
+#include "message_structs.h"
+#include "tcp_transport.h"
+#include "test_util.h"
+#include <arpa/inet.h>
+#include <cstring>
+#include <string>
+
+namespace {
+
+bool same(const Message& a, const Message& b) {
+    return a.type == b.type && a.sender_id == b.sender_id && a.logical_clock == b.logical_clock &&
+           a.deadline_ms == b.deadline_ms && a.resource_id == b.resource_id && a.mode == b.mode &&
+           a.request_ts == b.request_ts && a.token_ln == b.token_ln && a.token_queue == b.token_queue;
+}
+
+Message sample(MessageType type) {
+    Message msg(type, 7, -123456, 987654321, 65535);
+    msg.mode = LockMode::SHARED;
+    msg.request_ts = -2000000000;
+    if (type == MessageType::TOKEN) {
+        msg.token_ln = {0, 5, -1, 1 << 30};
+        msg.token_queue = {3, 1};
+    }
+    return msg;
+}
+
+void test_binary_round_trip() {
+    for (int t = 0; t <= static_cast<int>(LAST_MESSAGE_TYPE); ++t) {
+        Message msg = sample(static_cast<MessageType>(t));
+        char buf[256];
+        size_t size = encode_message(msg, buf, sizeof(buf));
+        CHECK(size == encoded_size(msg));
+        CHECK(peek_frame_length(buf, size) == size);
+        Message decoded;
+        CHECK(decode_message(buf, size, decoded));
+        CHECK(same(msg, decoded));
+    }
+}
+
+void test_text_round_trip() {
+    for (int t = 0; t <= static_cast<int>(LAST_MESSAGE_TYPE); ++t) {
+        Message msg = sample(static_cast<MessageType>(t));
+        Message decoded;
+        CHECK(parse_message(serialize_message(msg), decoded));
+        CHECK(same(msg, decoded));
+    }
+    Message out;
+    CHECK(!parse_message("0 1 2", out));
+    CHECK(!parse_message("1 1 2 3 4 0", out));             // Senza request_ts
+    CHECK(!parse_message("99 1 2 3 4 0 5", out));
+    CHECK(!parse_message("6 1 2 3 4 0 5 1000000", out));
+}
+
+void test_malformed_frames() {
+    Message msg = sample(MessageType::TOKEN);
+    char buf[256];
+    size_t size = encode_message(msg, buf, sizeof(buf));
+    Message out;
+    CHECK(!decode_message(buf, size - 1, out));            // Troncato
+    char bad[256];
+    std::memcpy(bad, buf, size);
+    bad[2] = 0;                                            // Magic errato
+    CHECK(!decode_message(bad, size, out));
+    std::memcpy(bad, buf, size);
+    bad[3] = 2;                                            // Versione precedente
+    CHECK(!decode_message(bad, size, out));
+    std::memcpy(bad, buf, size);
+    bad[WIRE_FRAME_SIZE] = 9;                              // Lunghezza LN incoerente
+    CHECK(!decode_message(bad, size, out));
+    std::memcpy(bad, buf, size);
+    bad[4] = 100;                                          // Tipo inesistente
+    CHECK(!decode_message(bad, size, out));
+}
+
+void test_unencodable_messages() {
+    char buf[256];
+    Message msg(MessageType::REQUEST, 1, 2, 3, UINT16_MAX + 1);
+    CHECK(encode_message(msg, buf, sizeof(buf)) == 0);
+    msg.resource_id = -1;
+    CHECK(encode_message(msg, buf, sizeof(buf)) == 0);
+    msg.resource_id = 0;
+    CHECK(encode_message(msg, buf, WIRE_FRAME_SIZE - 1) == 0);
+
+    // Il trasporto non accoda un frame vuoto: l'invio fallisce subito
+    TcpTransport transport(0, WireFormat::BINARY);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(1);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    transport.add_peer(1, addr);
+
+    Message unencodable(MessageType::REQUEST, 0, 1, 0, UINT16_MAX + 1);
+    CHECK(transport.encode(unencodable).empty());
+    auto completion = std::make_shared<SendCompletion>(1);
+    transport.send(1, unencodable, completion);
+    CHECK(completion->done());
+    CHECK(completion->failures() == 1);
+}
+
+}  // namespace
+
+int main() {
+    test_binary_round_trip();
+    test_text_round_trip();
+    test_malformed_frames();
+    test_unencodable_messages();
+    return test_util::test_exit_code("test_wire_format");
+}
@@ -0,0 +1,63 @@
+// Pool di thread con parallel_for
+
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t workers) {
+    for (size_t i = 0; i < workers; ++i) threads_.emplace_back(&ThreadPool::worker_loop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (std::thread& t : threads_) t.join();
+}
+
+size_t ThreadPool::claim(Job* job) {
+    size_t index = job->next++;
+    if (job->next == job->count) jobs_.erase(std::find(jobs_.begin(), jobs_.end(), job));
+    return index;
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (threads_.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    Job job{&fn, count};
+    std::unique_lock<std::mutex> lock(mtx_);
+    jobs_.push_back(&job);
+    work_cv_.notify_all();
+
+    // Il chiamante prende indici come un worker
+    while (job.next < job.count) {
+        size_t index = claim(&job);
+        lock.unlock();
+        fn(index);
+        lock.lock();
+        ++job.done;
+    }
+    // Il completamento si conta con mtx_ preso: quando done == count nessun
+    // worker tocca più job, che può uscire di scope
+    done_cv_.wait(lock, [&] { return job.done == job.count; });
+}
+
+void ThreadPool::worker_loop() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        work_cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) return;   // stop_ e niente da fare
+
+        Job* job = jobs_.front();
+        size_t index = claim(job);
+        lock.unlock();
+        (*job->fn)(index);
+        lock.lock();
+        if (++job->done == job->count) done_cv_.notify_all();
+    }
+}
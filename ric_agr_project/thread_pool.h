@@ -0,0 +1,51 @@
+// Pool di thread per l'elaborazione audio: parallel_for distribuisce gli indici
+// (i canali) tra i worker e il thread chiamante, e ritorna quando sono finiti.
+// Più nodi possono chiamarlo insieme: i lavori si accodano e il chiamante
+// lavora sul proprio, quindi non resta mai fermo ad aspettare un worker libero.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // workers thread oltre al chiamante (0: parallel_for esegue tutto in sequenza)
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Esegue fn(i) per ogni i in [0, count), in parallelo
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+    size_t workers() const { return threads_.size(); }
+
+private:
+    struct Job {
+        const std::function<void(size_t)>* fn;
+        size_t count;
+        size_t next = 0;   // Primo indice non ancora assegnato
+        size_t done = 0;   // Indici completati
+    };
+
+    // Assegna il prossimo indice di job (con mtx_ preso); toglie il lavoro dalla coda all'ultimo
+    size_t claim(Job* job);
+    void worker_loop();
+
+    std::mutex mtx_;
+    std::condition_variable work_cv_;   // Nuovi lavori o arresto
+    std::condition_variable done_cv_;   // Un lavoro è stato completato
+    std::deque<Job*> jobs_;             // Lavori con indici ancora da assegnare
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+#endif // THREAD_POOL_H
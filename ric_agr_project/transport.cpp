@@ -0,0 +1,24 @@
+// Handle di completamento condiviso dai trasporti
+
+#include "transport.h"
+
+// Attende il completamento di tutti gli invii
+void SendCompletion::wait() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this] { return pending_.load() == 0; });
+}
+
+// Attende il completamento con timeout
+bool SendCompletion::wait_for(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    return cv_.wait_for(lock, timeout, [this] { return pending_.load() == 0; });
+}
+
+// Registra l'esito dell'invio verso un peer
+void SendCompletion::complete(bool ok) {
+    if (!ok) failures_.fetch_add(1);
+    if (pending_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        cv_.notify_all();
+    }
+}
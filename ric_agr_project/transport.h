@@ -0,0 +1,51 @@
+// Interfaccia dei trasporti usati da Network per raggiungere i peer
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include "message_structs.h"
+
+// Handle di completamento di un invio asincrono verso uno o più peer
+class SendCompletion {
+public:
+    explicit SendCompletion(int pending) : pending_(pending) {}
+
+    // Attende che tutti gli invii siano stati consegnati al trasporto (o falliti)
+    void wait();
+
+    // Come wait(), con timeout; restituisce true se completato
+    bool wait_for(std::chrono::milliseconds timeout);
+
+    // true se non ci sono più invii in corso
+    bool done() const { return pending_.load() == 0; }
+
+    // Numero di peer a cui l'invio è fallito
+    int failures() const { return failures_.load(); }
+
+    // Segnala il completamento dell'invio verso un peer (usata dai trasporti)
+    void complete(bool ok);
+
+private:
+    std::atomic<int> pending_;
+    std::atomic<int> failures_{0};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+};
+
+// Trasporto: consegna i messaggi a un sottoinsieme di peer
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    // Invia il messaggio al peer; completion (se non nullo) viene completato
+    // quando il messaggio è stato consegnato o l'invio è fallito
+    virtual void send(int target_id, const Message& message,
+                      std::shared_ptr<SendCompletion> completion) = 0;
+};
+
+#endif // TRANSPORT_H
@@ -0,0 +1,250 @@
+// Pool di worker TTS persistenti (socket Unix + memoria condivisa)
+
+#include "tts_worker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>                // shm_open
+#include <spawn.h>                // posix_spawnp
+#include <sys/mman.h>             // mmap, shm_unlink
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+// Attesa massima del primo avvio di un worker (caricamento o download del modello)
+constexpr auto STARTUP_TIMEOUT = std::chrono::minutes(5);
+
+// Protocollo little-endian, come il formato binario dei messaggi
+void put_u32(char* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+uint32_t get_u32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return u[0] | (u[1] << 8) | (u[2] << 16) | (static_cast<uint32_t>(u[3]) << 24);
+}
+
+uint16_t get_u16(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>(u[0] | (u[1] << 8));
+}
+
+bool send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool recv_all(int fd, char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::recv(fd, data, len, 0);
+        if (n == 0) return false;          // Il worker è terminato
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Copia i campioni dal segmento di memoria condivisa creato dal worker e lo rimuove
+bool read_shared_memory(const std::string& name, size_t samples, std::vector<float>& buffer) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    // Il nome non serve più, comunque vada la lettura: il segmento vive finché è aperto o mappato
+    shm_unlink(name.c_str());
+    if (fd < 0) {
+        perror("shm_open");
+        return false;
+    }
+
+    // Un segmento più corto di quanto annunciato farebbe SIGBUS alla lettura
+    size_t bytes = samples * sizeof(float);
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < bytes) {
+        std::cerr << "TtsWorkerPool: shared memory segment " << name << " is shorter than announced" << std::endl;
+        close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+    buffer.resize(samples);
+    std::memcpy(buffer.data(), data, bytes);
+    munmap(data, bytes);
+    return true;
+}
+
+// Rimuove i segmenti lasciati da un worker terminato (nomi /ric_agr_tts_<pid>_<seq>):
+// creati ma mai letti perché la risposta non è arrivata per intero
+void remove_worker_segments(pid_t pid) {
+    std::string prefix = "ric_agr_tts_" + std::to_string(pid) + "_";
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/dev/shm", ec)) {
+        std::string file = entry.path().filename().string();
+        if (file.compare(0, prefix.size(), prefix) == 0) shm_unlink(("/" + file).c_str());
+    }
+}
+
+}  // namespace
+
+TtsWorkerPool::TtsWorkerPool(int num_workers, std::string script)
+    : script_(std::move(script)), workers_(std::max(1, num_workers)) {
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i].socket_path = "/tmp/ric_agr_tts_" + std::to_string(getpid()) + "_" + std::to_string(i) + ".sock";
+        spawn(workers_[i]);
+        idle_.push_back(static_cast<int>(i));
+    }
+}
+
+TtsWorkerPool::~TtsWorkerPool() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (Worker& worker : workers_) stop(worker);
+}
+
+bool TtsWorkerPool::spawn(Worker& worker) {
+    std::string python = "python3", serve = "--serve";
+    char* argv[] = {python.data(), script_.data(), serve.data(), worker.socket_path.data(), nullptr};
+
+    // Nessuna shell: il testo non compare mai su una riga di comando
+    int err = posix_spawnp(&worker.pid, "python3", nullptr, nullptr, argv, environ);
+    if (err != 0) {
+        std::cerr << "TtsWorkerPool: cannot start python3: " << std::strerror(err) << std::endl;
+        worker.pid = -1;
+        return false;
+    }
+    return true;
+}
+
+bool TtsWorkerPool::connect_worker(Worker& worker) {
+    if (worker.pid < 0 && !spawn(worker)) return false;
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, worker.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Il socket compare solo quando il modello è caricato: si riprova finché il processo è vivo
+    auto give_up_at = std::chrono::steady_clock::now() + STARTUP_TIMEOUT;
+    while (std::chrono::steady_clock::now() < give_up_at) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            perror("socket");
+            return false;
+        }
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+            worker.fd = fd;
+            return true;
+        }
+        close(fd);
+
+        int status;
+        if (waitpid(worker.pid, &status, WNOHANG) == worker.pid) {
+            std::cerr << "TtsWorkerPool: synthesizer worker exited during startup" << std::endl;
+            worker.pid = -1;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    std::cerr << "TtsWorkerPool: synthesizer worker did not start in time" << std::endl;
+    stop(worker);
+    return false;
+}
+
+void TtsWorkerPool::stop(Worker& worker) {
+    if (worker.fd >= 0) {
+        close(worker.fd);   // Il worker vede EOF e termina
+        worker.fd = -1;
+    } else if (worker.pid > 0) {
+        kill(worker.pid, SIGTERM);  // Mai connesso: sta ancora caricando il modello
+    }
+    if (worker.pid > 0) {
+        waitpid(worker.pid, nullptr, 0);
+        remove_worker_segments(worker.pid);
+    }
+    worker.pid = -1;
+    unlink(worker.socket_path.c_str());
+}
+
+bool TtsWorkerPool::synthesize(const std::string& text,
+                               std::vector<float>& buffer,
+                               int& sampleRate,
+                               int& channels) {
+    // Preleva un worker libero: ognuno serve una richiesta alla volta
+    int index;
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this] { return !idle_.empty(); });
+        index = idle_.back();
+        idle_.pop_back();
+    }
+
+    Worker& worker = workers_[index];
+    bool ok = (worker.fd >= 0 || connect_worker(worker)) &&
+              roundtrip(worker, text, buffer, sampleRate, channels);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        idle_.push_back(index);
+    }
+    cv_.notify_one();
+    return ok;
+}
+
+bool TtsWorkerPool::roundtrip(Worker& worker, const std::string& text,
+                              std::vector<float>& buffer, int& sampleRate, int& channels) {
+    // Richiesta: [u32 lunghezza][testo UTF-8]
+    std::string request(4, '\0');
+    put_u32(request.data(), static_cast<uint32_t>(text.size()));
+    request += text;
+
+    // Risposta: [i32 stato][u32 sample rate][u32 canali][u32 campioni][u16 lunghezza][nome segmento o errore]
+    char header[18];
+    if (!send_all(worker.fd, request.data(), request.size()) || !recv_all(worker.fd, header, sizeof(header))) {
+        std::cerr << "TtsWorkerPool: synthesizer worker died, restarting it on next use" << std::endl;
+        stop(worker);
+        return false;
+    }
+    int32_t status = static_cast<int32_t>(get_u32(header));
+    uint32_t rate = get_u32(header + 4);
+    uint32_t num_channels = get_u32(header + 8);
+    uint32_t samples = get_u32(header + 12);
+    std::string name(get_u16(header + 16), '\0');
+    if (!recv_all(worker.fd, name.data(), name.size())) {
+        stop(worker);
+        return false;
+    }
+
+    if (status != 0) {
+        std::cerr << "TtsWorkerPool: synthesis failed: " << name << std::endl;
+        return false;
+    }
+    sampleRate = static_cast<int>(rate);
+    channels = static_cast<int>(num_channels);
+    if (samples == 0) {
+        buffer.clear();
+        return true;
+    }
+    return read_shared_memory(name, samples, buffer);
+}
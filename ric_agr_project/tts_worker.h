@@ -0,0 +1,60 @@
+// Pool di sintetizzatori vocali persistenti: ogni worker è un processo
+// python3 (synthesizer.py --serve) che carica il modello una sola volta e
+// risponde su un socket Unix. Il testo viaggia sul socket, i campioni float
+// tornano in un segmento di memoria condivisa: nessun file WAV intermedio.
+
+#ifndef TTS_WORKER_H
+#define TTS_WORKER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+class TtsWorkerPool {
+public:
+    // Avvia subito i processi: il modello si carica mentre i nodi partono
+    TtsWorkerPool(int num_workers, std::string script);
+
+    // Chiude le connessioni (i worker terminano da soli) e attende i processi
+    ~TtsWorkerPool();
+
+    TtsWorkerPool(const TtsWorkerPool&) = delete;
+    TtsWorkerPool& operator=(const TtsWorkerPool&) = delete;
+
+    // Sintetizza il testo con il primo worker libero (bloccante);
+    // false se il worker non risponde o la sintesi fallisce
+    bool synthesize(const std::string& text,
+                    std::vector<float>& buffer,
+                    int& sampleRate,
+                    int& channels);
+
+private:
+    struct Worker {
+        pid_t pid = -1;
+        std::string socket_path;
+        int fd = -1;        // Connessione persistente (-1 = non ancora connesso)
+    };
+
+    // Avvia il processo python3 senza passare dalla shell
+    bool spawn(Worker& worker);
+
+    // Si connette al socket del worker, attendendo che abbia caricato il modello
+    bool connect_worker(Worker& worker);
+
+    // Una richiesta e la sua risposta sulla connessione del worker
+    bool roundtrip(Worker& worker, const std::string& text,
+                   std::vector<float>& buffer, int& sampleRate, int& channels);
+
+    // Chiude la connessione e raccoglie il processo (il worker verrà riavviato al prossimo uso)
+    void stop(Worker& worker);
+
+    std::string script_;
+    std::vector<Worker> workers_;
+    std::vector<int> idle_;          // Indici dei worker liberi
+    std::mutex mtx_;
+    std::condition_variable cv_;
+};
+
+#endif // TTS_WORKER_H